@@ -0,0 +1,113 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Per planning group index of the variables that can actually move, for fast state comparisons
+*/
+
+#ifndef MOVEIT_BOILERPLATE_ACTIVE_VARIABLE_CACHE_H
+#define MOVEIT_BOILERPLATE_ACTIVE_VARIABLE_CACHE_H
+
+// C++
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/thread/mutex.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+
+// MoveIt
+#include <moveit/robot_state/robot_state.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(ActiveVariableCache);
+
+/** \brief Variables of a group's active joints, as indices into RobotState::getVariablePositions() */
+struct ActiveVariables
+{
+  std::vector<int> indices_;
+
+  // True if the indices are first_, first_ + 1, ..., which lets comparisons run straight over the state's buffer
+  bool contiguous_ = true;
+  int first_ = 0;
+};
+
+/**
+ * \brief Compares robot states over the active variables of a joint model group
+ *
+ * The active variables of each group are looked up once and kept, mimic and fixed joints are left out. Comparisons
+ * are a max-abs-diff over the state's position buffers without copying them. Thread safe.
+ */
+class ActiveVariableCache
+{
+public:
+  /** \brief Difference below which states are considered equal by default, in radians or meters */
+  static const double DEFAULT_THRESHOLD;
+
+  /** \brief Get the active variables of a group, computed on first use */
+  const ActiveVariables &getActiveVariables(JointModelGroup *jmg);
+
+  /**
+   * \brief Largest absolute difference between the active variables of two states
+   * \return 0 if the group has no active variables
+   */
+  double maxDifference(const moveit::core::RobotState &s1, const moveit::core::RobotState &s2, JointModelGroup *jmg);
+
+  /**
+   * \brief Check if two states are the same within threshold over the active variables of a group
+   * \return true if no active variable differs by more than threshold
+   */
+  bool statesEqual(const moveit::core::RobotState &s1, const moveit::core::RobotState &s2, JointModelGroup *jmg,
+                   double threshold = DEFAULT_THRESHOLD)
+  {
+    return maxDifference(s1, s2, jmg) <= threshold;
+  }
+
+  /** \brief Largest absolute difference between two buffers of length size */
+  static double maxAbsDifference(const double *a, const double *b, std::size_t size);
+
+private:
+  // Short name of this class
+  std::string name_ = "active_variable_cache";
+
+  boost::mutex mutex_;
+  std::map<JointModelGroup *, ActiveVariables> groups_;  // entries are never removed, so references stay valid
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_ACTIVE_VARIABLE_CACHE_H
@@ -0,0 +1,126 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Synthetic robot and fake trajectory controller for benchmarking without hardware
+*/
+
+#ifndef MOVEIT_BOILERPLATE_BENCHMARK_ROBOT_H
+#define MOVEIT_BOILERPLATE_BENCHMARK_ROBOT_H
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+// ROS
+#include <ros/ros.h>
+#include <actionlib/server/simple_action_server.h>
+#include <control_msgs/FollowJointTrajectoryAction.h>
+#include <sensor_msgs/JointState.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+namespace moveit_boilerplate
+{
+/**
+ * \brief URDF of a serial chain of revolute joints named joint_0 ... joint_<dof - 1>
+ *        Joints alternate between the z and y axes so the chain is not degenerate
+ */
+std::string makeBenchmarkURDF(std::size_t dof);
+
+/** \brief SRDF with the whole chain in a group named "arm" */
+std::string makeBenchmarkSRDF(std::size_t dof);
+
+/**
+ * \brief Load a benchmark robot onto the parameter server
+ * \param robot_description - parameter name of the URDF, the SRDF is set to robot_description + "_semantic"
+ */
+void setBenchmarkRobotParams(const std::string &robot_description, std::size_t dof);
+
+/**
+ * \brief Stands in for a ros_control joint trajectory controller
+ *
+ * Accepts trajectories on <namespace>/command and on the <namespace>/follow_joint_trajectory action, and publishes
+ * <namespace>/joint_states. Every trajectory is "executed" instantly by jumping to its last point, so only the
+ * command path is measured. The arrival time of each command is recorded with std::chrono::steady_clock.
+ */
+class FakeTrajectoryController
+{
+public:
+  /**
+   * \brief Constructor
+   * \param nh - namespace of the controller's topics
+   * \param joint_names - joints to publish, all starting at zero
+   * \param joint_state_rate - Hz
+   */
+  FakeTrajectoryController(ros::NodeHandle nh, const std::vector<std::string> &joint_names, double joint_state_rate);
+
+  /** \brief Number of trajectories received on either interface */
+  std::size_t getCommandCount() const
+  {
+    return command_count_.load();
+  }
+
+  /** \brief When the most recent trajectory arrived */
+  std::chrono::steady_clock::time_point getLastCommandTime() const;
+
+private:
+  void commandCallback(const trajectory_msgs::JointTrajectoryConstPtr &trajectory);
+
+  void goalCallback(const control_msgs::FollowJointTrajectoryGoalConstPtr &goal);
+
+  /** \brief Record arrival and jump to the end of the trajectory */
+  void receive(const trajectory_msgs::JointTrajectory &trajectory);
+
+  void publishJointStates(const ros::TimerEvent &event);
+
+  ros::NodeHandle nh_;
+  ros::Subscriber command_sub_;
+  ros::Publisher joint_state_pub_;
+  ros::Timer joint_state_timer_;
+  boost::scoped_ptr<actionlib::SimpleActionServer<control_msgs::FollowJointTrajectoryAction> > action_server_;
+
+  mutable boost::mutex state_mutex_;
+  sensor_msgs::JointState joint_state_;
+  std::chrono::steady_clock::time_point last_command_time_;
+  std::atomic<std::size_t> command_count_;
+};
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_BENCHMARK_ROBOT_H
@@ -0,0 +1,181 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Versioned binary file of a joint trajectory that is read in place through mmap
+*/
+
+#ifndef MOVEIT_BOILERPLATE_BINARY_TRAJECTORY_H
+#define MOVEIT_BOILERPLATE_BINARY_TRAJECTORY_H
+
+// C++
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/noncopyable.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+
+// MoveIt
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(BinaryTrajectoryFile);
+
+/**
+ * \brief Fixed size start of a binary trajectory file
+ *
+ * The header is followed by the variable names, each terminated by '\0', padded to a multiple of 8 bytes. Then come
+ * column-major arrays of doubles: the positions of each variable over all waypoints, the same for velocities and
+ * accelerations if their flags are set, and the time from start of each waypoint. Values are in host byte order,
+ * byte_order_ tells whether a file was written on a machine with the same one.
+ */
+struct BinaryTrajectoryHeader
+{
+  static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+  static const std::uint32_t HAS_VELOCITIES = 1;
+  static const std::uint32_t HAS_ACCELERATIONS = 2;
+
+  char magic_[8];
+  std::uint32_t version_;
+  std::uint32_t byte_order_;
+  std::uint64_t num_waypoints_;
+  std::uint32_t num_variables_;
+  std::uint32_t flags_;
+  std::uint64_t names_size_;   // bytes of the names block including padding
+  std::uint64_t data_offset_;  // from the start of the file to the first position
+  std::uint64_t reserved_[2];
+};
+
+/**
+ * \brief Read-only view of a binary trajectory file mapped into memory
+ *
+ * Opening a file only validates its header and names, the arrays are used where they lie in the mapping. They stay
+ * valid until the file is closed or this object is destroyed. Not thread safe to open or close, but once open any
+ * number of threads may read.
+ */
+class BinaryTrajectoryFile : boost::noncopyable
+{
+public:
+  /** \brief Magic bytes at the start of every file */
+  static const char MAGIC[8];
+
+  /** \brief Format written by write(), files of other versions are rejected */
+  static const std::uint32_t VERSION = 1;
+
+  BinaryTrajectoryFile();
+
+  /** \brief Destructor, unmaps the file */
+  ~BinaryTrajectoryFile();
+
+  /**
+   * \brief Map a file and check its header
+   * \return true on success
+   */
+  bool open(const std::string &file_name);
+
+  /** \brief Unmap the file */
+  void close();
+
+  bool isOpen() const
+  {
+    return header_ != NULL;
+  }
+
+  std::size_t getWaypointCount() const
+  {
+    return header_->num_waypoints_;
+  }
+
+  std::size_t getVariableCount() const
+  {
+    return header_->num_variables_;
+  }
+
+  const std::vector<std::string> &getVariableNames() const
+  {
+    return variable_names_;
+  }
+
+  /** \brief Positions of one variable over all waypoints */
+  const double *getPositions(std::size_t variable) const
+  {
+    return positions_ + variable * header_->num_waypoints_;
+  }
+
+  /** \brief Velocities of one variable over all waypoints, NULL if the file has none */
+  const double *getVelocities(std::size_t variable) const
+  {
+    return velocities_ ? velocities_ + variable * header_->num_waypoints_ : NULL;
+  }
+
+  /** \brief Accelerations of one variable over all waypoints, NULL if the file has none */
+  const double *getAccelerations(std::size_t variable) const
+  {
+    return accelerations_ ? accelerations_ + variable * header_->num_waypoints_ : NULL;
+  }
+
+  /** \brief Time from start of each waypoint, in seconds */
+  const double *getTimes() const
+  {
+    return times_;
+  }
+
+  /**
+   * \brief Save every variable of a trajectory's waypoints
+   * \return true on success
+   */
+  static bool write(const std::string &file_name, const robot_trajectory::RobotTrajectory &trajectory);
+
+private:
+  // Short name of this class
+  std::string name_ = "binary_trajectory";
+
+  void *mapping_ = NULL;
+  std::size_t mapping_size_ = 0;
+
+  const BinaryTrajectoryHeader *header_ = NULL;
+  std::vector<std::string> variable_names_;
+  const double *positions_ = NULL;
+  const double *velocities_ = NULL;
+  const double *accelerations_ = NULL;
+  const double *times_ = NULL;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_BINARY_TRAJECTORY_H
@@ -88,13 +88,20 @@ public:
 
   /**
    * \brief Use the planning scene to get the robot's current state
+   *        Note: the returned state is refreshed in place on the next call, copy it before modifying or keeping it
    */
   moveit::core::RobotStatePtr getCurrentState();
 
+  /** \brief Getter for the shared current state, for passing on to other components */
+  CurrentStateSnapshotPtr getCurrentStateSnapshot()
+  {
+    return state_snapshot_;
+  }
+
   /**
    * \brief Get pose of the end effector
    */
-  const Eigen::Affine3d &getCurrentPose();
+  Eigen::Affine3d getCurrentPose();
 
 protected:
   // Name of this class
@@ -125,8 +132,13 @@ protected:
   // For executing joint and cartesian trajectories
   ExecutionInterfacePtr execution_interface_;
 
-  // Allocated memory for robot state
+  // Current state shared with the execution and planning interfaces
+  CurrentStateSnapshotPtr state_snapshot_;
+
+  // Refreshed in place by getCurrentState(), only copying what changed
   moveit::core::RobotStatePtr current_state_;
+  std::size_t current_state_version_ = 0;
+  std::size_t current_scene_version_ = 0;
 
   // Debug interface for dealing with GUIs
   rviz_visual_tools::RemoteControlPtr remote_control_;
@@ -0,0 +1,153 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Publishes cartesian end effector commands at a fixed rate from a background thread
+*/
+
+#ifndef MOVEIT_BOILERPLATE_CARTESIAN_STREAMER_H
+#define MOVEIT_BOILERPLATE_CARTESIAN_STREAMER_H
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Boost
+#include <boost/thread.hpp>
+
+// ROS
+#include <ros/ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+
+// Eigen
+#include <Eigen/Geometry>
+
+// this package
+#include <moveit_boilerplate/latency_stats.h>
+#include <moveit_boilerplate/seqlock.h>
+
+// MoveIt
+#include <moveit/macros/class_forward.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(CartesianStreamer);
+
+/**
+ * \brief Sends the latest cartesian target to a controller at a fixed rate, independent of how often it changes
+ *
+ * Targets are written to a seqlock-protected slot, so setting one never waits for the publishing thread and the
+ * publishing thread never waits for callers. The thread sleeps until absolute deadlines, so timing errors do not
+ * accumulate, and skips cycles it has missed instead of publishing a burst to catch up.
+ *
+ * With interpolation enabled each new target is approached from the last command over a fixed duration, linearly
+ * in position and with slerp in orientation.
+ */
+class CartesianStreamer
+{
+public:
+  /**
+   * \brief Constructor, starts the publishing thread
+   * \param publisher - geometry_msgs/PoseStamped publisher of the cartesian controller
+   * \param frame_id - frame of all targets
+   * \param rate - publishing frequency in Hz
+   * \param interpolation_duration - seconds to reach a new target, 0 jumps to it immediately
+   */
+  CartesianStreamer(const ros::Publisher &publisher, const std::string &frame_id, double rate,
+                    double interpolation_duration);
+
+  /** \brief Stops the publishing thread */
+  ~CartesianStreamer();
+
+  /** \brief Replace the target, safe to call from any thread */
+  void setTarget(const Eigen::Affine3d &pose);
+
+  /** \brief Stop publishing until the next target is set */
+  void clearTarget();
+
+  /**
+   * \brief Summarize publishing timing
+   * \param status - values are replaced, name and level are left to the caller
+   */
+  void getDiagnostics(diagnostic_msgs::DiagnosticStatus &status) const;
+
+  /** \brief Summarize publishing timing as a table */
+  std::string toString() const;
+
+private:
+  /** \brief Plain data so it can be copied under the seqlock */
+  struct Target
+  {
+    double position_[3];
+    double orientation_[4];  // x, y, z, w
+    bool valid_;
+  };
+
+  /** \brief Background thread that publishes at the fixed rate */
+  void streamingThread();
+
+  /** \brief Copy the latest target out of the slot */
+  std::size_t readTarget(Target &target) const;
+
+  enum TimingStage
+  {
+    TIMING_LATENESS = 0,  // how long after its deadline each message was published
+    TIMING_PERIOD         // time between consecutive messages
+  };
+
+  // Short name of this class
+  std::string name_ = "cartesian_streamer";
+
+  ros::Publisher publisher_;
+  geometry_msgs::PoseStamped pose_stamped_msg_;
+  std::chrono::steady_clock::duration period_;
+  double interpolation_duration_;
+
+  // Latest target, written by callers and read by the publishing thread
+  SeqLock target_seqlock_;
+  boost::mutex target_write_mutex_;  // serializes writers only
+  Target target_;
+
+  // Timing statistics
+  LatencyStats timing_stats_;
+  std::atomic<std::size_t> overrun_count_;
+
+  std::atomic<bool> shutdown_;
+  boost::thread streaming_thread_;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_CARTESIAN_STREAMER_H
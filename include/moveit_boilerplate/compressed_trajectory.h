@@ -0,0 +1,224 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Compact file of a joint trajectory, quantized to an error bound, delta encoded and compressed in blocks
+*/
+
+#ifndef MOVEIT_BOILERPLATE_COMPRESSED_TRAJECTORY_H
+#define MOVEIT_BOILERPLATE_COMPRESSED_TRAJECTORY_H
+
+// C++
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/noncopyable.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+
+// MoveIt
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(CompressedTrajectoryFile);
+
+/**
+ * \brief Fixed size start of a compressed trajectory file
+ *
+ * The header is followed by the variable names, each terminated by '\0', padded to a multiple of 8 bytes, then a
+ * CompressedTrajectoryBlock for each block and then the zlib streams of the blocks. A block holds block_size_
+ * waypoints, fewer in the last one. Uncompressed it is every position column, then the velocity and acceleration
+ * columns if their flags are set and the times if HAS_TIMES is set. Each column is the differences of the values
+ * divided by their step and rounded, starting from zero in every block, as zigzag varints.
+ */
+struct CompressedTrajectoryHeader
+{
+  static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+  static const std::uint32_t HAS_VELOCITIES = 1;
+  static const std::uint32_t HAS_ACCELERATIONS = 2;
+  static const std::uint32_t HAS_TIMES = 4;
+
+  char magic_[8];
+  std::uint32_t version_;
+  std::uint32_t byte_order_;
+  std::uint64_t num_waypoints_;
+  std::uint32_t num_variables_;
+  std::uint32_t flags_;
+  std::uint32_t block_size_;
+  std::uint32_t num_blocks_;
+  std::uint64_t names_size_;  // bytes of the names block including padding, 0 if the file has no names
+  double position_step_;      // twice the error bound of each kind of value
+  double velocity_step_;
+  double acceleration_step_;
+  double time_step_;
+};
+
+/** \brief Location of a block in a compressed trajectory file */
+struct CompressedTrajectoryBlock
+{
+  std::uint64_t offset_;  // from the start of the file
+  std::uint32_t compressed_size_;
+  std::uint32_t raw_size_;
+};
+
+/** \brief Waypoints of a trajectory as row-major arrays, getVariableCount() values per waypoint */
+struct TrajectoryData
+{
+  // Empty if the variables are the robot's variables in order
+  std::vector<std::string> variable_names_;
+  std::size_t num_variables_ = 0;
+
+  std::vector<double> positions_;
+  std::vector<double> velocities_;     // empty if there are none
+  std::vector<double> accelerations_;  // empty if there are none
+  std::vector<double> times_;          // time from start of each waypoint, empty if there are none
+
+  std::size_t getWaypointCount() const
+  {
+    return num_variables_ ? positions_.size() / num_variables_ : 0;
+  }
+};
+
+/** \brief Largest difference allowed between a value and its reconstruction, and how to compress */
+struct CompressionOptions
+{
+  double position_error_ = 1e-5;      // radians or meters
+  double velocity_error_ = 1e-4;      // per second
+  double acceleration_error_ = 1e-3;  // per second squared
+  double time_error_ = 1e-6;          // seconds
+  std::size_t block_size_ = 256;      // waypoints
+  int level_ = 6;                     // zlib level, 1 is fastest and 9 smallest
+};
+
+/**
+ * \brief Reads and writes joint trajectories many times smaller than CSV or BinaryTrajectoryFile
+ *
+ * Values are rounded to a multiple of twice their error bound, so each is reconstructed within the bound and
+ * errors do not accumulate along the trajectory. Blocks decode independently, so a file can be read a block at a
+ * time while it is executed. Opening a file only reads the header, names and block index. Not thread safe.
+ */
+class CompressedTrajectoryFile : boost::noncopyable
+{
+public:
+  /** \brief Magic bytes at the start of every file */
+  static const char MAGIC[8];
+
+  /** \brief Format written by write(), files of other versions are rejected */
+  static const std::uint32_t VERSION = 1;
+
+  CompressedTrajectoryFile();
+
+  /**
+   * \brief Open a file and read its header and block index
+   * \return true on success
+   */
+  bool open(const std::string &file_name);
+
+  /** \brief Close the file */
+  void close();
+
+  bool isOpen() const
+  {
+    return input_file_.is_open();
+  }
+
+  std::size_t getWaypointCount() const
+  {
+    return header_.num_waypoints_;
+  }
+
+  std::size_t getVariableCount() const
+  {
+    return header_.num_variables_;
+  }
+
+  /** \brief Empty if the variables are the robot's variables in order */
+  const std::vector<std::string> &getVariableNames() const
+  {
+    return variable_names_;
+  }
+
+  std::size_t getBlockCount() const
+  {
+    return blocks_.size();
+  }
+
+  /**
+   * \brief Decode the waypoints of one block, replacing the contents of data
+   * \return false if the block does not exist or is corrupt
+   */
+  bool readBlock(std::size_t block, TrajectoryData &data);
+
+  /**
+   * \brief Decode every waypoint
+   * \return true on success
+   */
+  bool read(TrajectoryData &data);
+
+  /**
+   * \brief Save the waypoints of data
+   * \return true on success
+   */
+  static bool write(const std::string &file_name, const TrajectoryData &data,
+                    const CompressionOptions &options = CompressionOptions());
+
+  /**
+   * \brief Save every variable of a trajectory's waypoints and their times
+   * \return true on success
+   */
+  static bool write(const std::string &file_name, const robot_trajectory::RobotTrajectory &trajectory,
+                    const CompressionOptions &options = CompressionOptions());
+
+private:
+  // Short name of this class
+  std::string name_ = "compressed_trajectory";
+
+  std::string file_name_;
+  std::ifstream input_file_;
+  CompressedTrajectoryHeader header_;
+  std::vector<std::string> variable_names_;
+  std::vector<CompressedTrajectoryBlock> blocks_;
+
+  // Reused between blocks
+  std::vector<unsigned char> compressed_;
+  std::vector<unsigned char> raw_;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_COMPRESSED_TRAJECTORY_H
@@ -0,0 +1,119 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Bulk reader of numeric CSV files that parses the whole buffer without streams or per cell strings
+*/
+
+#ifndef MOVEIT_BOILERPLATE_CSV_READER_H
+#define MOVEIT_BOILERPLATE_CSV_READER_H
+
+// C++
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+
+// ROS
+#include <ros/ros.h>
+
+namespace moveit_boilerplate
+{
+class CSVReader;
+typedef boost::shared_ptr<CSVReader> CSVReaderPtr;
+
+/**
+ * \brief Parses a buffer of comma separated numbers into one row-major array
+ *
+ * The file is read with a single read, rows are found with memchr and numbers are converted in place. Storage for
+ * all values is reserved once from the number of lines. Every row must have the same number of columns, empty
+ * lines and a trailing separator are allowed. Numbers that fit a double exactly with a power of ten up to 1e22 are
+ * converted directly, the rest fall back to strtod, so results are identical to atof.
+ */
+class CSVReader
+{
+public:
+  explicit CSVReader(char separator = ',');
+
+  /**
+   * \brief Read and parse a whole file
+   * \param skip_lines - lines at the start to ignore, e.g. 1 for a header
+   * \return true on success
+   */
+  bool parseFile(const std::string &file_name, std::size_t skip_lines = 0);
+
+  /**
+   * \brief Parse a buffer, replacing any values from before
+   * \return true on success
+   */
+  bool parse(const char *data, std::size_t size, std::size_t skip_lines = 0);
+
+  std::size_t getRowCount() const
+  {
+    return rows_;
+  }
+
+  std::size_t getColumnCount() const
+  {
+    return columns_;
+  }
+
+  /** \brief The getColumnCount() values of a row */
+  const double *getRow(std::size_t row) const
+  {
+    return &values_[row * columns_];
+  }
+
+  /**
+   * \brief Convert the number at the start of [begin, end)
+   * \return the character after the number, NULL if there is none
+   */
+  static const char *parseDouble(const char *begin, const char *end, double &value);
+
+private:
+  // Short name of this class
+  std::string name_ = "csv_reader";
+
+  char separator_;
+
+  // Reused between files
+  std::vector<char> buffer_;
+  std::vector<double> values_;
+  std::size_t rows_ = 0;
+  std::size_t columns_ = 0;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_CSV_READER_H
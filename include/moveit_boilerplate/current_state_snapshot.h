@@ -0,0 +1,153 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Lock-free copy of the robot's current joint values, fed by the planning scene monitor
+*/
+
+#ifndef MOVEIT_BOILERPLATE_CURRENT_STATE_SNAPSHOT_H
+#define MOVEIT_BOILERPLATE_CURRENT_STATE_SNAPSHOT_H
+
+// C++
+#include <atomic>
+#include <vector>
+
+// Boost
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/seqlock.h>
+
+// MoveIt
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(CurrentStateSnapshot);
+
+/**
+ * \brief Shares the current robot state between components without taking the planning scene lock
+ *
+ * Every time the planning scene monitor reports a new robot state, the joint positions and velocities are copied
+ * once into a seqlock-protected buffer. Readers copy out of that buffer without blocking each other or the monitor,
+ * and can skip the copy entirely if the version has not changed since their last read.
+ *
+ * Everything else in the state, e.g. attached bodies, is kept in a base state that is refreshed on geometry
+ * updates. One snapshot is meant to be created per node and passed to every component that needs the current state.
+ */
+class CurrentStateSnapshot
+{
+public:
+  /**
+   * \brief Constructor
+   * \param planning_scene_monitor - source of state updates, the snapshot is seeded from its current state
+   */
+  CurrentStateSnapshot(psm::PlanningSceneMonitorPtr planning_scene_monitor);
+
+  /**
+   * \brief Get a copy of the current robot state, including attached bodies
+   *        Allocates every call, components that read the state repeatedly should keep one and use update()
+   * \return a new robot state owned by the caller
+   */
+  moveit::core::RobotStatePtr getCurrentState() const;
+
+  /**
+   * \brief Refresh a robot state kept by the caller, copying only what changed since the caller's last refresh
+   *        Joint values are copied when the state version changed, everything else, e.g. attached bodies, only when
+   *        the scene version changed
+   * \param robot_state - state to refresh, allocated if NULL
+   * \param version - the state version last read by the caller, updated to the version copied
+   * \param scene_version - the scene version last read by the caller, updated to the version copied
+   * \return true if the robot state was modified
+   */
+  bool update(moveit::core::RobotStatePtr &robot_state, std::size_t &version, std::size_t &scene_version) const;
+
+  /**
+   * \brief Copy the latest joint values into a robot state if they are newer than the caller's version
+   *        Attached bodies are not touched, use getCurrentState() if they may have changed
+   * \param robot_state - state to update, must belong to the same robot model
+   * \param version - the version last read by the caller, updated to the version copied. Use 0 to force a copy
+   * \return true if the robot state was modified
+   */
+  bool update(moveit::core::RobotState &robot_state, std::size_t &version) const;
+
+  /** \brief Number of robot state updates received so far */
+  std::size_t getVersion() const
+  {
+    return buffer_->seqlock_.getVersion();
+  }
+
+  /** \brief Number of planning scene geometry updates received so far, e.g. objects added or moved */
+  std::size_t getSceneVersion() const
+  {
+    return buffer_->scene_version_.load(std::memory_order_acquire);
+  }
+
+private:
+  /** \brief Owned by the snapshot, the planning scene monitor callback only holds a weak pointer */
+  struct Buffer
+  {
+    SeqLock seqlock_;
+    boost::mutex write_mutex_;  // scene and state updates may arrive on different threads
+    std::vector<double> positions_;
+    std::vector<double> velocities_;
+    bool has_velocities_ = false;
+    std::atomic<std::size_t> scene_version_{ 0 };
+
+    // Everything besides the joint values, replaced but never modified on geometry updates. The mutex only guards
+    // the pointer, readers copy the state after releasing it
+    boost::mutex base_state_mutex_;
+    moveit::core::RobotStateConstPtr base_state_;
+  };
+  typedef boost::shared_ptr<Buffer> BufferPtr;
+  typedef boost::weak_ptr<Buffer> BufferWeakPtr;
+
+  /** \brief Copy a robot state's joint values into the buffer */
+  static void write(Buffer &buffer, const moveit::core::RobotState &robot_state);
+
+  /** \brief Copy the buffer's joint values into a robot state, the caller retries if the seqlock was written */
+  static void read(const Buffer &buffer, moveit::core::RobotState &robot_state);
+
+  /** \brief Called by the planning scene monitor after every update */
+  static void sceneUpdateCallback(const BufferWeakPtr &buffer,
+                                  const boost::weak_ptr<psm::PlanningSceneMonitor> &planning_scene_monitor,
+                                  psm::PlanningSceneMonitor::SceneUpdateType type);
+
+  BufferPtr buffer_;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_CURRENT_STATE_SNAPSHOT_H
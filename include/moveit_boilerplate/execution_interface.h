@@ -40,10 +40,16 @@
 #define MOVEIT_BOILERPLATE_EXECUTION_INTERFACE_H
 
 // C++
+#include <future>
 #include <string>
+#include <vector>
+
+// Boost
+#include <boost/thread.hpp>
 
 // ROS
 #include <ros/ros.h>
+#include <std_srvs/Trigger.h>
 #include <geometry_msgs/PoseStamped.h>
 
 // Visual tools
@@ -52,9 +58,16 @@
 // this package
 #include <moveit_boilerplate/namespaces.h>
 #include <moveit_boilerplate/deprecated.h>
+#include <moveit_boilerplate/active_variable_cache.h>
+#include <moveit_boilerplate/cartesian_streamer.h>
+#include <moveit_boilerplate/current_state_snapshot.h>
+#include <moveit_boilerplate/latency_stats.h>
+#include <moveit_boilerplate/trajectory_recorder.h>
+#include <moveit_boilerplate/trajectory_validator.h>
 
 // MoveIt
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit/controller_manager/controller_manager.h>
 
 namespace trajectory_execution_manager
 {
@@ -69,18 +82,29 @@ enum JointCommandMode
 {
   JOINT_EXECUTION_MANAGER,  // use the default MoveIt! method for sending trajectories using actionlib
   JOINT_PUBLISHER,          // send trajectories direct to ros_control using ROS messages
+  JOINT_STREAMING,          // send trajectories direct to ros_control in short windows from a background thread
 };
 
 class ExecutionInterface
 {
 public:
+  /** \brief Becomes ready with the outcome of an execution once the robot has finished moving */
+  typedef std::shared_future<moveit_controller_manager::ExecutionStatus> ExecutionFuture;
+
   /**
    * \brief Constructor
+   * \param state_snapshot - source of the current state, shared with the other components
    */
-  ExecutionInterface(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools);
+  ExecutionInterface(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools,
+                     CurrentStateSnapshotPtr state_snapshot);
+
+  /** \brief Destructor */
+  ~ExecutionInterface();
 
   /**
    * \brief Execute a desired cartesian end effector pose
+   *        With cartesian_streaming_rate set this only updates the target, which is published at that rate by a
+   *        background thread
    * \param pose
    * \return true on success
    */
@@ -93,31 +117,134 @@ public:
 
   /**
    * \brief Do a bunch of checks and send to low level controllers
+   * \param wait_for_execution - if true, block until the robot has finished moving
    * \return true on success
    */
   bool executeTrajectory(const robot_trajectory::RobotTrajectoryPtr robot_trajectory, JointModelGroup *jmg,
                          bool wait_for_execution = true);
 
+  /**
+   * \brief Do a bunch of checks and send to low level controllers without waiting for the motion to finish
+   *        In the execution manager mode completion is reported by the manager, in the publisher modes it is
+   *        detected from the joint states reaching the last waypoint within goal_position_tolerance. If they have
+   *        not by the trajectory's duration plus goal_timeout_margin, the status is TIMED_OUT.
+   *        Sending a new trajectory or calling stopExecution() preempts the previous one.
+   * \return future that holds the execution status, immediately FAILED if the trajectory could not be sent
+   */
+  ExecutionFuture executeTrajectoryAsync(const robot_trajectory::RobotTrajectoryPtr robot_trajectory,
+                                         JointModelGroup *jmg);
+
+  /**
+   * \brief Replace the trajectory being executed from a moment in the near future, without stopping the robot
+   *        The new trajectory is moved to start at the state the current one commands at the splice time, and
+   *        blended back into its own path over splice_blend_duration seconds. The controller switches to it at the
+   *        splice time. Only supported in the publisher modes, otherwise or when the robot is idle the trajectory
+   *        is executed normally
+   * \param splice_delay - how long from now to switch, must be longer than it takes to check and send the trajectory
+   * \return future completed when the robot reaches the end of the new trajectory
+   */
+  ExecutionFuture spliceTrajectoryAsync(const robot_trajectory::RobotTrajectoryPtr robot_trajectory,
+                                        JointModelGroup *jmg, const ros::Duration &splice_delay);
+
   /** \brief Stop the current execution from continuing, using ROS topics so its a "soft stop" */
   bool stopExecution();
 
   /**
-   * \brief Wait for trajectory to finish being executed
+   * \brief Wait for the last trajectory sent to finish being executed
    * \return true on success
    */
   bool waitForExecution();
 
+  /**
+   * \brief Wait for a trajectory to finish being executed
+   * \param execution - handle returned by executeTrajectoryAsync()
+   * \return true on success
+   */
+  bool waitForExecution(const ExecutionFuture &execution);
+
   /** \brief Pass through accessor function */
   trajectory_execution_manager::TrajectoryExecutionManagerPtr getTrajectoryExecutionManager()
   {
     return trajectory_execution_manager_;
   }
 
-  /** \brief Save a trajectory that is about to be executed to file, for later debugging */
+  /**
+   * \brief Convert the active joints of the trajectory's group to a message, reusing the message's existing buffers
+   *        Unlike RobotTrajectory::getRobotTrajectoryMsg() this does not allocate once the buffers are large enough
+   *        and skips the multi-DOF part. Trajectories without a group or with multi-variable joints fall back to
+   *        getRobotTrajectoryMsg()
+   * \param trajectory_msg - output
+   */
+  void convertToTrajectoryMsg(const robot_trajectory::RobotTrajectory &robot_trajectory,
+                              moveit_msgs::RobotTrajectory &trajectory_msg);
+
+  /**
+   * \brief Save a trajectory to a CSV file, for later debugging
+   *        Executed trajectories are recorded in binary by TrajectoryRecorder, this is used to convert them offline
+   */
   static bool saveTrajectory(const moveit_msgs::RobotTrajectory &trajectory_msg, const std::string &file_name,
                              const std::string &save_traj_to_file_path);
 
+  /** \brief Stages of executeTrajectoryAsync() that are timed */
+  enum LatencyStage
+  {
+    LATENCY_CONVERSION = 0,
+    LATENCY_VISUALIZATION,
+    LATENCY_VALIDATION,
+    LATENCY_CONFIRMATION,
+    LATENCY_SEND,
+    LATENCY_SAVE,
+    LATENCY_TOTAL  // everything except waiting for remote confirmation
+  };
+
+  /** \brief Timing of each stage of executeTrajectoryAsync() */
+  LatencyStats &getLatencyStats()
+  {
+    return latency_stats_;
+  }
+
+  /**
+   * \brief When the last trajectory sent started, or for a splice will start, controlling the robot
+   *        Taken when the trajectory is handed to the controller, so it includes the time spent on checks and
+   *        confirmation before sending. Zero if nothing has been sent
+   */
+  const ros::Time &getActiveTrajectoryStart() const
+  {
+    return active_trajectory_start_;
+  }
+
 private:
+  /**
+   * \brief Implementation of executeTrajectoryAsync() and spliceTrajectoryAsync()
+   * \param splice_time - zero to start immediately
+   */
+  ExecutionFuture sendTrajectory(const robot_trajectory::RobotTrajectoryPtr robot_trajectory, JointModelGroup *jmg,
+                                 const ros::Time &splice_time);
+
+  /**
+   * \brief Modify the start of a trajectory to continue from the active trajectory at the splice time
+   * \return false if there is no active trajectory or it does not control all joints of the new one
+   */
+  bool spliceIntoActiveTrajectory(trajectory_msgs::JointTrajectory &trajectory, const ros::Time &splice_time);
+
+  /**
+   * \brief Interpolate a trajectory the way the controller does: quintic if it has accelerations, cubic if it has
+   *        velocities, otherwise linear
+   * \param time - seconds from the start of the trajectory, clamped to its duration
+   * \param positions - output
+   * \param velocities - output, zero after the end
+   * \param accelerations - output, zero after the end
+   */
+  static void sampleTrajectory(const trajectory_msgs::JointTrajectory &trajectory, double time,
+                               std::vector<double> &positions, std::vector<double> &velocities,
+                               std::vector<double> &accelerations);
+
+  /** \brief Periodically publish the latency histograms */
+  void publishLatencyStats(const ros::TimerEvent &event);
+
+  /** \brief Service to print the latency histograms and return them as a table */
+  bool dumpLatencyStats(std_srvs::Trigger::Request &request, std_srvs::Trigger::Response &response);
+
   /**
    * \brief Ensure that execution manager has been loaded
    * \return true on success
@@ -126,14 +253,71 @@ private:
 
   /**
    * \brief Get the current state of the robot
+   *        Note: the returned state is refreshed in place on the next call, copy it before modifying or keeping it
    */
   moveit::core::RobotStatePtr getCurrentState();
 
   /** \brief Debug tools for visualizing in Rviz */
   void loadVisualTools();
 
-  /** \brief Check for potential errors in the trajectory been sent */
-  void checkForWaypointJumps(const trajectory_msgs::JointTrajectory &trajectory);
+  /**
+   * \brief Check if every waypoint of a trajectory is already the robot's current state, so there is nothing to move
+   * \return false if the trajectory is empty
+   */
+  bool isAtCurrentState(const robot_trajectory::RobotTrajectory &robot_trajectory, JointModelGroup *jmg);
+
+  /**
+   * \brief Check for potential errors in the trajectory been sent, such as joint jumps from IK wrap around
+   *        On errors autonomy is also disabled, so that following trajectories have to be confirmed
+   * \return false if the trajectory has errors, it is then not sent
+   */
+  bool checkForWaypointJumps(const trajectory_msgs::JointTrajectory &trajectory);
+
+  /**
+   * \brief Send the first window of a trajectory and hand the rest to the streaming thread
+   * \param trajectory_msg - pooled message, all windows are stamped relative to its header, which is set to now if
+   *        zero. A later stamp keeps the previous trajectory streaming until then
+   */
+  void streamTrajectory(const boost::shared_ptr<moveit_msgs::RobotTrajectory> &trajectory_msg);
+
+  /**
+   * \brief Publish the points of a trajectory starting at begin and covering at least duration seconds
+   *        Must be called with streaming_mutex_ locked
+   * \return index of the last point sent, which is also the first point of the next window
+   */
+  std::size_t publishStreamingWindow(const trajectory_msgs::JointTrajectory &trajectory, std::size_t begin,
+                                     double duration);
+
+  /**
+   * \brief Get a message from the pool that nobody else is holding on to
+   *        Messages keep their buffers between uses, so converting into them usually does not allocate
+   */
+  boost::shared_ptr<moveit_msgs::RobotTrajectory> acquireTrajectoryMsg();
+
+  /** \brief Background thread that sends each window ahead of the controller's playback */
+  void streamingThread();
+
+  typedef std::promise<moveit_controller_manager::ExecutionStatus> ExecutionPromise;
+
+  /** \brief Create a future that is already completed */
+  static ExecutionFuture makeExecutionFuture(moveit_controller_manager::ExecutionStatus status);
+
+  /** \brief Called by the trajectory execution manager when it is done, may outlive this object */
+  static void executionCompleteCallback(const boost::shared_ptr<ExecutionPromise> &promise,
+                                 const moveit_controller_manager::ExecutionStatus &status);
+
+  /**
+   * \brief Have the execution monitor thread watch the joint states for the end of a published trajectory
+   * \param start_time - when the controller starts executing the trajectory
+   * \return future completed by the monitor thread
+   */
+  ExecutionFuture monitorExecution(const trajectory_msgs::JointTrajectory &trajectory, const ros::Time &start_time);
+
+  /** \brief Complete the trajectory being monitored, if any */
+  void finishMonitoredExecution(moveit_controller_manager::ExecutionStatus status);
+
+  /** \brief Background thread that detects when published trajectories have finished */
+  void executionMonitorThread();
 
   /** \brief Check if correct controllers are loaded */
   bool checkTrajectoryController(ros::ServiceClient &service_client, const std::string &hardware_name,
@@ -146,6 +330,8 @@ private:
       return JOINT_PUBLISHER;
     else if (command_mode == "joint_execution_manager")
       return JOINT_EXECUTION_MANAGER;  // use actionlib
+    else if (command_mode == "joint_streaming")
+      return JOINT_STREAMING;
     else
     {
       ROS_WARN_STREAM_NAMED("execution_interface", "No command mode specified, using execution manager as default");
@@ -169,13 +355,34 @@ private:
 
   std::size_t trajectory_filename_count_ = 0;  // iterate file names
 
+  // Active joints of each group, for skipping trajectories that would not move the robot
+  ActiveVariableCache active_variables_;
+
+  // Sanity checks when check_for_waypoint_jumps is enabled
+  TrajectoryValidatorPtr trajectory_validator_;
+  TrajectoryValidationReport validation_report_;
+
+  // Writes trajectories to disk in the background when save_traj_to_file is enabled
+  TrajectoryRecorderPtr trajectory_recorder_;
+
   mvt::MoveItVisualToolsPtr visual_tools_;
 
   // Track collision objects in the environment
   psm::PlanningSceneMonitorPtr planning_scene_monitor_;
 
-  // Allocated memory for robot state
+  // Current state of the robot
+  CurrentStateSnapshotPtr state_snapshot_;
+
+  // Refreshed in place by getCurrentState(), only copying what changed
   moveit::core::RobotStatePtr current_state_;
+  std::size_t current_state_version_ = 0;
+  std::size_t current_scene_version_ = 0;
+
+  // Timing of the execution pipeline
+  LatencyStats latency_stats_;
+  ros::Publisher latency_stats_pub_;
+  ros::Timer latency_stats_timer_;
+  ros::ServiceServer latency_stats_service_;
 
   // Trajectory execution
   trajectory_execution_manager::TrajectoryExecutionManagerPtr trajectory_execution_manager_;
@@ -183,9 +390,54 @@ private:
   // Alternative method to sending trajectories than trajectory_execution_manager
   ros::Publisher joint_trajectory_pub_;
 
+  // Reusable trajectory messages, a message is free when the pool holds the only reference
+  std::vector<boost::shared_ptr<moveit_msgs::RobotTrajectory> > trajectory_msg_pool_;
+
+  // Robot state variable index of each active joint of the last group converted
+  std::string conversion_group_name_;
+  std::vector<int> conversion_indices_;
+
+  // Streaming joint command mode
+  double streaming_first_window_ = 0.1;  // seconds of trajectory sent immediately
+  double streaming_window_ = 0.5;        // seconds of trajectory sent in each following window
+  double streaming_lead_time_ = 0.2;     // how long before the controller runs out of points to send a window
+  boost::thread streaming_thread_;
+  boost::mutex streaming_mutex_;
+  boost::condition_variable streaming_condition_;
+  boost::shared_ptr<const trajectory_msgs::JointTrajectory> streaming_trajectory_;  // null when idle
+  std::size_t streaming_next_point_ = 0;            // first point of the next window to send
+  bool streaming_shutdown_ = false;
+  trajectory_msgs::JointTrajectory streaming_window_msg_;  // reused for every window
+
+  // Last trajectory sent in the publisher modes, for splicing into
+  boost::shared_ptr<const trajectory_msgs::JointTrajectory> active_trajectory_;  // null when stopped
+  ros::Time active_trajectory_start_;  // also set in the execution manager mode, when execution is requested
+  double splice_blend_duration_ = 0.5;    // seconds over which a spliced trajectory returns to its own path
+  std::vector<double> splice_positions_;  // active trajectory at the splice time, reused between splices
+  std::vector<double> splice_velocities_;
+  std::vector<double> splice_accelerations_;
+  std::vector<double> splice_offsets_;  // position, velocity and acceleration offset of each joint
+
+  // Completion of trajectories
+  ExecutionFuture last_execution_;
+  boost::thread execution_monitor_thread_;
+  boost::mutex execution_mutex_;
+  boost::condition_variable execution_condition_;
+  ExecutionPromise execution_promise_;            // trajectory being monitored, replaced for each one
+  bool execution_active_ = false;                 // whether anyone is waiting on execution_promise_
+  std::vector<int> execution_goal_indices_;       // robot state variable index of each joint
+  std::vector<double> execution_goal_positions_;  // last waypoint of the trajectory
+  ros::Time execution_start_;
+  ros::Time execution_expected_end_;
+  bool execution_left_goal_ = false;              // whether the robot has been away from the goal since the start
+  double goal_position_tolerance_ = 0.01;         // joint values are considered reached within this distance
+  double goal_timeout_margin_ = 2.0;              // seconds after the expected end to wait for the robot to get there
+  bool execution_shutdown_ = false;
+
   // Cartesian execution
   geometry_msgs::PoseStamped pose_stamped_msg_;
   ros::Publisher cartesian_command_pub_;
+  CartesianStreamerPtr cartesian_streamer_;  // null unless streaming at a fixed rate
 };  // end class
 
 }  // namespace moveit_boilerplate
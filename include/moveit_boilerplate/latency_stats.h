@@ -0,0 +1,163 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Low overhead latency histograms for timing stages of a pipeline
+*/
+
+#ifndef MOVEIT_BOILERPLATE_LATENCY_STATS_H
+#define MOVEIT_BOILERPLATE_LATENCY_STATS_H
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+// ROS
+#include <diagnostic_msgs/DiagnosticArray.h>
+
+namespace moveit_boilerplate
+{
+/**
+ * \brief Histogram of durations with power of two buckets
+ *
+ * Recording is a few relaxed atomic additions, so it is safe and cheap to call from any thread. Percentiles are
+ * only accurate to within a factor of two, which is enough to spot regressions.
+ */
+class LatencyHistogram : boost::noncopyable
+{
+public:
+  // Bucket b holds durations of [2^b, 2^(b+1)) microseconds, the last one everything longer (~35 minutes)
+  static const std::size_t NUM_BUCKETS = 32;
+
+  LatencyHistogram();
+
+  /** \brief Add one duration */
+  void record(std::chrono::steady_clock::duration duration);
+
+  /** \brief Number of durations recorded */
+  std::size_t getCount() const;
+
+  /** \brief Mean duration in seconds */
+  double getMean() const;
+
+  /** \brief Longest duration in seconds */
+  double getMax() const;
+
+  /**
+   * \brief Upper bound of the bucket containing the given fraction of durations
+   * \param fraction - between 0 and 1, e.g. 0.99 for the 99th percentile
+   * \return seconds
+   */
+  double getPercentile(double fraction) const;
+
+  /** \brief Forget all recorded durations */
+  void reset();
+
+private:
+  std::atomic<std::uint64_t> buckets_[NUM_BUCKETS];
+  std::atomic<std::uint64_t> count_;
+  std::atomic<std::uint64_t> total_us_;
+  std::atomic<std::uint64_t> max_us_;
+};
+
+/** \brief Records the time from construction to destruction into a histogram */
+class ScopedLatencyTimer : boost::noncopyable
+{
+public:
+  explicit ScopedLatencyTimer(LatencyHistogram &histogram)
+    : histogram_(histogram), start_(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedLatencyTimer()
+  {
+    histogram_.record(getElapsed());
+  }
+
+  /** \brief Time since construction, less anything excluded */
+  std::chrono::steady_clock::duration getElapsed() const
+  {
+    return std::chrono::steady_clock::now() - start_;
+  }
+
+  /** \brief Leave a duration out of this timer, e.g. a nested stage that waits for a person */
+  void exclude(std::chrono::steady_clock::duration duration)
+  {
+    start_ += duration;
+  }
+
+private:
+  LatencyHistogram &histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/** \brief One histogram per named stage of a pipeline */
+class LatencyStats : boost::noncopyable
+{
+public:
+  /** \param stage_names - stage i is accessed with getStage(i) */
+  explicit LatencyStats(const std::vector<std::string> &stage_names);
+
+  /** \brief Histogram of one stage */
+  LatencyHistogram &getStage(std::size_t stage)
+  {
+    return *histograms_[stage];
+  }
+
+  /**
+   * \brief Summarize all stages as key/value pairs, in milliseconds
+   * \param status - values are replaced, name and level are left to the caller
+   */
+  void getDiagnostics(diagnostic_msgs::DiagnosticStatus &status) const;
+
+  /** \brief Summarize all stages as a table, in milliseconds */
+  std::string toString() const;
+
+  /** \brief Forget all recorded durations */
+  void reset();
+
+private:
+  std::vector<std::string> stage_names_;
+  std::vector<boost::shared_ptr<LatencyHistogram> > histograms_;
+};
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_LATENCY_STATS_H
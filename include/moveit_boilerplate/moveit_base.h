@@ -55,6 +55,7 @@
 
 // moveit_boilerplate
 #include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/current_state_snapshot.h>
 
 // ROS parameter loading
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
@@ -101,9 +102,16 @@ public:
 
   /**
    * \brief Use the planning scene to get the robot's current state
+   *        Note: the returned state is refreshed in place on the next call, copy it before modifying or keeping it
    */
   moveit::core::RobotStatePtr getCurrentState();
 
+  /** \brief Getter for the shared current state, for passing on to other components */
+  CurrentStateSnapshotPtr getCurrentStateSnapshot()
+  {
+    return state_snapshot_;
+  }
+
   /**
    * \brief Get the published tf pose from two frames
    * \param from_frame e.g. 'world'
@@ -153,8 +161,13 @@ protected:
   planning_scene::PlanningScenePtr planning_scene_;
   psm::PlanningSceneMonitorPtr planning_scene_monitor_;
 
-  // Allocated memory for robot state
+  // Current state shared with other components
+  CurrentStateSnapshotPtr state_snapshot_;
+
+  // Refreshed in place by getCurrentState(), only copying what changed
   moveit::core::RobotStatePtr current_state_;
+  std::size_t current_state_version_ = 0;
+  std::size_t current_scene_version_ = 0;
 
 };  // end class
 
@@ -45,14 +45,22 @@
 
 // moveit_boilerplate
 #include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/active_variable_cache.h>
 #include <moveit_boilerplate/execution_interface.h>
+#include <moveit_boilerplate/robot_state_pool.h>
+#include <moveit_boilerplate/state_validity_checker.h>
+#include <moveit_boilerplate/thread_pool.h>
+#include <moveit_boilerplate/time_parameterization.h>
+#include <moveit_boilerplate/trajectory_io.h>
+#include <moveit_boilerplate/trajectory_cache.h>
+#include <moveit_boilerplate/waypoint_density.h>
 
 // ROS
 #include <ros/ros.h>
 
 // MoveIt!
-#include <moveit/trajectory_processing/iterative_time_parameterization.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <eigen_stl_containers/eigen_stl_vector_container.h>
 
 // Visual tools
 #include <moveit_visual_tools/moveit_visual_tools.h>
@@ -61,18 +69,46 @@ namespace moveit_boilerplate
 {
 MOVEIT_CLASS_FORWARD(PlanningInterface);
 
+/** \brief Settings for PlanningInterface::computeIKBatch() */
+struct IKBatchOptions
+{
+  double timeout_ = 0.0;                     // per pose, 0 uses the kinematics solver's default
+  std::size_t chunk_size_ = 50;              // consecutive poses solved in order by one thread
+  bool check_collisions_ = true;             // reject solutions in collision with the current planning scene
+  bool only_check_self_collision_ = false;   // check_collisions_ only: ignore the world
+  std::size_t collision_check_skip_every_ = 1;  // check_collisions_ only: only check every nth solution of a chunk
+  double max_joint_jump_ = 0.5;  // a larger change of any joint where two chunks meet re-solves the later one
+};
+
+/** \brief Settings for PlanningInterface::computeStraightLinePath() */
+struct CartesianPathOptions
+{
+  double max_step_ = 0.02;         // longest move of the tip between two waypoints, in meters
+  double min_step_ = 0.0005;       // steps are halved down to this before a joint space jump fails the path
+  double jump_threshold_ = 0.1;    // largest change of any joint between two waypoints, in radians or meters
+  double min_fraction_ = 1.0;      // fail if less of the desired distance could be covered
+  double ik_timeout_ = 0.0;        // per waypoint, 0 uses the kinematics solver's default
+  bool ignore_collision_ = false;  // allows recovery from a collision state
+};
+
 class PlanningInterface
 {
 public:
-  /** \brief Constructor */
+  /**
+   * \brief Constructor
+   * \param state_snapshot - source of the current state, shared with the other components
+   */
   PlanningInterface(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools,
-                    JointModelGroup* arm_jmg, moveit_boilerplate::ExecutionInterfacePtr execution_interface = moveit_boilerplate::ExecutionInterfacePtr());
+                    JointModelGroup* arm_jmg, moveit_boilerplate::ExecutionInterfacePtr execution_interface,
+                    CurrentStateSnapshotPtr state_snapshot);
 
   /** \brief Destructor */
   virtual ~PlanningInterface();
 
   /**
    * \brief Move to any pose as defined in the SRDF
+   *        With trajectory_cache_size set, the trajectory is reused when moving from the same start state again at
+   *        the same speed, until the planning scene changes
    * \param arm_jmg - the kinematic chain of joints that should be controlled (a planning group)
    * \param velocity_scaling_factor - the percent of max speed all joints should be allowed to
    * utilize
@@ -98,35 +134,176 @@ public:
    * \param velocity_scaling_factor - the percent of max speed all joints should be allowed to utilize
    * \param arm_jmg - the kinematic chain of joints that should be controlled (a planning group)
    * \param use_interpolation (recommended) whether to add more points to trajectory to make it more smooth
+   * \param time_parameterization - method for timing the trajectory, the one set by the time_parameterization
+   *        rosparam if NULL
    * \return true on success
    */
   bool convertRobotStatesToTraj(const std::vector<robot_state::RobotStatePtr>& robot_state_traj, robot_trajectory::RobotTrajectoryPtr robot_traj,
                                 JointModelGroup* arm_jmg, const double& velocity_scaling_factor,
-                                bool interpolate = true);
+                                bool interpolate = true,
+                                const TimeParameterizationPtr& time_parameterization = TimeParameterizationPtr());
   bool convertRobotStatesToTraj(robot_trajectory::RobotTrajectoryPtr robot_traj, JointModelGroup* jmg,
-                                const double& velocity_scaling_factor, bool use_interpolation);
+                                const double& velocity_scaling_factor, bool use_interpolation,
+                                const TimeParameterizationPtr& time_parameterization = TimeParameterizationPtr());
+
+  /** \brief Trajectories of moveToSRDFPoseNoPlan(), NULL if caching is disabled */
+  const TrajectoryCachePtr& getTrajectoryCache() const
+  {
+    return trajectory_cache_;
+  }
+
+  /** \brief Method used for timing trajectories when none is passed in */
+  const TimeParameterizationPtr& getTimeParameterization() const
+  {
+    return time_parameterization_;
+  }
+  void setTimeParameterization(const TimeParameterizationPtr& time_parameterization)
+  {
+    time_parameterization_ = time_parameterization;
+  }
+
+  /**
+   * \brief Solve IK for a sequence of poses of the group's end effector tip
+   *        Each pose is seeded with the solution of the previous one, so that neighbouring solutions stay close.
+   *        With ik_threads set the poses are split into chunks of options.chunk_size_ that are solved in parallel,
+   *        which requires the group's kinematics solver to be thread safe. A chunk whose first solution jumps away
+   *        from the end of the previous chunk is solved again, seeded from there
+   * \param poses - in the planning frame
+   * \param seed_state - seed of the first pose, and of the first pose of each chunk
+   * \param solutions - output, one state per pose, NULL where no solution was found
+   * \return number of poses solved
+   */
+  std::size_t computeIKBatch(JointModelGroup* jmg, const EigenSTL::vector_Affine3d& poses,
+                             const moveit::core::RobotState& seed_state,
+                             std::vector<moveit::core::RobotStatePtr>& solutions,
+                             const IKBatchOptions& options = IKBatchOptions());
+  std::size_t computeIKBatch(JointModelGroup* jmg, const std::vector<TimePose>& waypoints,
+                             const moveit::core::RobotState& seed_state,
+                             std::vector<moveit::core::RobotStatePtr>& solutions,
+                             const IKBatchOptions& options = IKBatchOptions());
+
+  /**
+   * \brief Move the end effector tip in a straight line, keeping its orientation
+   *        Steps start at options.max_step_ and are halved where IK fails or a joint would jump, then grow again.
+   *        Collisions are only checked once IK of the whole line has succeeded, in parallel when ik_threads is set,
+   *        and the path is cut before the first waypoint in collision
+   * \param direction - in the planning frame, need not be normalized
+   * \param desired_distance - distance the tip should travel
+   * \param robot_state_trajectory - resulting path, starting with start_state
+   * \param start_state - used as the base state of the robot when starting to move
+   * \param jmg - the kinematic chain of joint that should be controlled (a planning group)
+   * \param reverse_trajectory - whether to reverse the resulting path, e.g. to approach a pose found by retreating
+   * \param path_length - the distance covered by the resulting path
+   * \return true if at least options.min_fraction_ of the distance was covered
+   */
+  bool computeStraightLinePath(const Eigen::Vector3d& direction, double desired_distance,
+                               std::vector<moveit::core::RobotStatePtr>& robot_state_trajectory,
+                               const moveit::core::RobotState& start_state, JointModelGroup* jmg,
+                               bool reverse_trajectory, double& path_length,
+                               const CartesianPathOptions& options = CartesianPathOptions());
+
+  /**
+   * \brief Generic execute straight line path function, starting from the current state
+   * \param direction - in the planning frame
+   * \param reverse_path - move against direction
+   * \return true on success
+   */
+  bool executeCartesianPath(JointModelGroup* jmg, const Eigen::Vector3d& direction, double desired_distance,
+                            double velocity_scaling_factor, bool reverse_path, bool ignore_collision = false);
+
+  /**
+   * \brief Move the end effector straight up or down, e.g. to lift an object after grasping
+   * \return true on success
+   */
+  bool executeVerticlePathWithIK(JointModelGroup* jmg, double desired_lift_distance, double velocity_scaling_factor,
+                                 bool up, bool ignore_collision = false);
+
+  /**
+   * \brief Move the end effector back along the x axis of its tip link, which is its approach direction
+   * \param retreat - false to approach instead
+   * \return true on success
+   */
+  bool executeRetreatPath(JointModelGroup* jmg, double desired_retreat_distance, double velocity_scaling_factor,
+                          bool retreat, bool ignore_collision = false);
 
-private:
   /**
    * \brief Helper function for determining if robot is already in desired state
    * \param robotstate to compare to
    * \param robotstate to compare to
-   * \param arm_jmg - only compare joints in this joint model group
+   * \param arm_jmg - only compare the active joints in this joint model group
+   * \param threshold - largest difference of any joint for the states to still be equal
    * \return true if states are close enough in similarity
    */
-  bool statesEqual(const moveit::core::RobotState& s1, const moveit::core::RobotState& s2, JointModelGroup* arm_jmg);
+  bool statesEqual(const moveit::core::RobotState& s1, const moveit::core::RobotState& s2, JointModelGroup* arm_jmg,
+                   double threshold = ActiveVariableCache::DEFAULT_THRESHOLD)
+  {
+    return active_variables_.statesEqual(s1, s2, arm_jmg, threshold);
+  }
 
+private:
   /**
    * \brief Interpolate
+   *        The original waypoints are kept in the result rather than copied, so they must not be shared with states
+   *        that are modified later
    * \return true on success
    */
   bool interpolate(robot_trajectory::RobotTrajectoryPtr robot_trajectory);
 
-  /** \brief Helper for interpolate() */
-  std::size_t validSegmentCount(const moveit::core::RobotState& state1, const moveit::core::RobotState& state2) const;
+  /**
+   * \brief Helper for executeState() and moveToSRDFPoseNoPlan(), from the current state to a goal
+   * \param start_state - copied into the first waypoint
+   * \param goal_state - copied into the last waypoint
+   * \param robot_traj - output, expected to be empty
+   * \return true on success
+   */
+  bool computeTrajectoryToState(JointModelGroup* jmg, const moveit::core::RobotState& start_state,
+                                const moveit::core::RobotState& goal_state, double velocity_scaling_factor,
+                                robot_trajectory::RobotTrajectoryPtr robot_traj);
+
+  /**
+   * \brief Check the motion along a trajectory against the current planning scene
+   *        Every waypoint after the first is checked, and so are states interpolated between waypoints that are
+   *        further apart than longest_valid_segment_fraction_, so the motion is checked at that resolution all the
+   *        way. Checks run in bisection order so that a colliding path fails after few checks, across the
+   *        interpolation threads for long paths
+   * \param robot_traj - only read, so it can be shared while it is checked. The states checked are copies
+   * \return true if no checked state is in collision
+   */
+  bool validateTrajectory(const robot_trajectory::RobotTrajectory& robot_traj, JointModelGroup* jmg);
+
+  /** \brief Helper for validateTrajectory(), orders [begin, end) as the last index then midpoints breadth first */
+  static void computeBisectionOrder(std::size_t begin, std::size_t end, std::vector<std::size_t>& order);
+
+  /** \brief Send a trajectory to the execution interface */
+  bool executeTrajectory(robot_trajectory::RobotTrajectoryPtr robot_traj, JointModelGroup* jmg,
+                         const bool wait_for_execution = true);
+
+  /**
+   * \brief Helper for computeIKBatch(), solves poses [begin, end) in order
+   * \param checker - NULL to skip collision checking
+   * \return number of poses solved
+   */
+  std::size_t solveIKChunk(JointModelGroup* jmg, const std::string& tip, const EigenSTL::vector_Affine3d& poses,
+                           std::size_t begin, std::size_t end, const moveit::core::RobotState& seed_state,
+                           const StateValidityChecker* checker, const IKBatchOptions& options,
+                           std::vector<moveit::core::RobotStatePtr>& solutions);
+
+  /** \brief The link IK is solved for in a group, NULL if it has not exactly one end effector tip */
+  const moveit::core::LinkModel* getIKTip(JointModelGroup* jmg) const;
+
+  /** \brief Helper for interpolate(), fills the new states of segments [begin, end) */
+  void interpolateSegments(std::size_t begin, std::size_t end);
+
+  /**
+   * \brief Helper for interpolate()
+   * \param jmg - group the trajectory moves, NULL always divides the distance by longest_valid_segment_fraction_
+   */
+  std::size_t validSegmentCount(const moveit::core::RobotState& state1, const moveit::core::RobotState& state2,
+                                JointModelGroup* jmg) const;
 
   /**
    * \brief Use the planning scene to get the robot's current state
+   *        Note: the returned state is refreshed in place on the next call, copy it before modifying or keeping it
    */
   moveit::core::RobotStatePtr getCurrentState();
 
@@ -153,31 +330,51 @@ private:
   // Desired planning group to work with
   JointModelGroup* arm_jmg_;
 
-  const moveit::core::LinkModel* ik_tip_link_;
+  const moveit::core::LinkModel* ik_tip_link_ = NULL;
 
   // Joint Command -----------------------------------
   moveit_msgs::RobotTrajectory trajectory_msg_;
 
   // Tool for parameterizing trajectories with velocities and accelerations
-  trajectory_processing::IterativeParabolicTimeParameterization iterative_smoother_;
+  TimeParameterizationPtr time_parameterization_;
 
-  // Allocated memory for robot state
+  // Current state of the robot
+  CurrentStateSnapshotPtr state_snapshot_;
+
+  // Refreshed in place by getCurrentState(), only copying what changed
   moveit::core::RobotStatePtr current_state_;
+  std::size_t current_state_version_ = 0;
+  std::size_t current_scene_version_ = 0;
+
+  // Active joints of each group, for statesEqual()
+  ActiveVariableCache active_variables_;
+
+  // Reused by interpolate() so that steady state planning does not allocate
+  RobotStatePoolPtr state_pool_;
+  std::vector<std::size_t> segment_counts_;
+  std::vector<std::size_t> segment_offsets_;
+  std::vector<moveit::core::RobotStatePtr> original_waypoints_;
+  std::vector<moveit::core::RobotStatePtr> interpolated_states_;
 
-  // TODO: this should be same value found in longest_valid_segment_fraction: 0.05
-  // make this adjustable - this value is probably robot specific
+  // Split interpolation of long trajectories across threads, NULL when interpolating serially
+  ThreadPoolPtr interpolation_pool_;
+  std::size_t parallel_interpolation_min_states_ = 0;
+
+  // Collision check interpolated trajectories before executing them
+  bool validate_before_execution_ = false;
+  std::size_t parallel_validation_min_states_ = 0;
+
+  // Solves chunks of computeIKBatch() and checks straight line paths in parallel, NULL when working serially
+  ThreadPoolPtr ik_pool_;
+
+  // Trajectories to SRDF poses, NULL when disabled
+  TrajectoryCachePtr trajectory_cache_;
+
+  // Adaptive waypoint density for interpolate(), NULL divides the joint distance by longest_valid_segment_fraction_
+  WaypointDensityPtr waypoint_density_;
   double longest_valid_segment_fraction_ = 0.1;
 };  // end class
 
 }  // namespace moveit_boilerplate
 
-namespace
-{
-/** \brief Collision checking handle for IK solvers */
-bool isStateValid(const planning_scene::PlanningScene* planning_scene, bool verbose, bool only_check_self_collision,
-                  mvt::MoveItVisualToolsPtr visual_tools_, robot_state::RobotState* state,
-                  const robot_state::JointModelGroup* group, const double* ik_solution,
-                  std::size_t collision_check_skip_every);
-}
-
 #endif  // MOVEIT_BOILERPLATE_PLANNING_INTERFACE_H
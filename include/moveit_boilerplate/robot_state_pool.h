@@ -0,0 +1,101 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Reusable robot states, to avoid allocating a new state for every waypoint
+*/
+
+#ifndef MOVEIT_BOILERPLATE_ROBOT_STATE_POOL_H
+#define MOVEIT_BOILERPLATE_ROBOT_STATE_POOL_H
+
+// C++
+#include <vector>
+
+// MoveIt
+#include <moveit/robot_state/robot_state.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(RobotStatePool);
+
+/**
+ * \brief Hands out robot states that can be kept in trajectories like any other RobotStatePtr
+ *
+ * The pool keeps a reference to every state it created. A state is free again once the pool holds its only
+ * reference, e.g. after the trajectory it was added to is destroyed. Copying into a reused state does not allocate
+ * unless attached bodies are copied. Not thread safe, but states may be released from any thread.
+ *
+ * Finding a free state is a scan over the pool, so the pool stops growing at max_size. Past that, states are
+ * allocated normally and freed with their last reference.
+ */
+class RobotStatePool
+{
+public:
+  /** \brief Default for max_size */
+  static const std::size_t DEFAULT_MAX_SIZE = 4096;
+
+  /**
+   * \brief Constructor
+   * \param max_size - most states kept for reuse
+   */
+  RobotStatePool(moveit::core::RobotModelConstPtr robot_model, std::size_t max_size = DEFAULT_MAX_SIZE);
+
+  /** \brief Get one state, set to a copy of prototype */
+  moveit::core::RobotStatePtr acquire(const moveit::core::RobotState &prototype);
+
+  /**
+   * \brief Get several states at once, each set to a copy of prototype
+   * \param states - output, cleared first. Its capacity is kept so it can be reused between calls
+   */
+  void acquire(std::size_t count, const moveit::core::RobotState &prototype,
+               std::vector<moveit::core::RobotStatePtr> &states);
+
+  /** \brief Number of states kept for reuse, free or not */
+  std::size_t size() const
+  {
+    return states_.size();
+  }
+
+private:
+  // Short name of this class
+  std::string name_ = "robot_state_pool";
+
+  moveit::core::RobotModelConstPtr robot_model_;
+  std::size_t max_size_;
+  std::vector<moveit::core::RobotStatePtr> states_;
+  std::size_t next_ = 0;  // where the next scan starts, states before it were handed out recently
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_ROBOT_STATE_POOL_H
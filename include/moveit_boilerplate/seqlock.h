@@ -0,0 +1,111 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Sequence lock for sharing small buffers between one writer and many
+           readers without blocking the readers
+*/
+
+#ifndef MOVEIT_BOILERPLATE_SEQLOCK_H
+#define MOVEIT_BOILERPLATE_SEQLOCK_H
+
+// C++
+#include <atomic>
+#include <cstddef>
+
+namespace moveit_boilerplate
+{
+/**
+ * \brief Sequence counter guarding a plain-data buffer
+ *
+ * The writer brackets its modifications with writeBegin()/writeEnd(). Readers copy the data between readBegin() and
+ * readRetry() and start over if a write happened in the meantime. Writers must be serialized externally.
+ */
+class SeqLock
+{
+public:
+  SeqLock() : sequence_(0)
+  {
+  }
+
+  /** \brief Mark the protected data as being modified */
+  void writeBegin()
+  {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** \brief Publish the modified data */
+  void writeEnd()
+  {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * \brief Start reading, waits for any write in progress to finish
+   * \return sequence number to pass to readRetry()
+   */
+  std::size_t readBegin() const
+  {
+    std::size_t sequence;
+    while ((sequence = sequence_.load(std::memory_order_acquire)) & 1)
+      ;  // writer is busy, its critical section is only a copy
+    return sequence;
+  }
+
+  /** \brief Returns true if the data was modified while reading and must be read again */
+  bool readRetry(std::size_t sequence) const
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sequence_.load(std::memory_order_relaxed) != sequence;
+  }
+
+  /** \brief Number of completed writes, the version of the data returned by a read that began at this sequence */
+  static std::size_t toVersion(std::size_t sequence)
+  {
+    return sequence >> 1;
+  }
+
+  /** \brief Number of completed writes */
+  std::size_t getVersion() const
+  {
+    return toVersion(sequence_.load(std::memory_order_acquire));
+  }
+
+private:
+  std::atomic<std::size_t> sequence_;
+};
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_SEQLOCK_H
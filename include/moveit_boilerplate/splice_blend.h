@@ -0,0 +1,114 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Quintic blend that fades out the offset between two trajectories at a splice
+*/
+
+#ifndef MOVEIT_BOILERPLATE_SPLICE_BLEND_H
+#define MOVEIT_BOILERPLATE_SPLICE_BLEND_H
+
+namespace moveit_boilerplate
+{
+/**
+ * \brief Weights of the offsets in position, velocity and acceleration at a moment of a splice blend
+ *
+ * The blended offset is a quintic in s = time / duration that starts at the given position, velocity and
+ * acceleration offsets and reaches zero with zero velocity and acceleration at s = 1. Adding it to a trajectory keeps
+ * position, velocity and acceleration continuous at both ends of the blend.
+ */
+struct SpliceBlendWeights
+{
+  /**
+   * \brief Constructor
+   * \param time - seconds since the splice, clamped to [0, duration]
+   * \param duration - length of the blend in seconds, with zero the offsets only apply at time zero
+   */
+  SpliceBlendWeights(double time, double duration)
+  {
+    // At the splice the offsets apply in full, after the blend not at all
+    if (time <= 0 || time >= duration)
+    {
+      const double weight = time <= 0 ? 1 : 0;
+      for (int k = 0; k < 3; ++k)
+        position_[k] = velocity_[k] = acceleration_[k] = 0;
+      position_[0] = velocity_[1] = acceleration_[2] = weight;
+      return;
+    }
+    const double s = time / duration;
+    const double s2 = s * s;
+    const double s3 = s2 * s;
+    const double s4 = s3 * s;
+    const double s5 = s4 * s;
+    const double inv = 1 / duration;
+
+    // Quintic Hermite basis functions that vanish with their first two derivatives at s = 1
+    position_[0] = 1 - 10 * s3 + 15 * s4 - 6 * s5;
+    position_[1] = (s - 6 * s3 + 8 * s4 - 3 * s5) * duration;
+    position_[2] = (0.5 * s2 - 1.5 * s3 + 1.5 * s4 - 0.5 * s5) * duration * duration;
+    velocity_[0] = (-30 * s2 + 60 * s3 - 30 * s4) * inv;
+    velocity_[1] = 1 - 18 * s2 + 32 * s3 - 15 * s4;
+    velocity_[2] = (s - 4.5 * s2 + 6 * s3 - 2.5 * s4) * duration;
+    acceleration_[0] = (-60 * s + 180 * s2 - 120 * s3) * inv * inv;
+    acceleration_[1] = (-36 * s + 96 * s2 - 60 * s3) * inv;
+    acceleration_[2] = 1 - 9 * s + 18 * s2 - 10 * s3;
+  }
+
+  /** \brief Blended position offset, from the offsets at the splice */
+  double position(double position_offset, double velocity_offset, double acceleration_offset) const
+  {
+    return position_[0] * position_offset + position_[1] * velocity_offset + position_[2] * acceleration_offset;
+  }
+
+  /** \brief Blended velocity offset, from the offsets at the splice */
+  double velocity(double position_offset, double velocity_offset, double acceleration_offset) const
+  {
+    return velocity_[0] * position_offset + velocity_[1] * velocity_offset + velocity_[2] * acceleration_offset;
+  }
+
+  /** \brief Blended acceleration offset, from the offsets at the splice */
+  double acceleration(double position_offset, double velocity_offset, double acceleration_offset) const
+  {
+    return acceleration_[0] * position_offset + acceleration_[1] * velocity_offset +
+           acceleration_[2] * acceleration_offset;
+  }
+
+  // Weight of the position, velocity and acceleration offset in each
+  double position_[3];
+  double velocity_[3];
+  double acceleration_[3];
+};
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_SPLICE_BLEND_H
@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Collision checking callback for IK solvers that can be used from several threads at once
+*/
+
+#ifndef MOVEIT_BOILERPLATE_STATE_VALIDITY_CHECKER_H
+#define MOVEIT_BOILERPLATE_STATE_VALIDITY_CHECKER_H
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+
+// MoveIt
+#include <moveit/planning_scene/planning_scene.h>
+
+// Visual tools
+#include <moveit_visual_tools/moveit_visual_tools.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(StateValidityChecker);
+
+/**
+ * \brief Checks IK solutions for collisions against a planning scene
+ *
+ * The checker only holds settings and a pointer to the planning scene, which the caller keeps read-locked, e.g. with
+ * a LockedPlanningSceneRO, for as long as checks may run. Each thread or IK call makes its own Context, which owns a
+ * scratch robot state and the count used by collision_check_skip_every, so contexts never share mutable state and
+ * the same IK call always skips the same checks.
+ */
+class StateValidityChecker
+{
+public:
+  /** \brief Per thread or per IK call state of a checker, made by createContext(). Not thread safe itself */
+  class Context
+  {
+  public:
+
+    /**
+     * \brief Check an IK solution, for use as a GroupStateValidityCallbackFn
+     * \param state - the state IK is solving for, only read. Its other joints are copied to the scratch state
+     * \return true if the solution is not in collision or its check was skipped
+     */
+    bool isValid(moveit::core::RobotState *state, JointModelGroup *group, const double *ik_solution);
+
+    /** \brief Callback for RobotState::setFromIK(), bound to this context which must outlive it */
+    moveit::core::GroupStateValidityCallbackFn getCallback();
+
+    /** \brief Start counting for collision_check_skip_every from zero again */
+    void reset();
+
+    /** \brief Number of solutions that were collision checked */
+    std::size_t getCheckCount() const
+    {
+      return check_count_;
+    }
+
+    /** \brief Number of checked solutions found in collision */
+    std::size_t getCollisionCount() const
+    {
+      return collision_count_;
+    }
+
+  private:
+    friend class StateValidityChecker;
+
+    /** \brief Constructor, the scratch state starts as the planning scene's current state so it needs a scene */
+    explicit Context(const StateValidityChecker &checker);
+
+    const StateValidityChecker *checker_;
+    moveit::core::RobotState scratch_state_;
+    std::size_t call_count_ = 0;
+    std::size_t check_count_ = 0;
+    std::size_t collision_count_ = 0;
+  };
+  typedef boost::shared_ptr<Context> ContextPtr;
+
+  /**
+   * \brief Constructor
+   * \param planning_scene - must stay valid and read-locked while contexts are in use
+   * \param only_check_self_collision - ignore the world
+   * \param collision_check_skip_every - only check every nth solution of a context, 1 checks all
+   * \param visual_tools - if set, collisions are shown in Rviz
+   */
+  StateValidityChecker(const planning_scene::PlanningScene *planning_scene, bool only_check_self_collision = false,
+                       std::size_t collision_check_skip_every = 1,
+                       mvt::MoveItVisualToolsPtr visual_tools = mvt::MoveItVisualToolsPtr());
+
+  /**
+   * \brief Make a context for one thread or IK call
+   * \return NULL if the checker has no planning scene
+   */
+  ContextPtr createContext() const;
+
+  /**
+   * \brief Check a state for collision, thread safe
+   * \param state - must have up to date transforms
+   * \return true if not in collision, false if in collision or there is no planning scene
+   */
+  bool isStateValid(const moveit::core::RobotState &state, JointModelGroup *group) const;
+
+  const planning_scene::PlanningScene *getPlanningScene() const
+  {
+    return planning_scene_;
+  }
+
+private:
+  // Short name of this class
+  std::string name_ = "state_validity_checker";
+
+  const planning_scene::PlanningScene *planning_scene_;
+  bool only_check_self_collision_;
+  std::size_t collision_check_skip_every_;
+
+  // Only one thread at a time shows its collision
+  mvt::MoveItVisualToolsPtr visual_tools_;
+  mutable boost::mutex visual_tools_mutex_;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_STATE_VALIDITY_CHECKER_H
@@ -0,0 +1,224 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Loads a joint trajectory file in windows on a background thread and starts executing it before the whole
+           file has been read
+*/
+
+#ifndef MOVEIT_BOILERPLATE_STREAMING_TRAJECTORY_LOADER_H
+#define MOVEIT_BOILERPLATE_STREAMING_TRAJECTORY_LOADER_H
+
+// C++
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/thread.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/execution_interface.h>
+#include <moveit_boilerplate/time_parameterization.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(StreamingTrajectoryLoader);
+
+/**
+ * \brief Executes a joint trajectory file while it is still being read
+ *
+ * A background thread reads the file, CSV like TrajectoryIO::loadJointTrajectoryFromFile(), the binary format of
+ * BinaryTrajectoryFile or a CompressedTrajectoryFile decoded a block at a time, window_size waypoints at a time. Each
+ * window is time parameterized together with overlap waypoints on either side so that the ramps to and from rest at the
+ * ends of a parameterization fall outside the waypoints that are kept. The first overlap waypoints of a window were
+ * also timed by the previous window, as its overlap after it, and their durations, velocities and accelerations are
+ * crossfaded from that timing to the new one, so they change gradually across the seam instead of jumping. The first
+ * window is executed as soon as it is ready, every following one is spliced into the motion with
+ * ExecutionInterface::spliceTrajectoryAsync(), from splice_delay seconds in the future to the end of what has been
+ * loaded, once the robot is within lookahead seconds of the end of the previous one. Each trajectory sent ends with
+ * the overlap slowing down to rest, so if loading falls behind the robot stops on the path instead of at speed. Only
+ * the waypoints not yet passed and about two windows are kept in memory. Handing over without a pause needs one of
+ * ExecutionInterface's publisher modes, the execution manager preempts.
+ */
+class StreamingTrajectoryLoader
+{
+public:
+  /**
+   * \brief Constructor
+   * \param time_parameterization - method for timing the windows, iterative parabolic if not provided
+   */
+  StreamingTrajectoryLoader(psm::PlanningSceneMonitorPtr planning_scene_monitor,
+                            ExecutionInterfacePtr execution_interface,
+                            TimeParameterizationPtr time_parameterization = TimeParameterizationPtr());
+
+  /** \brief Destructor, stops loading */
+  ~StreamingTrajectoryLoader();
+
+  /**
+   * \brief Load and execute a joint trajectory file, blocking until the robot has finished moving
+   *        The first waypoint should be the current state of the robot. Variables of the current state that are not
+   *        in a binary or compressed file keep their values
+   * \param file_name - CSV file of all robot variables, or a file written by BinaryTrajectoryFile or
+   *                    CompressedTrajectoryFile
+   * \param jmg - the planning group that is controlled
+   * \param velocity_scaling_factor - fraction of the joint velocity limits to use, in (0, 1]
+   * \param header - CSV only: if true, skips the first line
+   * \return true on success
+   */
+  bool execute(const std::string &file_name, JointModelGroup *jmg, double velocity_scaling_factor = 1.0,
+               bool header = false);
+
+  /** \brief Stop a running execute() from another thread, along with the robot */
+  void stop();
+
+  /** \brief Waypoints read from the file by the last execute() */
+  std::size_t getLoadedWaypointCount() const
+  {
+    return loaded_waypoints_;
+  }
+
+  /** \brief Most waypoints held in memory at once by the last execute(), for checking the memory bound */
+  std::size_t getPeakBufferedWaypointCount() const
+  {
+    return peak_buffered_waypoints_;
+  }
+
+private:
+  /** \brief Waypoints of one window, timed from the start of the file */
+  struct Window
+  {
+    // Waypoints that are executed
+    std::vector<moveit::core::RobotStatePtr> states_;
+    std::vector<double> times_;
+
+    // Slows down to rest after states_, executed only until the next window replaces it
+    std::vector<moveit::core::RobotStatePtr> tail_;
+    std::vector<double> tail_times_;
+
+    // Nothing follows, the tail is empty
+    bool last_ = false;
+  };
+
+  /** \brief Read and parameterize the file, queueing windows until the end of the file or an error */
+  void loadThread(std::string file_name, JointModelGroup *jmg, double velocity_scaling_factor, bool header);
+
+  /**
+   * \brief Time a window of raw waypoints and queue the kept part
+   * \param raw - waypoints from the overlap before the window to the overlap after it
+   * \param lead - number of waypoints of raw before the window
+   * \param count - number of waypoints in the window
+   * \param last - true if the window reaches the end of the file
+   * \return false if the time parameterization failed
+   */
+  bool queueWindow(const std::deque<moveit::core::RobotStatePtr> &raw, std::size_t lead, std::size_t count, bool last,
+                   JointModelGroup *jmg, double velocity_scaling_factor);
+
+  /**
+   * \brief Wait for the loading thread to queue a window
+   * \return false if loading failed or stop() was called
+   */
+  bool popWindow(Window &window);
+
+  /**
+   * \brief Sleep until the robot reaches a time in the file, in ROS time so that it also follows simulated time
+   * \param start - when the controller is at time 0 of the file, from the stamps of the trajectories sent
+   * \return false if stop() was called
+   */
+  bool waitUntil(double file_time, const ros::Time &start);
+
+  /**
+   * \brief Build the trajectory to send from the waypoints that are not yet executed
+   * \param start_time - time from the start of the file at which the trajectory begins
+   */
+  robot_trajectory::RobotTrajectoryPtr makeTrajectory(JointModelGroup *jmg, double start_time,
+                                                      const Window &latest) const;
+
+  /** \brief Mark the end of the loading thread and wake up execute() */
+  void finishLoading();
+
+  // Short name of this class
+  std::string name_;
+
+  // A shared node handle
+  ros::NodeHandle nh_;
+
+  // Core MoveIt components
+  psm::PlanningSceneMonitorPtr planning_scene_monitor_;
+  ExecutionInterfacePtr execution_interface_;
+  TimeParameterizationPtr time_parameterization_;
+
+  // Settings from rosparam
+  std::size_t window_size_;
+  std::size_t overlap_;
+  double splice_delay_;
+  double lookahead_;
+  std::size_t max_queued_windows_;
+
+  // Current state when execute() was called, provides the variables a file does not have
+  moveit::core::RobotStatePtr start_state_;
+
+  // Windows passed from the loading thread to execute()
+  std::deque<Window> windows_;
+  boost::mutex windows_mutex_;
+  boost::condition_variable windows_condition_;
+  bool loading_done_ = false;
+  std::atomic<bool> stop_requested_{ false };
+  boost::thread load_thread_;
+
+  // Waypoints sent to the controller that it has not passed yet, with their time from the start of the file
+  std::deque<moveit::core::RobotStatePtr> pending_states_;
+  std::deque<double> pending_times_;
+
+  // Time from the start of the file of the last kept waypoint, used to continue timing in the next window
+  double loaded_duration_ = 0;
+
+  // Overlap after the last queued window as timed by it, with durations from the previous waypoint. The next window
+  // crossfades from this timing
+  std::vector<moveit::core::RobotStatePtr> previous_tail_;
+  std::vector<double> previous_tail_durations_;
+
+  // Waypoints held by the loading thread and in windows_, for the memory statistics
+  std::atomic<std::size_t> raw_waypoints_{ 0 };
+  std::atomic<std::size_t> queued_waypoints_{ 0 };
+
+  // Statistics of the last execute()
+  std::atomic<std::size_t> loaded_waypoints_{ 0 };
+  std::atomic<std::size_t> peak_buffered_waypoints_{ 0 };
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_STREAMING_TRAJECTORY_LOADER_H
@@ -0,0 +1,125 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Fixed set of worker threads for splitting a loop over independent items
+*/
+
+#ifndef MOVEIT_BOILERPLATE_THREAD_POOL_H
+#define MOVEIT_BOILERPLATE_THREAD_POOL_H
+
+// C++
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace moveit_boilerplate
+{
+class ThreadPool;
+typedef boost::shared_ptr<ThreadPool> ThreadPoolPtr;
+
+/**
+ * \brief Runs a range of indices across a fixed set of threads, blocking until all of them are done
+ *
+ * The calling thread works on the range too, so a pool of N threads starts N - 1 workers. The range is split into
+ * contiguous chunks that threads take in turn, which balances uneven work without a task per index.
+ * Only one parallelFor() runs at a time; concurrent callers wait for each other.
+ */
+class ThreadPool : boost::noncopyable
+{
+public:
+  /** \brief Function called with a chunk [begin, end) of the range. Must not throw */
+  typedef boost::function<void(std::size_t begin, std::size_t end)> RangeFunction;
+
+  /**
+   * \brief Constructor
+   * \param num_threads - total threads including the caller, 0 uses one per hardware thread
+   */
+  explicit ThreadPool(std::size_t num_threads = 0);
+
+  /** \brief Destructor, joins the workers */
+  ~ThreadPool();
+
+  /** \brief Threads used by parallelFor(), including the caller */
+  std::size_t getNumThreads() const
+  {
+    return workers_.size() + 1;
+  }
+
+  /**
+   * \brief Call fn over [begin, end) split into chunks, returning once every chunk has finished
+   * \param min_chunk_size - smallest chunk worth handing to another thread
+   */
+  void parallelFor(std::size_t begin, std::size_t end, const RangeFunction &fn, std::size_t min_chunk_size = 1);
+
+private:
+  /** \brief Wait for jobs until shutdown */
+  void workerLoop();
+
+  /** \brief Take chunks of the current job until none are left */
+  void runChunks();
+
+  // Short name of this class
+  std::string name_ = "thread_pool";
+
+  std::vector<boost::shared_ptr<boost::thread> > workers_;
+
+  // Serializes calls to parallelFor()
+  boost::mutex call_mutex_;
+
+  // Protects the job description and worker bookkeeping
+  boost::mutex mutex_;
+  boost::condition_variable work_cond_;
+  boost::condition_variable done_cond_;
+  std::size_t generation_ = 0;
+  std::size_t busy_workers_ = 0;
+  bool shutdown_ = false;
+
+  // Current job, read-only while workers are busy
+  const RangeFunction *job_fn_ = NULL;
+  std::size_t job_begin_ = 0;
+  std::size_t job_end_ = 0;
+  std::size_t job_chunk_size_ = 1;
+  std::size_t job_num_chunks_ = 0;
+  std::atomic<std::size_t> next_chunk_;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_THREAD_POOL_H
@@ -0,0 +1,173 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Interchangeable methods for adding velocities, accelerations and timing to a path
+*/
+
+#ifndef MOVEIT_BOILERPLATE_TIME_PARAMETERIZATION_H
+#define MOVEIT_BOILERPLATE_TIME_PARAMETERIZATION_H
+
+// C++
+#include <string>
+#include <vector>
+
+// MoveIt
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/trajectory_processing/iterative_time_parameterization.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(TimeParameterization);
+
+/**
+ * \brief Sets the waypoint durations, velocities and accelerations of a trajectory without changing its path
+ *
+ * Velocity and acceleration limits come from the robot model, unbounded joints default to 1.0 like in
+ * trajectory_processing::IterativeParabolicTimeParameterization. Only the variables of the trajectory's group are
+ * parameterized, so it must have one.
+ */
+class TimeParameterization
+{
+public:
+  virtual ~TimeParameterization()
+  {
+  }
+
+  /**
+   * \brief Parameterize a trajectory in place
+   * \param velocity_scaling_factor - fraction of the joint velocity limits to use, in (0, 1]
+   * \param acceleration_scaling_factor - fraction of the joint acceleration limits to use, in (0, 1]
+   * \return true on success
+   */
+  virtual bool computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory, double velocity_scaling_factor = 1.0,
+                                 double acceleration_scaling_factor = 1.0) const = 0;
+
+  /** \brief Name used to select this method, e.g. in the time_parameterization rosparam */
+  virtual const std::string &getName() const = 0;
+};
+
+/** \brief trajectory_processing::IterativeParabolicTimeParameterization, the MoveIt default */
+class IterativeParabolicParameterization : public TimeParameterization
+{
+public:
+  static const std::string NAME;
+
+  bool computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory, double velocity_scaling_factor = 1.0,
+                         double acceleration_scaling_factor = 1.0) const;
+
+  const std::string &getName() const
+  {
+    return NAME;
+  }
+
+private:
+  trajectory_processing::IterativeParabolicTimeParameterization iterative_smoother_;
+};
+
+/**
+ * \brief Accelerate, cruise and decelerate along the piecewise linear path through the waypoints
+ *
+ * A forward and a backward pass over the waypoints pick a path speed at each waypoint that respects the joint
+ * velocity and acceleration limits, with the turn at each waypoint spread over half of the segments next to it. Each
+ * segment is then timed as a trapezoidal speed profile, so sparse paths are timed correctly, but the controller's
+ * spline between waypoints is only constrained at the waypoints - use with densely interpolated paths. This is a
+ * heuristic, not time-optimal path parameterization such as TOPP or TOTG: the turning model is approximate, so the
+ * result is usually close to but not guaranteed to be the fastest. Linear in the number of waypoints, with no
+ * iterations.
+ */
+class TrapezoidalParameterization : public TimeParameterization
+{
+public:
+  static const std::string NAME;
+
+  bool computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory, double velocity_scaling_factor = 1.0,
+                         double acceleration_scaling_factor = 1.0) const;
+
+  const std::string &getName() const
+  {
+    return NAME;
+  }
+};
+
+/**
+ * \brief Trapezoidal profile slowed down until it is within a jerk limit
+ *
+ * Runs the TrapezoidalParameterization passes repeatedly, each time lowering the acceleration allowed on segments
+ * whose joint jerk is over the limit. A segment's jerk is the spread of the accelerations at its waypoints and in its
+ * accelerate and decelerate phases over its duration, so switching between them within a segment counts too. The
+ * allowed acceleration grows back around those segments no faster than the jerk limit, so the acceleration ramps
+ * instead of stepping. Segments that keep violating the limit, usually from turning, also get a lower speed. The
+ * robot model has no jerk limits, so a single limit is used for all joints.
+ */
+class JerkLimitedParameterization : public TimeParameterization
+{
+public:
+  static const std::string NAME;
+  static const double DEFAULT_MAX_JERK;
+
+  /**
+   * \brief Constructor
+   * \param max_jerk - limit of every joint, in units per second cubed
+   * \param max_iterations - passes over the trajectory before giving up on reaching the limit
+   */
+  JerkLimitedParameterization(double max_jerk = DEFAULT_MAX_JERK, std::size_t max_iterations = 100);
+
+  bool computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory, double velocity_scaling_factor = 1.0,
+                         double acceleration_scaling_factor = 1.0) const;
+
+  const std::string &getName() const
+  {
+    return NAME;
+  }
+
+private:
+  double max_jerk_;
+  std::size_t max_iterations_;
+};
+
+/**
+ * \brief Create a time parameterization by name
+ * \param name - iterative_parabolic, trapezoidal or jerk_limited
+ * \param max_jerk - only used by jerk_limited
+ * \return NULL if the name is unknown
+ */
+TimeParameterizationPtr createTimeParameterization(const std::string &name,
+                                                   double max_jerk = JerkLimitedParameterization::DEFAULT_MAX_JERK);
+
+/** \brief Names accepted by createTimeParameterization() */
+std::vector<std::string> getTimeParameterizationNames();
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_TIME_PARAMETERIZATION_H
@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Reuses parameterized trajectories of motions that are repeated from the same start state
+*/
+
+#ifndef MOVEIT_BOILERPLATE_TRAJECTORY_CACHE_H
+#define MOVEIT_BOILERPLATE_TRAJECTORY_CACHE_H
+
+// C++
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/thread/mutex.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/active_variable_cache.h>
+
+// MoveIt
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(TrajectoryCache);
+
+/**
+ * \brief Least recently used cache of trajectories to named targets, e.g. SRDF poses
+ *
+ * Entries are keyed by the planning group, target name, velocity scaling factor and the start state's active
+ * variables rounded to the quantization step. A lookup only returns an entry whose exact start, over every variable
+ * of the robot, is within the start tolerance of the requested start. So a trajectory is never reused from somewhere
+ * it does not begin, nor after joints outside the group have moved and might now be in its way. All entries are
+ * dropped when the scene version changes. Cached trajectories are shared and must not be modified. Thread safe.
+ */
+class TrajectoryCache
+{
+public:
+  /**
+   * \brief Constructor
+   * \param capacity - number of trajectories kept
+   * \param quantization - bin size of the start state in the key, in radians or meters
+   * \param start_tolerance - largest difference of any variable from the cached start, in radians or meters
+   */
+  TrajectoryCache(std::size_t capacity = 32, double quantization = 0.01,
+                  double start_tolerance = ActiveVariableCache::DEFAULT_THRESHOLD);
+
+  /**
+   * \brief Find a trajectory that starts at start_state
+   * \param scene_version - version of the planning scene the trajectory will be executed in
+   * \return NULL if none is cached
+   */
+  robot_trajectory::RobotTrajectoryPtr lookup(const moveit::core::RobotState &start_state, JointModelGroup *jmg,
+                                              const std::string &target, double velocity_scaling_factor,
+                                              std::size_t scene_version);
+
+  /**
+   * \brief Store a trajectory, replacing any with the same key and evicting the least recently used if full
+   * \param start_state - the state the trajectory begins at
+   * \param scene_version - version of the planning scene the trajectory was computed in
+   */
+  void insert(const moveit::core::RobotState &start_state, JointModelGroup *jmg, const std::string &target,
+              double velocity_scaling_factor, std::size_t scene_version,
+              const robot_trajectory::RobotTrajectoryPtr &trajectory);
+
+  /** \brief Remove all trajectories */
+  void clear();
+
+  /** \brief Number of trajectories cached */
+  std::size_t size() const;
+
+  /** \brief Number of lookups that returned a trajectory */
+  std::size_t getHitCount() const;
+
+  /** \brief Number of lookups that did not return a trajectory */
+  std::size_t getMissCount() const;
+
+private:
+  struct Key
+  {
+    std::string group_;
+    std::string target_;
+    std::int64_t velocity_;
+    std::vector<std::int64_t> start_;
+
+    bool operator<(const Key &other) const;
+  };
+
+  struct Entry
+  {
+    robot_trajectory::RobotTrajectoryPtr trajectory_;
+    std::vector<double> start_positions_;  // all variables of the start state
+    std::list<Key>::iterator recent_;  // position in recent_keys_
+  };
+
+  /** \brief Build the key from the group's active variables and copy all of the start state's variables */
+  void makeKey(const moveit::core::RobotState &start_state, JointModelGroup *jmg, const std::string &target,
+               double velocity_scaling_factor, Key &key, std::vector<double> &start_positions);
+
+  /** \brief Drop all entries if the scene has changed. Requires mutex_ */
+  void checkSceneVersion(std::size_t scene_version);
+
+  // Short name of this class
+  std::string name_ = "trajectory_cache";
+
+  std::size_t capacity_;
+  double quantization_;
+  double start_tolerance_;
+
+  ActiveVariableCache active_variables_;
+
+  mutable boost::mutex mutex_;
+  std::map<Key, Entry> entries_;
+  std::list<Key> recent_keys_;  // most recently used first
+  std::size_t scene_version_ = 0;
+  std::size_t hit_count_ = 0;
+  std::size_t miss_count_ = 0;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_TRAJECTORY_CACHE_H
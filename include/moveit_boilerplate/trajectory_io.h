@@ -45,6 +45,11 @@
 
 // PickNik
 #include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/current_state_snapshot.h>
+#include <moveit_boilerplate/binary_trajectory.h>
+#include <moveit_boilerplate/compressed_trajectory.h>
+#include <moveit_boilerplate/csv_reader.h>
+#include <moveit_boilerplate/robot_state_pool.h>
 
 // MoveIt
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
@@ -70,8 +75,10 @@ class TrajectoryIO
 public:
   /**
    * \brief Constructor
+   * \param state_snapshot - source of the current state, shared with the other components
    */
-  TrajectoryIO(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools);
+  TrajectoryIO(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools,
+               CurrentStateSnapshotPtr state_snapshot);
 
   // JOINT TRAJECTORY ------------------------------------------------------------------
 
@@ -99,6 +106,44 @@ public:
    */
   bool saveJointTrajectoryToFile(const std::string& file_name);
 
+  /**
+   * \brief Read a joint trajectory saved by saveJointTrajectoryToBinaryFile()
+   *        The file is memory mapped and copied straight into robot states. Variables of the current state that are
+   *        not in the file keep their values, file variables the robot does not have are ignored. A RobotTrajectory
+   *        still needs one RobotState per waypoint, including its link transforms. They come from a pool that reuses
+   *        the states of the previously loaded trajectory once it is released, up to RobotStatePool's size limit.
+   *        Use BinaryTrajectoryFile directly to read the columns in place without any states
+   * \param file_name - location of file
+   * \param arm_jmg - the kinematic chain of joints that should be controlled (a planning group)
+   * \return true on success
+   */
+  bool loadJointTrajectoryFromBinaryFile(const std::string& file_name, JointModelGroup* arm_jmg);
+
+  /**
+   * \brief Record the positions, velocities, accelerations and timing of every waypoint in the binary format
+   * \param file_name - location of file
+   * \return true on success
+   */
+  bool saveJointTrajectoryToBinaryFile(const std::string& file_name);
+
+  /**
+   * \brief Read a joint trajectory saved by saveJointTrajectoryToCompressedFile() or trajectory_compress
+   *        Variables are matched by name like in loadJointTrajectoryFromBinaryFile(), files without names must hold
+   *        every robot variable in order like CSV files
+   * \param file_name - location of file
+   * \param arm_jmg - the kinematic chain of joints that should be controlled (a planning group)
+   * \return true on success
+   */
+  bool loadJointTrajectoryFromCompressedFile(const std::string& file_name, JointModelGroup* arm_jmg);
+
+  /**
+   * \brief Record the joint trajectory quantized to the error bounds of options and compressed
+   * \param file_name - location of file
+   * \return true on success
+   */
+  bool saveJointTrajectoryToCompressedFile(const std::string& file_name,
+                                           const CompressionOptions& options = CompressionOptions());
+
   robot_trajectory::RobotTrajectoryPtr getJointTrajectory()
   {
     return joint_trajectory_;
@@ -149,8 +194,26 @@ public:
    */
   bool getFilePath(std::string& file_path, const std::string& file_name);
 
+  /**
+   * \brief Get the directory getFilePath() saves to, creating it if needed
+   * \param directory - the variable to populate with a path
+   * \return true on success
+   */
+  bool getTrajectoryDirectory(std::string& directory);
+
 private:
-  /** \brief Use the planning scene to get the robot's current state */
+  /**
+   * \brief Find the robot variable of each named file column
+   * \param file_columns - columns of the file that the robot has
+   * \param state_indices - the robot variable of each of file_columns
+   */
+  void matchVariableNames(const std::vector<std::string>& file_variables, std::vector<std::size_t>& file_columns,
+                          std::vector<std::size_t>& state_indices);
+
+  /**
+   * \brief Use the planning scene to get the robot's current state
+   *        Note: the returned state is refreshed in place on the next call, copy it before modifying or keeping it
+   */
   moveit::core::RobotStatePtr getCurrentState();
 
   // Short class name
@@ -166,8 +229,19 @@ private:
   mvt::MoveItVisualToolsPtr visual_tools_;
   std::string package_path_;
 
-  // Allocated memory for robot state
+  // Current state of the robot
+  CurrentStateSnapshotPtr state_snapshot_;
+
+  // Refreshed in place by getCurrentState(), only copying what changed
   moveit::core::RobotStatePtr current_state_;
+  std::size_t current_state_version_ = 0;
+  std::size_t current_scene_version_ = 0;
+
+  // Parses CSV files, reused so that its buffers are only allocated once
+  CSVReader csv_reader_;
+
+  // Waypoints of loaded binary trajectories, reused once the previous trajectory is released
+  RobotStatePoolPtr state_pool_;
 
   // JOINT TRAJECTORY ------------------------------------------------------------------
 
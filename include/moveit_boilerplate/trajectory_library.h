@@ -0,0 +1,195 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Loads a directory of trajectory files in parallel into a named index with a memory budget
+*/
+
+#ifndef MOVEIT_BOILERPLATE_TRAJECTORY_LIBRARY_H
+#define MOVEIT_BOILERPLATE_TRAJECTORY_LIBRARY_H
+
+// C++
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Boost
+#include <boost/thread/mutex.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+#include <moveit_boilerplate/current_state_snapshot.h>
+#include <moveit_boilerplate/thread_pool.h>
+#include <moveit_boilerplate/trajectory_io.h>
+
+// MoveIt
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(TrajectoryLibrary);
+
+/** \brief How long one file took to load and how much space it takes */
+struct TrajectoryLoadStats
+{
+  std::string file_;
+  std::string group_;
+  std::string name_;
+  bool success_ = false;
+  double seconds_ = 0;
+  std::size_t waypoints_ = 0;
+  std::size_t file_bytes_ = 0;
+  std::size_t memory_bytes_ = 0;  // estimate of the loaded trajectory, see TrajectoryLibrary::estimateMemoryUsage()
+};
+
+/**
+ * \brief Named collection of joint trajectories loaded from files with TrajectoryIO
+ *
+ * Trajectories are indexed by planning group and name, the file name without its extension. loadDirectory() loads
+ * every file of a directory on a thread pool. When the loaded trajectories take more memory than the budget, the
+ * least recently used ones are evicted but stay in the index, and getTrajectory() loads them again from their file.
+ * Evicted trajectories that are still held by a caller remain valid. Thread safe.
+ */
+class TrajectoryLibrary
+{
+public:
+  /**
+   * \brief Constructor
+   * \param state_snapshot - shared source of the current state, e.g. Boilerplate::getCurrentStateSnapshot()
+   * \param memory_budget - bytes of loaded trajectories kept, see estimateMemoryUsage()
+   * \param num_threads - threads loading files, 0 uses one per hardware thread
+   */
+  TrajectoryLibrary(psm::PlanningSceneMonitorPtr planning_scene_monitor, CurrentStateSnapshotPtr state_snapshot,
+                    std::size_t memory_budget = 512 * 1024 * 1024, std::size_t num_threads = 0);
+
+  /**
+   * \brief Index and load every .csv, .bin and .ctraj trajectory file of a directory
+   *        Files in the directory belong to default_jmg. Files in a subdirectory named after a planning group belong
+   *        to that group, other subdirectories are ignored. Files already in the index are loaded again
+   * \param directory - e.g. TrajectoryIO::getTrajectoryDirectory()
+   * \return true if every file was loaded
+   */
+  bool loadDirectory(const std::string &directory, JointModelGroup *default_jmg);
+
+  /**
+   * \brief Get a trajectory, loading it again if it was evicted
+   * \return NULL if the trajectory is not in the index or its file can no longer be loaded
+   */
+  robot_trajectory::RobotTrajectoryPtr getTrajectory(const std::string &group, const std::string &name);
+
+  /** \brief True if the trajectory is in the index, whether loaded or evicted */
+  bool hasTrajectory(const std::string &group, const std::string &name) const;
+
+  /** \brief Names of the indexed trajectories of a group */
+  std::vector<std::string> getTrajectoryNames(const std::string &group) const;
+
+  /** \brief Remove every trajectory from the index */
+  void clear();
+
+  /** \brief Estimated bytes of the trajectories currently loaded */
+  std::size_t getMemoryUsage() const;
+
+  /** \brief Change the memory budget, evicting trajectories if it is now exceeded */
+  void setMemoryBudget(std::size_t memory_budget);
+
+  /** \brief One entry per file of the last loadDirectory(), in the order of the files */
+  std::vector<TrajectoryLoadStats> getLoadReport() const;
+
+  /** \brief Log the load time and size of each file of the last loadDirectory() and the totals */
+  void printLoadReport() const;
+
+  /** \brief Approximate heap and object size of a trajectory's waypoints, including each state's transforms */
+  static std::size_t estimateMemoryUsage(const robot_trajectory::RobotTrajectory &trajectory);
+
+private:
+  // Planning group and trajectory name
+  typedef std::pair<std::string, std::string> Key;
+
+  struct Entry
+  {
+    std::string file_;
+    JointModelGroup *jmg_ = NULL;
+    robot_trajectory::RobotTrajectoryPtr trajectory_;  // NULL while evicted
+    std::size_t bytes_ = 0;
+    std::list<Key>::iterator recent_;  // position in recent_keys_ while loaded
+  };
+
+  /**
+   * \brief Load one file with a TrajectoryIO that is not used by another thread
+   * \return NULL on failure
+   */
+  robot_trajectory::RobotTrajectoryPtr loadFile(const std::string &file, JointModelGroup *jmg,
+                                                TrajectoryLoadStats &stats);
+
+  /** \brief Take an idle TrajectoryIO, creating one if all are in use */
+  TrajectoryIOPtr acquireTrajectoryIO();
+
+  /** \brief Return a TrajectoryIO taken with acquireTrajectoryIO() */
+  void releaseTrajectoryIO(const TrajectoryIOPtr &trajectory_io);
+
+  /** \brief Mark a loaded trajectory as most recently used and evict to stay within budget. Requires mutex_ */
+  void storeLoaded(const Key &key, Entry &entry, const robot_trajectory::RobotTrajectoryPtr &trajectory,
+                   std::size_t bytes);
+
+  /** \brief Drop least recently used trajectories until within budget, always keeping the newest. Requires mutex_ */
+  void evict();
+
+  // Short name of this class
+  std::string name_ = "trajectory_library";
+
+  // Core MoveIt components
+  psm::PlanningSceneMonitorPtr planning_scene_monitor_;
+  CurrentStateSnapshotPtr state_snapshot_;
+
+  // Loads files in parallel
+  ThreadPool thread_pool_;
+
+  // TrajectoryIO instances not in use by a thread, each parses with its own buffers
+  std::vector<TrajectoryIOPtr> idle_trajectory_io_;
+  boost::mutex trajectory_io_mutex_;
+
+  // Protects everything below
+  mutable boost::mutex mutex_;
+  std::map<Key, Entry> index_;
+  std::list<Key> recent_keys_;  // most recently used first
+  std::size_t memory_budget_;
+  std::size_t memory_usage_ = 0;
+  std::vector<TrajectoryLoadStats> load_report_;
+  double load_seconds_ = 0;  // wall time of the last loadDirectory()
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_TRAJECTORY_LIBRARY_H
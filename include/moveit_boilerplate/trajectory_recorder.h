@@ -0,0 +1,158 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Writes executed trajectories to a binary log from a background thread
+*/
+
+#ifndef MOVEIT_BOILERPLATE_TRAJECTORY_RECORDER_H
+#define MOVEIT_BOILERPLATE_TRAJECTORY_RECORDER_H
+
+// C++
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+// MoveIt
+#include <moveit/macros/class_forward.h>
+
+// ROS
+#include <moveit_msgs/RobotTrajectory.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(TrajectoryRecorder);
+
+typedef boost::shared_ptr<const moveit_msgs::RobotTrajectory> RobotTrajectoryMsgConstPtr;
+
+/**
+ * \brief Records trajectory messages without blocking the caller
+ *
+ * record() only queues a reference to the message, serialization and disk access happen on the recorder's thread.
+ * If the queue is full the message is dropped and counted rather than making the caller wait.
+ *
+ * Each log file starts with a magic string and format version, followed by records of
+ *   uint32 label length, label, uint32 message length, ROS-serialized moveit_msgs/RobotTrajectory
+ * Once a file exceeds max_file_size a new one is started, and only the newest max_files are kept.
+ */
+class TrajectoryRecorder
+{
+public:
+  /**
+   * \brief Constructor
+   * \param directory - where log files are written
+   * \param max_queue_size - messages waiting to be written before new ones are dropped
+   * \param max_file_size - bytes after which a new log file is started
+   * \param max_files - older log files from this run are deleted, 0 keeps all
+   */
+  TrajectoryRecorder(const std::string &directory, std::size_t max_queue_size, std::size_t max_file_size,
+                     std::size_t max_files);
+
+  /** \brief Writes out everything still queued */
+  ~TrajectoryRecorder();
+
+  /**
+   * \brief Queue a message for writing, the message must not be modified afterwards
+   * \param label - name stored with the message, used as the file name when converting to CSV
+   * \return false if the queue was full and the message was dropped
+   */
+  bool record(const RobotTrajectoryMsgConstPtr &trajectory_msg, const std::string &label);
+
+  /** \brief Number of messages dropped because the queue was full */
+  std::size_t getDroppedCount();
+
+  /** \brief Number of messages written to disk */
+  std::size_t getRecordedCount();
+
+  typedef boost::function<void(const std::string &label, const moveit_msgs::RobotTrajectory &trajectory_msg)>
+      ReadCallback;
+
+  /**
+   * \brief Read every record of a log file
+   * \param callback - called once per record, in the order they were written
+   * \return false if the file could not be opened or is corrupt. Records before the corruption are still read
+   */
+  static bool readLog(const std::string &file_path, const ReadCallback &callback);
+
+private:
+  struct Entry
+  {
+    RobotTrajectoryMsgConstPtr trajectory_msg_;
+    std::string label_;
+  };
+
+  /** \brief Background thread that writes queued messages */
+  void recorderThread();
+
+  /** \brief Serialize and append one message to the current log file */
+  void write(const Entry &entry);
+
+  /** \brief Start a new log file, deleting the oldest if there are too many */
+  bool openNextFile();
+
+  // Short name of this class
+  std::string name_ = "trajectory_recorder";
+
+  // Settings
+  std::string directory_;
+  std::size_t max_queue_size_;
+  std::size_t max_file_size_;
+  std::size_t max_files_;
+
+  // Messages waiting to be written
+  boost::mutex queue_mutex_;
+  boost::condition_variable queue_condition_;
+  std::deque<Entry> queue_;
+  bool shutdown_ = false;
+  std::size_t dropped_count_ = 0;
+  std::size_t recorded_count_ = 0;
+
+  // Only used by the recorder thread
+  std::ofstream file_;
+  std::size_t file_size_ = 0;
+  std::size_t file_count_ = 0;
+  std::string file_prefix_;
+  std::deque<std::string> file_paths_;
+  std::vector<uint8_t> buffer_;
+
+  boost::thread recorder_thread_;
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_TRAJECTORY_RECORDER_H
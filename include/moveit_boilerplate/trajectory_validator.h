@@ -0,0 +1,170 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Whole-trajectory sanity checks run before a trajectory is sent to the controllers
+*/
+
+#ifndef MOVEIT_BOILERPLATE_TRAJECTORY_VALIDATOR_H
+#define MOVEIT_BOILERPLATE_TRAJECTORY_VALIDATOR_H
+
+// C++
+#include <string>
+#include <vector>
+
+// MoveIt
+#include <moveit/robot_model/robot_model.h>
+
+// ROS
+#include <trajectory_msgs/JointTrajectory.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(TrajectoryValidator);
+
+/** \brief One failed check, for the worst point of a joint */
+struct TrajectoryViolation
+{
+  enum Type
+  {
+    POSITION_JUMP,       // change in position between consecutive points
+    VELOCITY_LIMIT,      // commanded, or if missing implied, joint velocity
+    ACCELERATION_LIMIT,  // commanded joint acceleration
+    TIME_NOT_INCREASING, // time_from_start does not increase
+    TIME_STEP,           // time between consecutive points, likely because of wrap around/IK bug
+    MALFORMED_POINT      // number of positions does not match the joint names
+  };
+
+  Type type_;
+  bool error_;        // false for warnings
+  std::size_t point_; // index of the later point for differences
+  std::size_t joint_; // index into joint_names, unused for time checks
+  double value_;
+  double limit_;
+};
+
+/** \brief Result of TrajectoryValidator::validate() */
+struct TrajectoryValidationReport
+{
+  /** \brief True if there are no errors, warnings are allowed */
+  bool valid() const
+  {
+    return num_errors_ == 0;
+  }
+
+  std::vector<TrajectoryViolation> violations_;
+  std::size_t num_errors_ = 0;
+
+  // Largest value seen over the whole trajectory, relative to the limit for velocity and acceleration
+  double max_position_jump_ = 0;
+  double max_velocity_ratio_ = 0;
+  double max_acceleration_ratio_ = 0;
+  double max_time_step_ = 0;
+};
+
+/**
+ * \brief Checks joint jumps, velocity and acceleration limits and timing of a whole trajectory
+ *
+ * The trajectory is first transposed into one contiguous array per joint, then every check is a reduction over
+ * such an array. Only when a reduction exceeds its limit is the array scanned again to find the offending point,
+ * so a valid trajectory costs a few linear, branch-free passes.
+ */
+class TrajectoryValidator
+{
+public:
+  /**
+   * \brief Constructor
+   * \param robot_model - source of velocity and acceleration limits
+   * \param max_position_jump - largest allowed change of any joint between consecutive points, radians or meters
+   */
+  TrajectoryValidator(moveit::core::RobotModelConstPtr robot_model, double max_position_jump);
+
+  /**
+   * \brief Run all checks on a trajectory
+   * \param report - output, cleared first
+   * \return true if there are no errors
+   */
+  bool validate(const trajectory_msgs::JointTrajectory &trajectory, TrajectoryValidationReport &report);
+
+  /** \brief Human readable name of a check */
+  static const char *typeToString(TrajectoryViolation::Type type);
+
+  /** \brief Allowed time between consecutive points before a warning or an error is reported */
+  void setTimeStepLimits(double warn_time_step, double max_time_step)
+  {
+    warn_time_step_ = warn_time_step;
+    max_time_step_ = max_time_step;
+  }
+
+private:
+  /** \brief Look up limits when the joints differ from the previous trajectory */
+  void loadLimits(const std::vector<std::string> &joint_names);
+
+  /**
+   * \brief Copy the message into per-joint arrays, deriving velocities from positions if they are missing
+   * \return false if a point does not have a position for every joint
+   */
+  bool transpose(const trajectory_msgs::JointTrajectory &trajectory, TrajectoryValidationReport &report);
+
+  /** \brief Add one entry to the report */
+  static void addViolation(TrajectoryViolation::Type type, bool error, std::size_t point, std::size_t joint,
+                           double value, double limit, TrajectoryValidationReport &report);
+
+  // Short name of this class
+  std::string name_ = "trajectory_validator";
+
+  moveit::core::RobotModelConstPtr robot_model_;
+
+  // Limits
+  double max_position_jump_;
+  double warn_time_step_ = 3.0;
+  double max_time_step_ = 4.0;
+  double limit_margin_ = 1.001;  // allow for rounding in time parameterization
+
+  // Per joint limits, infinite when unbounded
+  std::vector<std::string> joint_names_;
+  std::vector<double> max_velocities_;
+  std::vector<double> max_accelerations_;
+
+  // Structure of arrays copy of the last trajectory, joint j of point i is at [j * num_points_ + i]
+  std::size_t num_points_ = 0;
+  std::vector<double> times_;
+  std::vector<double> inv_time_steps_;  // 1 / (t[i] - t[i-1]), 0 for non-increasing time
+  std::vector<double> positions_;
+  std::vector<double> velocities_;
+  std::vector<double> accelerations_;  // zero when the message has none
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_TRAJECTORY_VALIDATOR_H
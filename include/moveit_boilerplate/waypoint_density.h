@@ -0,0 +1,141 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Number of interpolated waypoints needed between two states, from joint lever arms and velocity limits
+*/
+
+#ifndef MOVEIT_BOILERPLATE_WAYPOINT_DENSITY_H
+#define MOVEIT_BOILERPLATE_WAYPOINT_DENSITY_H
+
+// C++
+#include <map>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/thread/mutex.hpp>
+
+// this package
+#include <moveit_boilerplate/namespaces.h>
+
+// MoveIt
+#include <moveit/robot_state/robot_state.h>
+
+namespace moveit_boilerplate
+{
+MOVEIT_CLASS_FORWARD(WaypointDensity);
+
+/**
+ * \brief Chooses how finely a joint space segment is interpolated
+ *
+ * Every active joint of a group gets a lever arm, an upper bound of how far any point of the links it moves can be
+ * from its axis, taken from the link lengths and geometry bounding boxes of the robot model, and from any bodies
+ * attached below the joint in the first of the two states. A joint moving by d then moves
+ * no point of the robot by more than lever_arm * d, so the sum over all joints bounds the Cartesian deviation of a
+ * linearly interpolated segment. A segment is split until that bound is below max_cartesian_deviation and, when
+ * max_segment_duration is set, until no joint needs longer than that at its velocity limit. Large slow joints near
+ * the base are sampled finely and wrist joints coarsely, instead of weighting every radian the same.
+ *
+ * Lever arms of the robot model are computed once per group. Thread safe.
+ */
+class WaypointDensity
+{
+public:
+  /**
+   * \brief Constructor
+   * \param max_cartesian_deviation - largest distance any point of the robot may move between waypoints, in meters
+   * \param max_segment_duration - longest time between waypoints at full speed in seconds, 0 to ignore velocity
+   */
+  WaypointDensity(double max_cartesian_deviation = 0.05, double max_segment_duration = 0.0);
+
+  /**
+   * \brief Number of segments to split the motion between two states into
+   * \return at least 1
+   */
+  std::size_t segmentCount(const moveit::core::RobotState &state1, const moveit::core::RobotState &state2,
+                           JointModelGroup *jmg);
+
+  /**
+   * \brief Upper bound of how far any point of the robot moves between two states, in meters
+   *        Only the active joints of jmg are considered
+   */
+  double cartesianDeviation(const moveit::core::RobotState &state1, const moveit::core::RobotState &state2,
+                            JointModelGroup *jmg);
+
+  /** \brief Lever arm of each active joint of a group, in the order of getActiveJointModels() */
+  const std::vector<double> &getLeverArms(JointModelGroup *jmg);
+
+private:
+  /** \brief Per group data, computed on first use */
+  struct GroupWeights
+  {
+    std::vector<const moveit::core::JointModel *> joints_;
+    std::vector<double> lever_arms_;          // meters per radian, 1 for prismatic joints
+    std::vector<double> inverse_velocities_;  // seconds per radian or meter, 0 if not velocity bounded
+  };
+
+  const GroupWeights &getWeights(JointModelGroup *jmg);
+
+  /** \brief Lever arm of joint i of a group, including bodies attached below it */
+  static double leverArm(const GroupWeights &weights, std::size_t i,
+                         const std::vector<const moveit::core::AttachedBody *> &attached_bodies);
+
+  /** \brief Lever arm of a joint from the reach of what it moves */
+  static double leverArm(const moveit::core::JointModel *joint, double reach);
+
+  /** \brief Distance from a link's origin to the farthest point of it and all links below it */
+  static double reach(const moveit::core::LinkModel *link);
+
+  /** \brief Largest distance a joint can put its child link's origin from its parent link's origin */
+  static double jointOffset(const moveit::core::JointModel *joint);
+
+  /** \brief Upper bound of the distance from one link's origin to a link below it, -1 if it is not below */
+  static double offsetTo(const moveit::core::LinkModel *from, const moveit::core::LinkModel *to);
+
+  /** \brief Distance from the attached link's origin to the farthest point of a body */
+  static double radius(const moveit::core::AttachedBody &attached_body);
+
+  // Short name of this class
+  std::string name_ = "waypoint_density";
+
+  double max_cartesian_deviation_;
+  double max_segment_duration_;
+
+  boost::mutex mutex_;
+  std::map<JointModelGroup *, GroupWeights> groups_;  // entries are never removed, so references stay valid
+};  // end class
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_WAYPOINT_DENSITY_H
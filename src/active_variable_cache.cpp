@@ -0,0 +1,107 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Per planning group index of the variables that can actually move, for fast state comparisons
+*/
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+// this package
+#include <moveit_boilerplate/active_variable_cache.h>
+
+// ROS
+#include <ros/ros.h>
+
+// Eigen
+#include <Eigen/Core>
+
+namespace moveit_boilerplate
+{
+const double ActiveVariableCache::DEFAULT_THRESHOLD = 0.001;
+
+const ActiveVariables &ActiveVariableCache::getActiveVariables(JointModelGroup *jmg)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  std::map<JointModelGroup *, ActiveVariables>::iterator it = groups_.find(jmg);
+  if (it != groups_.end())
+    return it->second;
+
+  ActiveVariables &active = groups_[jmg];
+  const std::vector<const moveit::core::JointModel *> &joints = jmg->getActiveJointModels();
+  for (std::size_t i = 0; i < joints.size(); ++i)
+    for (std::size_t j = 0; j < joints[i]->getVariableCount(); ++j)
+      active.indices_.push_back(joints[i]->getFirstVariableIndex() + j);
+
+  if (!active.indices_.empty())
+  {
+    active.first_ = active.indices_.front();
+    for (std::size_t i = 1; i < active.indices_.size(); ++i)
+      if (active.indices_[i] != active.first_ + static_cast<int>(i))
+        active.contiguous_ = false;
+  }
+
+  ROS_DEBUG_STREAM_NAMED(name_, "Group '" << jmg->getName() << "' has " << active.indices_.size()
+                                          << " active variables, "
+                                          << (active.contiguous_ ? "contiguous" : "scattered"));
+  return active;
+}
+
+double ActiveVariableCache::maxDifference(const moveit::core::RobotState &s1, const moveit::core::RobotState &s2,
+                                          JointModelGroup *jmg)
+{
+  const ActiveVariables &active = getActiveVariables(jmg);
+  const double *p1 = s1.getVariablePositions();
+  const double *p2 = s2.getVariablePositions();
+
+  if (active.contiguous_)
+    return maxAbsDifference(p1 + active.first_, p2 + active.first_, active.indices_.size());
+
+  double max_diff = 0;
+  for (std::size_t i = 0; i < active.indices_.size(); ++i)
+    max_diff = std::max(max_diff, std::fabs(p1[active.indices_[i]] - p2[active.indices_[i]]));
+  return max_diff;
+}
+
+double ActiveVariableCache::maxAbsDifference(const double *a, const double *b, std::size_t size)
+{
+  if (size == 0)
+    return 0;
+
+  return (Eigen::Map<const Eigen::ArrayXd>(a, size) - Eigen::Map<const Eigen::ArrayXd>(b, size)).abs().maxCoeff();
+}
+
+}  // namespace moveit_boilerplate
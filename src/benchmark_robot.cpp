@@ -0,0 +1,154 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Synthetic robot and fake trajectory controller for benchmarking without hardware
+*/
+
+// C++
+#include <sstream>
+
+// this package
+#include <moveit_boilerplate/benchmark_robot.h>
+
+namespace moveit_boilerplate
+{
+std::string makeBenchmarkURDF(std::size_t dof)
+{
+  std::stringstream urdf;
+  urdf << "<?xml version=\"1.0\"?>\n<robot name=\"benchmark_robot\">\n";
+  urdf << "  <link name=\"base_link\"/>\n";
+  for (std::size_t i = 0; i < dof; ++i)
+  {
+    urdf << "  <link name=\"link_" << i << "\">\n"
+         << "    <collision><origin xyz=\"0 0 0.05\"/><geometry><cylinder radius=\"0.02\" length=\"0.1\"/>"
+         << "</geometry></collision>\n"
+         << "  </link>\n";
+    urdf << "  <joint name=\"joint_" << i << "\" type=\"revolute\">\n"
+         << "    <parent link=\"" << (i == 0 ? std::string("base_link") : "link_" + std::to_string(i - 1))
+         << "\"/>\n"
+         << "    <child link=\"link_" << i << "\"/>\n"
+         << "    <origin xyz=\"0 0 " << (i == 0 ? 0.0 : 0.1) << "\"/>\n"
+         << "    <axis xyz=\"0 " << (i % 2) << " " << (1 - i % 2) << "\"/>\n"
+         << "    <limit lower=\"-3.14\" upper=\"3.14\" effort=\"100\" velocity=\"2.0\"/>\n"
+         << "  </joint>\n";
+  }
+  urdf << "</robot>\n";
+  return urdf.str();
+}
+
+std::string makeBenchmarkSRDF(std::size_t dof)
+{
+  std::stringstream srdf;
+  srdf << "<?xml version=\"1.0\"?>\n<robot name=\"benchmark_robot\">\n"
+       << "  <group name=\"arm\"><chain base_link=\"base_link\" tip_link=\"link_" << dof - 1 << "\"/></group>\n"
+       << "  <virtual_joint name=\"world_joint\" type=\"fixed\" parent_frame=\"world\" child_link=\"base_link\"/>\n";
+
+  // Consecutive links touch at the joints
+  for (std::size_t i = 0; i + 1 < dof; ++i)
+    srdf << "  <disable_collisions link1=\"link_" << i << "\" link2=\"link_" << i + 1 << "\" reason=\"Adjacent\"/>\n";
+  srdf << "</robot>\n";
+  return srdf.str();
+}
+
+void setBenchmarkRobotParams(const std::string &robot_description, std::size_t dof)
+{
+  ros::param::set(robot_description, makeBenchmarkURDF(dof));
+  ros::param::set(robot_description + "_semantic", makeBenchmarkSRDF(dof));
+}
+
+FakeTrajectoryController::FakeTrajectoryController(ros::NodeHandle nh, const std::vector<std::string> &joint_names,
+                                                   double joint_state_rate)
+  : nh_(nh), command_count_(0)
+{
+  joint_state_.name = joint_names;
+  joint_state_.position.assign(joint_names.size(), 0.0);
+  joint_state_.velocity.assign(joint_names.size(), 0.0);
+
+  joint_state_pub_ = nh_.advertise<sensor_msgs::JointState>("joint_states", 1);
+  command_sub_ = nh_.subscribe("command", 10, &FakeTrajectoryController::commandCallback, this);
+  action_server_.reset(new actionlib::SimpleActionServer<control_msgs::FollowJointTrajectoryAction>(
+      nh_, "follow_joint_trajectory", boost::bind(&FakeTrajectoryController::goalCallback, this, _1), false));
+  action_server_->start();
+  joint_state_timer_ =
+      nh_.createTimer(ros::Duration(1.0 / joint_state_rate), &FakeTrajectoryController::publishJointStates, this);
+}
+
+std::chrono::steady_clock::time_point FakeTrajectoryController::getLastCommandTime() const
+{
+  boost::mutex::scoped_lock lock(state_mutex_);
+  return last_command_time_;
+}
+
+void FakeTrajectoryController::commandCallback(const trajectory_msgs::JointTrajectoryConstPtr &trajectory)
+{
+  receive(*trajectory);
+}
+
+void FakeTrajectoryController::goalCallback(const control_msgs::FollowJointTrajectoryGoalConstPtr &goal)
+{
+  receive(goal->trajectory);
+  action_server_->setSucceeded();
+}
+
+void FakeTrajectoryController::receive(const trajectory_msgs::JointTrajectory &trajectory)
+{
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  {
+    boost::mutex::scoped_lock lock(state_mutex_);
+    last_command_time_ = now;
+
+    // Jump to the end, an empty trajectory is a stop command
+    if (!trajectory.points.empty())
+    {
+      const std::vector<double> &positions = trajectory.points.back().positions;
+      for (std::size_t i = 0; i < trajectory.joint_names.size(); ++i)
+        for (std::size_t j = 0; j < joint_state_.name.size(); ++j)
+          if (joint_state_.name[j] == trajectory.joint_names[i])
+            joint_state_.position[j] = positions[i];
+    }
+  }
+  command_count_++;
+
+  // Let the state monitor see the new position right away
+  publishJointStates(ros::TimerEvent());
+}
+
+void FakeTrajectoryController::publishJointStates(const ros::TimerEvent &event)
+{
+  boost::mutex::scoped_lock lock(state_mutex_);
+  joint_state_.header.stamp = ros::Time::now();
+  joint_state_pub_.publish(joint_state_);
+}
+
+}  // namespace moveit_boilerplate
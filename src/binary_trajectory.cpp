@@ -0,0 +1,293 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Versioned binary file of a joint trajectory that is read in place through mmap
+*/
+
+// C++
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// this package
+#include <moveit_boilerplate/binary_trajectory.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+const std::size_t ALIGNMENT = 8;
+
+std::size_t padded(std::size_t size)
+{
+  return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+}  // namespace
+
+static_assert(sizeof(BinaryTrajectoryHeader) == 64, "BinaryTrajectoryHeader layout changed");
+
+const std::uint32_t BinaryTrajectoryHeader::BYTE_ORDER_MARK;
+const std::uint32_t BinaryTrajectoryHeader::HAS_VELOCITIES;
+const std::uint32_t BinaryTrajectoryHeader::HAS_ACCELERATIONS;
+
+const char BinaryTrajectoryFile::MAGIC[8] = { 'M', 'B', 'T', 'R', 'A', 'J', '\0', '\0' };
+const std::uint32_t BinaryTrajectoryFile::VERSION;
+
+BinaryTrajectoryFile::BinaryTrajectoryFile()
+{
+}
+
+BinaryTrajectoryFile::~BinaryTrajectoryFile()
+{
+  close();
+}
+
+bool BinaryTrajectoryFile::open(const std::string &file_name)
+{
+  close();
+
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to open " << file_name << ": " << std::strerror(errno));
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(BinaryTrajectoryHeader)))
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is too small for a binary trajectory");
+    ::close(fd);
+    return false;
+  }
+
+  mapping_size_ = file_stat.st_size;
+  mapping_ = mmap(NULL, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);  // the mapping keeps the file
+  if (mapping_ == MAP_FAILED)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to map " << file_name << ": " << std::strerror(errno));
+    mapping_ = NULL;
+    return false;
+  }
+
+  // Check the header before pointing into the data
+  const char *data = static_cast<const char *>(mapping_);
+  const BinaryTrajectoryHeader *header = reinterpret_cast<const BinaryTrajectoryHeader *>(data);
+  if (std::memcmp(header->magic_, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is not a binary trajectory");
+    close();
+    return false;
+  }
+  if (header->version_ != VERSION)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " has version " << header->version_ << ", expected "
+                                          << VERSION);
+    close();
+    return false;
+  }
+  if (header->byte_order_ != BinaryTrajectoryHeader::BYTE_ORDER_MARK)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " was written with a different byte order");
+    close();
+    return false;
+  }
+
+  std::size_t num_arrays = header->num_variables_;
+  if (header->flags_ & BinaryTrajectoryHeader::HAS_VELOCITIES)
+    num_arrays += header->num_variables_;
+  if (header->flags_ & BinaryTrajectoryHeader::HAS_ACCELERATIONS)
+    num_arrays += header->num_variables_;
+
+  // Bound the counts by the file size before multiplying them, so a corrupt header cannot overflow the data size
+  const std::size_t max_values = mapping_size_ / sizeof(double);
+  if (header->names_size_ > mapping_size_ || header->num_waypoints_ > max_values / (num_arrays + 1))
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is truncated or corrupt");
+    close();
+    return false;
+  }
+  const std::size_t data_size = (num_arrays + 1) * header->num_waypoints_ * sizeof(double);
+  if (header->data_offset_ != sizeof(BinaryTrajectoryHeader) + header->names_size_ ||
+      header->data_offset_ % ALIGNMENT != 0 || header->data_offset_ + data_size != mapping_size_)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is truncated or corrupt");
+    close();
+    return false;
+  }
+
+  // Names are terminated by '\0', followed by padding
+  const char *name = data + sizeof(BinaryTrajectoryHeader);
+  const char *names_end = data + header->data_offset_;
+  variable_names_.clear();
+  variable_names_.reserve(header->num_variables_);
+  while (variable_names_.size() < header->num_variables_)
+  {
+    const char *name_end = static_cast<const char *>(std::memchr(name, '\0', names_end - name));
+    if (!name_end)
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " has corrupt variable names");
+      close();
+      return false;
+    }
+    variable_names_.push_back(std::string(name, name_end));
+    name = name_end + 1;
+  }
+
+  header_ = header;
+  const double *array = reinterpret_cast<const double *>(data + header->data_offset_);
+  const std::size_t array_size = header->num_variables_ * header->num_waypoints_;
+  positions_ = array;
+  array += array_size;
+  if (header->flags_ & BinaryTrajectoryHeader::HAS_VELOCITIES)
+  {
+    velocities_ = array;
+    array += array_size;
+  }
+  if (header->flags_ & BinaryTrajectoryHeader::HAS_ACCELERATIONS)
+  {
+    accelerations_ = array;
+    array += array_size;
+  }
+  times_ = array;
+
+  // Reading sequentially through the columns
+  madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+  return true;
+}
+
+void BinaryTrajectoryFile::close()
+{
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+  mapping_ = NULL;
+  mapping_size_ = 0;
+  header_ = NULL;
+  variable_names_.clear();
+  positions_ = NULL;
+  velocities_ = NULL;
+  accelerations_ = NULL;
+  times_ = NULL;
+}
+
+bool BinaryTrajectoryFile::write(const std::string &file_name, const robot_trajectory::RobotTrajectory &trajectory)
+{
+  const std::string name = "binary_trajectory";
+  const std::vector<std::string> &variable_names = trajectory.getRobotModel()->getVariableNames();
+  const std::size_t num_waypoints = trajectory.getWayPointCount();
+  const std::size_t num_variables = variable_names.size();
+
+  // Only store velocities and accelerations if every waypoint has them
+  bool has_velocities = num_waypoints > 0;
+  bool has_accelerations = num_waypoints > 0;
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    has_velocities &= trajectory.getWayPoint(i).hasVelocities();
+    has_accelerations &= trajectory.getWayPoint(i).hasAccelerations();
+  }
+
+  std::string names;
+  for (std::size_t i = 0; i < num_variables; ++i)
+  {
+    names += variable_names[i];
+    names.push_back('\0');
+  }
+  names.resize(padded(names.size()), '\0');
+
+  BinaryTrajectoryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic_, MAGIC, sizeof(MAGIC));
+  header.version_ = VERSION;
+  header.byte_order_ = BinaryTrajectoryHeader::BYTE_ORDER_MARK;
+  header.num_waypoints_ = num_waypoints;
+  header.num_variables_ = num_variables;
+  header.flags_ = (has_velocities ? BinaryTrajectoryHeader::HAS_VELOCITIES : 0) |
+                  (has_accelerations ? BinaryTrajectoryHeader::HAS_ACCELERATIONS : 0);
+  header.names_size_ = names.size();
+  header.data_offset_ = sizeof(header) + names.size();
+
+  std::ofstream output_file(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output_file)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Unable to open " << file_name << " for writing");
+    return false;
+  }
+  output_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  output_file.write(names.data(), names.size());
+
+  // Gather each column from the row-major robot states
+  std::vector<double> column(num_waypoints);
+  for (std::size_t array = 0; array < 3; ++array)
+  {
+    if ((array == 1 && !has_velocities) || (array == 2 && !has_accelerations))
+      continue;
+
+    for (std::size_t variable = 0; variable < num_variables; ++variable)
+    {
+      for (std::size_t i = 0; i < num_waypoints; ++i)
+      {
+        const moveit::core::RobotState &state = trajectory.getWayPoint(i);
+        const double *values = array == 0 ? state.getVariablePositions() :
+                                            (array == 1 ? state.getVariableVelocities() :
+                                                          state.getVariableAccelerations());
+        column[i] = values[variable];
+      }
+      output_file.write(reinterpret_cast<const char *>(column.data()), column.size() * sizeof(double));
+    }
+  }
+
+  double time = 0;
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    time += trajectory.getWayPointDurationFromPrevious(i);
+    column[i] = time;
+  }
+  output_file.write(reinterpret_cast<const char *>(column.data()), column.size() * sizeof(double));
+
+  if (!output_file)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Failed writing " << file_name);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace moveit_boilerplate
@@ -100,11 +100,8 @@ Boilerplate::Boilerplate() : name_("boilerplate"), nh_("~")
   // Service for sharing the planning scene
   get_planning_scene_service_.initialize(nh_, "/get_planning_scene", planning_scene_monitor_);
 
-  // Create initial robot state
-  {
-    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-    current_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
-  }  // end scoped pointer of locked planning scene
+  // One source of the current state for every component, so the monitor only copies it once per update
+  state_snapshot_.reset(new CurrentStateSnapshot(planning_scene_monitor_));
 
   // Load the Robot Viz Tools for publishing to Rviz
   loadVisualTools();
@@ -113,10 +110,11 @@ Boilerplate::Boilerplate() : name_("boilerplate"), nh_("~")
   remote_control_.reset(new rviz_visual_tools::RemoteControl(nh_));
 
   // Load execution interface
-  execution_interface_.reset(new ExecutionInterface(planning_scene_monitor_, visual_tools_));
+  execution_interface_.reset(new ExecutionInterface(planning_scene_monitor_, visual_tools_, state_snapshot_));
 
   // Load planning interface
-  planning_interface_.reset(new PlanningInterface(planning_scene_monitor_, visual_tools_, arm_jmg_, execution_interface_));
+  planning_interface_.reset(
+      new PlanningInterface(planning_scene_monitor_, visual_tools_, arm_jmg_, execution_interface_, state_snapshot_));
 
   ROS_INFO_STREAM_NAMED("boilerplate", "Boilerplate Ready.");
 }
@@ -193,6 +191,8 @@ bool Boilerplate::showJointLimits(JointModelGroup* jmg)
 
   std::cout << std::endl;
 
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+
   // Loop through joints
   for (std::size_t i = 0; i < joints.size(); ++i)
   {
@@ -202,11 +202,10 @@ bool Boilerplate::showJointLimits(JointModelGroup* jmg)
       ROS_ERROR_STREAM_NAMED("manipulation", "Unable to handle joints with more than one var");
       return false;
     }
-    getCurrentState();
-    double current_value = current_state_->getVariablePosition(joints[i]->getName());
+    double current_value = current_state->getVariablePosition(joints[i]->getName());
 
     // check if bad position
-    bool out_of_bounds = !current_state_->satisfiesBounds(joints[i]);
+    bool out_of_bounds = !current_state->satisfiesBounds(joints[i]);
 
     const moveit::core::VariableBounds& bound = joints[i]->getVariableBounds()[0];
 
@@ -243,13 +242,11 @@ bool Boilerplate::showJointLimits(JointModelGroup* jmg)
 
 moveit::core::RobotStatePtr Boilerplate::getCurrentState()
 {
-  // Get the real current state
-  psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-  (*current_state_) = scene->getCurrentState();
+  state_snapshot_->update(current_state_, current_state_version_, current_scene_version_);
   return current_state_;
 }
 
-const Eigen::Affine3d& Boilerplate::getCurrentPose()
+Eigen::Affine3d Boilerplate::getCurrentPose()
 {
   return getCurrentState()->getGlobalLinkTransform(arm_jmg_->getOnlyOneEndEffectorTip());
 }
@@ -0,0 +1,206 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Publishes cartesian end effector commands at a fixed rate from a background thread
+*/
+
+// C++
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+// this package
+#include <moveit_boilerplate/cartesian_streamer.h>
+
+namespace moveit_boilerplate
+{
+CartesianStreamer::CartesianStreamer(const ros::Publisher &publisher, const std::string &frame_id, double rate,
+                                     double interpolation_duration)
+  : publisher_(publisher)
+  , period_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate)))
+  , interpolation_duration_(interpolation_duration)
+  , timing_stats_({ "lateness", "period" })
+  , overrun_count_(0)
+  , shutdown_(false)
+{
+  pose_stamped_msg_.header.frame_id = frame_id;
+  target_.valid_ = false;
+
+  streaming_thread_ = boost::thread(&CartesianStreamer::streamingThread, this);
+  ROS_INFO_STREAM_NAMED(name_, "Streaming cartesian commands at " << rate << " hz");
+}
+
+CartesianStreamer::~CartesianStreamer()
+{
+  shutdown_.store(true);
+  streaming_thread_.join();
+}
+
+void CartesianStreamer::setTarget(const Eigen::Affine3d &pose)
+{
+  const Eigen::Quaterniond orientation = Eigen::Quaterniond(pose.rotation()).normalized();
+
+  boost::mutex::scoped_lock lock(target_write_mutex_);
+  target_seqlock_.writeBegin();
+  target_.position_[0] = pose.translation().x();
+  target_.position_[1] = pose.translation().y();
+  target_.position_[2] = pose.translation().z();
+  target_.orientation_[0] = orientation.x();
+  target_.orientation_[1] = orientation.y();
+  target_.orientation_[2] = orientation.z();
+  target_.orientation_[3] = orientation.w();
+  target_.valid_ = true;
+  target_seqlock_.writeEnd();
+}
+
+void CartesianStreamer::clearTarget()
+{
+  boost::mutex::scoped_lock lock(target_write_mutex_);
+  target_seqlock_.writeBegin();
+  target_.valid_ = false;
+  target_seqlock_.writeEnd();
+}
+
+std::size_t CartesianStreamer::readTarget(Target &target) const
+{
+  std::size_t sequence;
+  do
+  {
+    sequence = target_seqlock_.readBegin();
+    target = target_;
+  } while (target_seqlock_.readRetry(sequence));
+  return SeqLock::toVersion(sequence);
+}
+
+void CartesianStreamer::streamingThread()
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Target target;
+  std::size_t target_version = 0;
+  bool has_command = false;
+  Eigen::Vector3d start_position, goal_position, command_position;
+  Eigen::Quaterniond start_orientation, goal_orientation, command_orientation;
+  Clock::time_point interpolation_start;
+  Clock::time_point last_publish;
+  bool published = false;
+
+  Clock::time_point deadline = Clock::now();
+  while (!shutdown_.load(std::memory_order_relaxed))
+  {
+    // Absolute deadlines, so time spent publishing does not add up
+    deadline += period_;
+    std::this_thread::sleep_until(deadline);
+    const Clock::time_point now = Clock::now();
+
+    // Skip missed cycles rather than publishing a burst to catch up
+    const Clock::duration lateness = now - deadline;
+    if (lateness > period_)
+    {
+      overrun_count_++;
+      deadline = now;
+    }
+
+    const std::size_t version = readTarget(target);
+    if (!target.valid_)
+    {
+      has_command = false;
+      published = false;
+      continue;
+    }
+
+    // New target, start approaching it from the last command
+    if (version != target_version || !has_command)
+    {
+      target_version = version;
+      goal_position = Eigen::Vector3d(target.position_[0], target.position_[1], target.position_[2]);
+      goal_orientation = Eigen::Quaterniond(target.orientation_[3], target.orientation_[0], target.orientation_[1],
+                                            target.orientation_[2]);
+      start_position = has_command ? command_position : goal_position;
+      start_orientation = has_command ? command_orientation : goal_orientation;
+      interpolation_start = now;
+      has_command = true;
+    }
+
+    if (interpolation_duration_ > 0)
+    {
+      const double elapsed = std::chrono::duration<double>(now - interpolation_start).count();
+      const double alpha = std::min(1.0, elapsed / interpolation_duration_);
+      command_position = start_position + alpha * (goal_position - start_position);
+      command_orientation = start_orientation.slerp(alpha, goal_orientation);
+    }
+    else
+    {
+      command_position = goal_position;
+      command_orientation = goal_orientation;
+    }
+
+    pose_stamped_msg_.header.stamp = ros::Time::now();
+    pose_stamped_msg_.pose.position.x = command_position.x();
+    pose_stamped_msg_.pose.position.y = command_position.y();
+    pose_stamped_msg_.pose.position.z = command_position.z();
+    pose_stamped_msg_.pose.orientation.x = command_orientation.x();
+    pose_stamped_msg_.pose.orientation.y = command_orientation.y();
+    pose_stamped_msg_.pose.orientation.z = command_orientation.z();
+    pose_stamped_msg_.pose.orientation.w = command_orientation.w();
+    publisher_.publish(pose_stamped_msg_);
+
+    timing_stats_.getStage(TIMING_LATENESS).record(lateness);
+    if (published)
+      timing_stats_.getStage(TIMING_PERIOD).record(now - last_publish);
+    last_publish = now;
+    published = true;
+  }
+}
+
+void CartesianStreamer::getDiagnostics(diagnostic_msgs::DiagnosticStatus &status) const
+{
+  timing_stats_.getDiagnostics(status);
+
+  diagnostic_msgs::KeyValue overruns;
+  overruns.key = "overruns";
+  std::stringstream value;
+  value << overrun_count_.load();
+  overruns.value = value.str();
+  status.values.push_back(overruns);
+}
+
+std::string CartesianStreamer::toString() const
+{
+  std::stringstream table;
+  table << timing_stats_.toString() << "overruns: " << overrun_count_.load() << std::endl;
+  return table.str();
+}
+
+}  // namespace moveit_boilerplate
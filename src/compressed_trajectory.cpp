@@ -0,0 +1,466 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Compact file of a joint trajectory, quantized to an error bound, delta encoded and compressed in blocks
+*/
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// zlib
+#include <zlib.h>
+
+// this package
+#include <moveit_boilerplate/compressed_trajectory.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+const std::size_t ALIGNMENT = 8;
+
+// Larger quantized values could overflow the differences
+const double MAX_QUANTIZED = 4e18;
+
+std::size_t padded(std::size_t size)
+{
+  return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/** \brief Append a signed integer as a zigzag varint, small magnitudes of either sign take few bytes */
+void putVarint(std::int64_t value, std::vector<unsigned char> &buffer)
+{
+  std::uint64_t zigzag = (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+  while (zigzag >= 0x80)
+  {
+    buffer.push_back(static_cast<unsigned char>(zigzag | 0x80));
+    zigzag >>= 7;
+  }
+  buffer.push_back(static_cast<unsigned char>(zigzag));
+}
+
+/**
+ * \brief Read a zigzag varint
+ * \return false if the buffer ends in the middle of the value
+ */
+bool getVarint(const unsigned char *&data, const unsigned char *end, std::int64_t &value)
+{
+  std::uint64_t zigzag = 0;
+  for (unsigned int shift = 0; data < end && shift < 64; shift += 7)
+  {
+    const unsigned char byte = *data++;
+    zigzag |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+    {
+      value = static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Quantize the columns of a row-major array over [begin, end) waypoints and append their differences
+ * \return false if a value is not finite or too large for the step
+ */
+bool encodeColumns(const std::vector<double> &values, std::size_t num_columns, std::size_t begin, std::size_t end,
+                   double step, std::vector<unsigned char> &buffer)
+{
+  for (std::size_t column = 0; column < num_columns; ++column)
+  {
+    std::int64_t previous = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const double scaled = values[i * num_columns + column] / step;
+      if (!(std::abs(scaled) < MAX_QUANTIZED))
+        return false;
+      const std::int64_t quantized = std::llround(scaled);
+      putVarint(quantized - previous, buffer);
+      previous = quantized;
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Reverse encodeColumns() for count waypoints
+ * \return false if the data ends early
+ */
+bool decodeColumns(const unsigned char *&data, const unsigned char *end, std::size_t num_columns, std::size_t count,
+                   double step, std::vector<double> &values)
+{
+  values.resize(num_columns * count);
+  for (std::size_t column = 0; column < num_columns; ++column)
+  {
+    std::int64_t quantized = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      std::int64_t difference;
+      if (!getVarint(data, end, difference))
+        return false;
+      quantized += difference;
+      values[i * num_columns + column] = quantized * step;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+static_assert(sizeof(CompressedTrajectoryHeader) == 80, "CompressedTrajectoryHeader layout changed");
+static_assert(sizeof(CompressedTrajectoryBlock) == 16, "CompressedTrajectoryBlock layout changed");
+
+const std::uint32_t CompressedTrajectoryHeader::BYTE_ORDER_MARK;
+const std::uint32_t CompressedTrajectoryHeader::HAS_VELOCITIES;
+const std::uint32_t CompressedTrajectoryHeader::HAS_ACCELERATIONS;
+const std::uint32_t CompressedTrajectoryHeader::HAS_TIMES;
+
+const char CompressedTrajectoryFile::MAGIC[8] = { 'M', 'Z', 'T', 'R', 'A', 'J', '\0', '\0' };
+const std::uint32_t CompressedTrajectoryFile::VERSION;
+
+CompressedTrajectoryFile::CompressedTrajectoryFile()
+{
+  std::memset(&header_, 0, sizeof(header_));
+}
+
+bool CompressedTrajectoryFile::open(const std::string &file_name)
+{
+  close();
+  file_name_ = file_name;
+
+  input_file_.open(file_name.c_str(), std::ios::in | std::ios::binary);
+  if (!input_file_.is_open())
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to open " << file_name);
+    return false;
+  }
+  input_file_.seekg(0, std::ios::end);
+  const std::uint64_t file_size = input_file_.tellg();
+  input_file_.seekg(0, std::ios::beg);
+
+  // Check the header before reading anything it describes
+  if (!input_file_.read(reinterpret_cast<char *>(&header_), sizeof(header_)) ||
+      std::memcmp(header_.magic_, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is not a compressed trajectory");
+    close();
+    return false;
+  }
+  if (header_.version_ != VERSION)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " has version " << header_.version_ << ", expected "
+                                          << VERSION);
+    close();
+    return false;
+  }
+  if (header_.byte_order_ != CompressedTrajectoryHeader::BYTE_ORDER_MARK)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " was written with a different byte order");
+    close();
+    return false;
+  }
+  const std::uint64_t index_offset = sizeof(header_) + header_.names_size_;
+  const std::uint64_t data_offset = index_offset + header_.num_blocks_ * sizeof(CompressedTrajectoryBlock);
+  if (header_.block_size_ == 0 || header_.num_variables_ == 0 || header_.position_step_ <= 0 ||
+      header_.num_blocks_ != (header_.num_waypoints_ + header_.block_size_ - 1) / header_.block_size_ ||
+      data_offset > file_size)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is truncated or corrupt");
+    close();
+    return false;
+  }
+
+  // Names are terminated by '\0', followed by padding
+  std::vector<char> names(header_.names_size_);
+  input_file_.read(names.data(), names.size());
+  const char *name = names.data();
+  const char *names_end = names.data() + names.size();
+  while (names.size() > 0 && variable_names_.size() < header_.num_variables_)
+  {
+    const char *name_end = static_cast<const char *>(std::memchr(name, '\0', names_end - name));
+    if (!name_end)
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " has corrupt variable names");
+      close();
+      return false;
+    }
+    variable_names_.push_back(std::string(name, name_end));
+    name = name_end + 1;
+  }
+
+  // Every block must lie within the file and decode to at most ten bytes per value
+  const std::uint64_t max_raw_size = std::uint64_t(header_.block_size_) * (3 * header_.num_variables_ + 1) * 10;
+  blocks_.resize(header_.num_blocks_);
+  input_file_.read(reinterpret_cast<char *>(blocks_.data()), blocks_.size() * sizeof(CompressedTrajectoryBlock));
+  for (std::size_t i = 0; i < blocks_.size(); ++i)
+  {
+    if (!input_file_ || blocks_[i].offset_ < data_offset ||
+        blocks_[i].offset_ + blocks_[i].compressed_size_ > file_size || blocks_[i].raw_size_ > max_raw_size)
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "File " << file_name << " is truncated or corrupt");
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void CompressedTrajectoryFile::close()
+{
+  if (input_file_.is_open())
+    input_file_.close();
+  input_file_.clear();
+  std::memset(&header_, 0, sizeof(header_));
+  variable_names_.clear();
+  blocks_.clear();
+}
+
+bool CompressedTrajectoryFile::readBlock(std::size_t block, TrajectoryData &data)
+{
+  if (block >= getBlockCount())
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Block " << block << " requested, " << file_name_ << " has " << getBlockCount());
+    return false;
+  }
+
+  const CompressedTrajectoryBlock &location = blocks_[block];
+  compressed_.resize(location.compressed_size_);
+  raw_.resize(location.raw_size_);
+  input_file_.seekg(location.offset_);
+  input_file_.read(reinterpret_cast<char *>(compressed_.data()), compressed_.size());
+
+  uLongf raw_size = raw_.size();
+  if (!input_file_ ||
+      uncompress(raw_.data(), &raw_size, compressed_.data(), compressed_.size()) != Z_OK ||
+      raw_size != raw_.size())
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Block " << block << " of " << file_name_ << " is corrupt");
+    input_file_.clear();
+    return false;
+  }
+
+  const std::size_t begin = block * header_.block_size_;
+  const std::size_t count = std::min<std::size_t>(header_.block_size_, header_.num_waypoints_ - begin);
+  const std::size_t num_variables = header_.num_variables_;
+  const unsigned char *raw = raw_.data();
+  const unsigned char *raw_end = raw + raw_.size();
+
+  data.variable_names_ = variable_names_;
+  data.num_variables_ = num_variables;
+  data.velocities_.clear();
+  data.accelerations_.clear();
+  data.times_.clear();
+  bool success = decodeColumns(raw, raw_end, num_variables, count, header_.position_step_, data.positions_);
+  if (header_.flags_ & CompressedTrajectoryHeader::HAS_VELOCITIES)
+    success &= decodeColumns(raw, raw_end, num_variables, count, header_.velocity_step_, data.velocities_);
+  if (header_.flags_ & CompressedTrajectoryHeader::HAS_ACCELERATIONS)
+    success &= decodeColumns(raw, raw_end, num_variables, count, header_.acceleration_step_, data.accelerations_);
+  if (header_.flags_ & CompressedTrajectoryHeader::HAS_TIMES)
+    success &= decodeColumns(raw, raw_end, 1, count, header_.time_step_, data.times_);
+
+  if (!success || raw != raw_end)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Block " << block << " of " << file_name_ << " is corrupt");
+    return false;
+  }
+  return true;
+}
+
+bool CompressedTrajectoryFile::read(TrajectoryData &data)
+{
+  data = TrajectoryData();
+  data.variable_names_ = variable_names_;
+  data.num_variables_ = header_.num_variables_;
+
+  TrajectoryData block_data;
+  for (std::size_t block = 0; block < blocks_.size(); ++block)
+  {
+    if (!readBlock(block, block_data))
+      return false;
+    data.positions_.insert(data.positions_.end(), block_data.positions_.begin(), block_data.positions_.end());
+    data.velocities_.insert(data.velocities_.end(), block_data.velocities_.begin(), block_data.velocities_.end());
+    data.accelerations_.insert(data.accelerations_.end(), block_data.accelerations_.begin(),
+                               block_data.accelerations_.end());
+    data.times_.insert(data.times_.end(), block_data.times_.begin(), block_data.times_.end());
+  }
+  return true;
+}
+
+bool CompressedTrajectoryFile::write(const std::string &file_name, const TrajectoryData &data,
+                                     const CompressionOptions &options)
+{
+  const std::string name = "compressed_trajectory";
+  const std::size_t num_variables = data.num_variables_;
+  const std::size_t num_waypoints = data.getWaypointCount();
+
+  // Error check
+  if (num_variables == 0 || options.block_size_ == 0 || options.position_error_ <= 0 ||
+      options.velocity_error_ <= 0 || options.acceleration_error_ <= 0 || options.time_error_ <= 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Invalid trajectory or compression options for " << file_name);
+    return false;
+  }
+  if ((!data.variable_names_.empty() && data.variable_names_.size() != num_variables) ||
+      (!data.velocities_.empty() && data.velocities_.size() != data.positions_.size()) ||
+      (!data.accelerations_.empty() && data.accelerations_.size() != data.positions_.size()) ||
+      (!data.times_.empty() && data.times_.size() != num_waypoints))
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Arrays of the trajectory for " << file_name << " have different sizes");
+    return false;
+  }
+
+  std::string names;
+  for (std::size_t i = 0; i < data.variable_names_.size(); ++i)
+  {
+    names += data.variable_names_[i];
+    names.push_back('\0');
+  }
+  names.resize(padded(names.size()), '\0');
+
+  CompressedTrajectoryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic_, MAGIC, sizeof(MAGIC));
+  header.version_ = VERSION;
+  header.byte_order_ = CompressedTrajectoryHeader::BYTE_ORDER_MARK;
+  header.num_waypoints_ = num_waypoints;
+  header.num_variables_ = num_variables;
+  header.flags_ = (data.velocities_.empty() ? 0 : CompressedTrajectoryHeader::HAS_VELOCITIES) |
+                  (data.accelerations_.empty() ? 0 : CompressedTrajectoryHeader::HAS_ACCELERATIONS) |
+                  (data.times_.empty() ? 0 : CompressedTrajectoryHeader::HAS_TIMES);
+  header.block_size_ = options.block_size_;
+  header.num_blocks_ = (num_waypoints + options.block_size_ - 1) / options.block_size_;
+  header.names_size_ = names.size();
+  header.position_step_ = 2 * options.position_error_;
+  header.velocity_step_ = 2 * options.velocity_error_;
+  header.acceleration_step_ = 2 * options.acceleration_error_;
+  header.time_step_ = 2 * options.time_error_;
+
+  // Encode and compress every block before the index can be written
+  std::vector<CompressedTrajectoryBlock> blocks(header.num_blocks_);
+  std::vector<unsigned char> raw;
+  std::vector<unsigned char> compressed;
+  std::uint64_t offset = sizeof(header) + names.size() + blocks.size() * sizeof(CompressedTrajectoryBlock);
+  for (std::size_t block = 0; block < blocks.size(); ++block)
+  {
+    const std::size_t begin = block * options.block_size_;
+    const std::size_t end = std::min(num_waypoints, begin + options.block_size_);
+
+    raw.clear();
+    bool success = encodeColumns(data.positions_, num_variables, begin, end, header.position_step_, raw);
+    if (!data.velocities_.empty())
+      success &= encodeColumns(data.velocities_, num_variables, begin, end, header.velocity_step_, raw);
+    if (!data.accelerations_.empty())
+      success &= encodeColumns(data.accelerations_, num_variables, begin, end, header.acceleration_step_, raw);
+    if (!data.times_.empty())
+      success &= encodeColumns(data.times_, 1, begin, end, header.time_step_, raw);
+    if (!success)
+    {
+      ROS_ERROR_STREAM_NAMED(name, "Waypoints " << begin << " to " << end << " of " << file_name
+                                                << " have values that are not finite or too large to quantize");
+      return false;
+    }
+
+    const std::size_t compressed_start = compressed.size();
+    uLongf compressed_size = compressBound(raw.size());
+    compressed.resize(compressed_start + compressed_size);
+    if (compress2(&compressed[compressed_start], &compressed_size, raw.data(), raw.size(), options.level_) != Z_OK)
+    {
+      ROS_ERROR_STREAM_NAMED(name, "Failed to compress " << file_name);
+      return false;
+    }
+    compressed.resize(compressed_start + compressed_size);
+
+    blocks[block].offset_ = offset + compressed_start;
+    blocks[block].compressed_size_ = compressed_size;
+    blocks[block].raw_size_ = raw.size();
+  }
+
+  std::ofstream output_file(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output_file)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Unable to open " << file_name << " for writing");
+    return false;
+  }
+  output_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  output_file.write(names.data(), names.size());
+  output_file.write(reinterpret_cast<const char *>(blocks.data()), blocks.size() * sizeof(CompressedTrajectoryBlock));
+  output_file.write(reinterpret_cast<const char *>(compressed.data()), compressed.size());
+
+  if (!output_file)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Failed writing " << file_name);
+    return false;
+  }
+  return true;
+}
+
+bool CompressedTrajectoryFile::write(const std::string &file_name, const robot_trajectory::RobotTrajectory &trajectory,
+                                     const CompressionOptions &options)
+{
+  const std::size_t num_waypoints = trajectory.getWayPointCount();
+  TrajectoryData data;
+  data.variable_names_ = trajectory.getRobotModel()->getVariableNames();
+  data.num_variables_ = data.variable_names_.size();
+
+  // Only store velocities and accelerations if every waypoint has them
+  bool has_velocities = num_waypoints > 0;
+  bool has_accelerations = num_waypoints > 0;
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    has_velocities &= trajectory.getWayPoint(i).hasVelocities();
+    has_accelerations &= trajectory.getWayPoint(i).hasAccelerations();
+  }
+
+  double time = 0;
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    const moveit::core::RobotState &state = trajectory.getWayPoint(i);
+    data.positions_.insert(data.positions_.end(), state.getVariablePositions(),
+                           state.getVariablePositions() + data.num_variables_);
+    if (has_velocities)
+      data.velocities_.insert(data.velocities_.end(), state.getVariableVelocities(),
+                              state.getVariableVelocities() + data.num_variables_);
+    if (has_accelerations)
+      data.accelerations_.insert(data.accelerations_.end(), state.getVariableAccelerations(),
+                                 state.getVariableAccelerations() + data.num_variables_);
+    time += trajectory.getWayPointDurationFromPrevious(i);
+    data.times_.push_back(time);
+  }
+
+  return write(file_name, data, options);
+}
+
+}  // namespace moveit_boilerplate
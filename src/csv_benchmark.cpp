@@ -0,0 +1,337 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Benchmark of loading joint and Cartesian trajectory CSV files with CSVReader and the stream based path
+
+   Usage, with only a roscore running:
+     rosrun moveit_boilerplate moveit_boilerplate_csv_benchmark _megabytes:=20 _iterations:=5
+
+   Joint files are written with moveit::core::robotStateToStream() as saveJointTrajectoryToFile() does, Cartesian
+   files in the format of saveCartTrajectoryToFile(). Both readers produce robot states or poses, so the times
+   include everything loading a file costs except visualization. Max diff compares the results of the two readers.
+*/
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ROS
+#include <ros/ros.h>
+
+// MoveIt
+#include <eigen_stl_containers/eigen_stl_vector_container.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/robot_state/robot_state.h>
+
+// Visual tools
+#include <rviz_visual_tools/rviz_visual_tools.h>
+
+// this package
+#include <moveit_boilerplate/benchmark_robot.h>
+#include <moveit_boilerplate/csv_reader.h>
+
+namespace
+{
+const std::string NAME = "csv_benchmark";
+
+typedef std::chrono::steady_clock Clock;
+
+/** \brief Value below which the given fraction of sorted samples lie */
+double percentile(const std::vector<double> &sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0.0;
+  const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+  return sorted[index];
+}
+
+double fileMegabytes(const std::string &file_name)
+{
+  std::ifstream input_file(file_name.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  return static_cast<double>(input_file.tellg()) / (1024.0 * 1024.0);
+}
+
+/** \brief Joints sweep at different frequencies until the file reaches the requested size */
+void writeJointFile(const std::string &file_name, const robot_model::RobotModelConstPtr &robot_model,
+                    double megabytes)
+{
+  std::ofstream output_file(file_name.c_str());
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  const std::size_t bytes = megabytes * 1024 * 1024;
+  for (std::size_t i = 0; static_cast<std::size_t>(output_file.tellp()) < bytes; ++i)
+  {
+    for (std::size_t j = 0; j < state.getVariableCount(); ++j)
+      state.setVariablePosition(j, std::sin(1e-3 * i * (1.0 + 0.25 * j)));
+    moveit::core::robotStateToStream(state, output_file, false);
+  }
+}
+
+/** \brief A helix, written like saveCartTrajectoryToFile() */
+void writeCartFile(const std::string &file_name, double megabytes)
+{
+  std::ofstream output_file(file_name.c_str());
+  const std::size_t bytes = megabytes * 1024 * 1024;
+  for (std::size_t i = 0; static_cast<std::size_t>(output_file.tellp()) < bytes; ++i)
+  {
+    const double t = 1e-3 * i;
+    output_file << 0.5 * std::cos(t) << ", " << 0.5 * std::sin(t) << ", " << 0.1 * t << ", " << 0.0 << ", "
+                << M_PI / 2 << ", " << t << ", " << 0.01 * i << std::endl;
+  }
+}
+
+/** \brief The previous loadJointTrajectoryFromFile() */
+void loadJointsWithStreams(const std::string &file_name, const moveit::core::RobotState &prototype,
+                           std::vector<moveit::core::RobotStatePtr> &states)
+{
+  states.clear();
+  std::ifstream input_file(file_name.c_str());
+  std::string line;
+  while (std::getline(input_file, line))
+  {
+    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(prototype));
+    moveit::core::streamToRobotState(*new_state, line, ",");
+    states.push_back(new_state);
+  }
+}
+
+void loadJointsWithReader(moveit_boilerplate::CSVReader &reader, const std::string &file_name,
+                          const moveit::core::RobotState &prototype, std::vector<moveit::core::RobotStatePtr> &states)
+{
+  states.clear();
+  if (!reader.parseFile(file_name))
+    return;
+  states.reserve(reader.getRowCount());
+  for (std::size_t i = 0; i < reader.getRowCount(); ++i)
+  {
+    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(prototype));
+    new_state->setVariablePositions(reader.getRow(i));
+    states.push_back(new_state);
+  }
+}
+
+/** \brief The previous loadCartTrajectoryFromFile() and streamToAffine3d() */
+void loadCartWithStreams(const std::string &file_name, std::vector<double> &times, EigenSTL::vector_Affine3d &poses)
+{
+  times.clear();
+  poses.clear();
+  std::ifstream input_file(file_name.c_str());
+  std::string line;
+  while (std::getline(input_file, line))
+  {
+    if (line.empty())
+      continue;
+
+    std::stringstream line_stream(line);
+    std::string cell;
+    std::vector<double> transform6(6);
+    for (std::size_t i = 0; i < transform6.size(); ++i)
+    {
+      std::getline(line_stream, cell, ',');
+      transform6[i] = atof(cell.c_str());
+    }
+    std::getline(line_stream, cell, ',');
+    times.push_back(atof(cell.c_str()));
+    poses.push_back(rviz_visual_tools::RvizVisualTools::convertFromXYZRPY(transform6, rviz_visual_tools::XYZ));
+  }
+}
+
+void loadCartWithReader(moveit_boilerplate::CSVReader &reader, const std::string &file_name,
+                        std::vector<double> &times, EigenSTL::vector_Affine3d &poses)
+{
+  times.clear();
+  poses.clear();
+  if (!reader.parseFile(file_name))
+    return;
+  times.reserve(reader.getRowCount());
+  poses.reserve(reader.getRowCount());
+  for (std::size_t i = 0; i < reader.getRowCount(); ++i)
+  {
+    const double *row = reader.getRow(i);
+    times.push_back(row[6]);
+    poses.push_back(rviz_visual_tools::RvizVisualTools::convertFromXYZRPY(row[0], row[1], row[2], row[3], row[4],
+                                                                          row[5], rviz_visual_tools::XYZ));
+  }
+}
+
+/** \brief Time a loader over fresh loads of the same file */
+template <typename Load>
+std::vector<double> timeLoads(const Load &load, std::size_t iterations, std::size_t warmup)
+{
+  std::vector<double> times;
+  for (std::size_t i = 0; i < warmup + iterations; ++i)
+  {
+    const Clock::time_point start = Clock::now();
+    load();
+    const Clock::time_point end = Clock::now();
+    if (i >= warmup)
+      times.push_back(std::chrono::duration<double>(end - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  return times;
+}
+
+void printHeader()
+{
+  std::cout << std::left << std::setw(34) << "method" << std::right << std::setw(10) << "MB" << std::setw(10)
+            << "rows" << std::setw(12) << "p50 ms" << std::setw(12) << "max ms" << std::setw(10) << "MB/s"
+            << std::setw(10) << "speedup" << std::setw(12) << "max diff" << std::endl;
+}
+
+void printResult(const std::string &method, double megabytes, std::size_t rows, const std::vector<double> &times,
+                 double reference_time, double max_diff)
+{
+  const double p50 = percentile(times, 0.5);
+  std::cout << std::left << std::setw(34) << method << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << megabytes << std::setw(10) << rows << std::setw(12) << 1e3 * p50 << std::setw(12)
+            << 1e3 * percentile(times, 1.0) << std::setw(10) << (p50 > 0 ? megabytes / p50 : 0.0) << std::setw(10)
+            << (p50 > 0 ? reference_time / p50 : 0.0) << std::scientific << std::setprecision(1) << std::setw(12)
+            << max_diff << std::endl;
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, NAME);
+
+  // Settings
+  ros::NodeHandle nh("~");
+  int dofs;
+  double megabytes;
+  int iterations;
+  int warmup;
+  std::string directory;
+  nh.param("dofs", dofs, 7);
+  nh.param("megabytes", megabytes, 10.0);
+  nh.param("iterations", iterations, 5);
+  nh.param("warmup", warmup, 1);
+  nh.param("directory", directory, std::string("/tmp"));
+
+  moveit_boilerplate::setBenchmarkRobotParams("robot_description", dofs);
+  robot_model_loader::RobotModelLoader robot_model_loader("robot_description");
+  const robot_model::RobotModelPtr &robot_model = robot_model_loader.getModel();
+  if (!robot_model)
+  {
+    ROS_ERROR_STREAM_NAMED(NAME, "Unable to load the " << dofs << " DOF benchmark robot");
+    return 1;
+  }
+  moveit::core::RobotState prototype(robot_model);
+  prototype.setToDefaultValues();
+
+  const std::string joint_file = directory + "/" + NAME + "_joints.csv";
+  const std::string cart_file = directory + "/" + NAME + "_poses.csv";
+  writeJointFile(joint_file, robot_model, megabytes);
+  writeCartFile(cart_file, megabytes);
+
+  std::cout << "Time to load each file in milliseconds, " << iterations << " iterations each. Speedup is relative "
+            << "to the stream based reader" << std::endl;
+  printHeader();
+
+  moveit_boilerplate::CSVReader reader;
+
+  // Joint trajectories
+  {
+    std::vector<moveit::core::RobotStatePtr> stream_states;
+    std::vector<moveit::core::RobotStatePtr> reader_states;
+    const std::vector<double> stream_times = timeLoads(
+        [&]()
+        {
+          loadJointsWithStreams(joint_file, prototype, stream_states);
+        },
+        iterations, warmup);
+    const std::vector<double> reader_times = timeLoads(
+        [&]()
+        {
+          loadJointsWithReader(reader, joint_file, prototype, reader_states);
+        },
+        iterations, warmup);
+
+    double max_diff = stream_states.size() == reader_states.size() ? 0.0 : INFINITY;
+    for (std::size_t i = 0; i < std::min(stream_states.size(), reader_states.size()); ++i)
+      for (std::size_t j = 0; j < prototype.getVariableCount(); ++j)
+        max_diff = std::max(max_diff, std::fabs(stream_states[i]->getVariablePosition(j) -
+                                                 reader_states[i]->getVariablePosition(j)));
+
+    const double size = fileMegabytes(joint_file);
+    const double reference_time = percentile(stream_times, 0.5);
+    printResult("joints getline+streamToRobotState", size, stream_states.size(), stream_times, reference_time, 0.0);
+    printResult("joints CSVReader", size, reader_states.size(), reader_times, reference_time, max_diff);
+  }
+
+  // Cartesian trajectories
+  {
+    std::vector<double> stream_seconds;
+    std::vector<double> reader_seconds;
+    EigenSTL::vector_Affine3d stream_poses;
+    EigenSTL::vector_Affine3d reader_poses;
+    const std::vector<double> stream_times = timeLoads(
+        [&]()
+        {
+          loadCartWithStreams(cart_file, stream_seconds, stream_poses);
+        },
+        iterations, warmup);
+    const std::vector<double> reader_times = timeLoads(
+        [&]()
+        {
+          loadCartWithReader(reader, cart_file, reader_seconds, reader_poses);
+        },
+        iterations, warmup);
+
+    double max_diff = stream_poses.size() == reader_poses.size() ? 0.0 : INFINITY;
+    for (std::size_t i = 0; i < std::min(stream_poses.size(), reader_poses.size()); ++i)
+    {
+      max_diff = std::max(max_diff, (stream_poses[i].matrix() - reader_poses[i].matrix()).cwiseAbs().maxCoeff());
+      max_diff = std::max(max_diff, std::fabs(stream_seconds[i] - reader_seconds[i]));
+    }
+
+    const double size = fileMegabytes(cart_file);
+    const double reference_time = percentile(stream_times, 0.5);
+    printResult("poses getline+stringstream+atof", size, stream_poses.size(), stream_times, reference_time, 0.0);
+    printResult("poses CSVReader", size, reader_poses.size(), reader_times, reference_time, max_diff);
+  }
+
+  std::remove(joint_file.c_str());
+  std::remove(cart_file.c_str());
+  return 0;
+}
@@ -0,0 +1,274 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Bulk reader of numeric CSV files that parses the whole buffer without streams or per cell strings
+*/
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// this package
+#include <moveit_boilerplate/csv_reader.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+// Powers of ten that are exact doubles
+const double POWERS_OF_TEN[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+const int MAX_EXACT_EXPONENT = 22;
+const std::uint64_t MAX_EXACT_MANTISSA = std::uint64_t(1) << 53;
+const int MAX_MANTISSA_DIGITS = 19;  // always fits a uint64
+
+inline bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+inline bool isBlank(char c)
+{
+  return c == ' ' || c == '\t';
+}
+
+/** \brief Convert with strtod, for inputs the fast path cannot convert exactly */
+const char *parseDoubleSlow(const char *begin, const char *end, double &value)
+{
+  std::string cell(begin, end);
+  char *cell_end;
+  value = std::strtod(cell.c_str(), &cell_end);
+  if (cell_end == cell.c_str())
+    return NULL;
+  return begin + (cell_end - cell.c_str());
+}
+}  // namespace
+
+CSVReader::CSVReader(char separator) : separator_(separator)
+{
+}
+
+bool CSVReader::parseFile(const std::string &file_name, std::size_t skip_lines)
+{
+  std::ifstream input_file(file_name.c_str(), std::ios::in | std::ios::binary);
+  if (!input_file)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to open " << file_name);
+    return false;
+  }
+
+  input_file.seekg(0, std::ios::end);
+  buffer_.resize(static_cast<std::size_t>(input_file.tellg()));
+  input_file.seekg(0, std::ios::beg);
+  if (!buffer_.empty() && !input_file.read(buffer_.data(), buffer_.size()))
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to read " << file_name);
+    return false;
+  }
+
+  return parse(buffer_.data(), buffer_.size(), skip_lines);
+}
+
+bool CSVReader::parse(const char *data, std::size_t size, std::size_t skip_lines)
+{
+  values_.clear();
+  rows_ = 0;
+  columns_ = 0;
+
+  const char *end = data + size;
+  const std::size_t num_lines = std::count(data, end, '\n') + 1;
+  std::size_t line_number = 0;
+  for (const char *line = data; line < end;)
+  {
+    const char *line_end = static_cast<const char *>(std::memchr(line, '\n', end - line));
+    if (!line_end)
+      line_end = end;
+    const char *next_line = line_end < end ? line_end + 1 : end;
+    line_number++;
+
+    const char *stop = line_end;
+    if (stop > line && stop[-1] == '\r')
+      --stop;
+    const char *cell = line;
+    while (cell < stop && isBlank(*cell))
+      ++cell;
+
+    if (skip_lines > 0 || cell == stop)
+    {
+      skip_lines -= skip_lines > 0 ? 1 : 0;
+      line = next_line;
+      continue;
+    }
+
+    const std::size_t row_start = values_.size();
+    while (true)
+    {
+      double value;
+      const char *cell_end = parseDouble(cell, stop, value);
+      if (!cell_end)
+      {
+        ROS_ERROR_STREAM_NAMED(name_, "Expected a number on line " << line_number << " column "
+                                                                   << values_.size() - row_start + 1);
+        return false;
+      }
+      values_.push_back(value);
+
+      cell = cell_end;
+      while (cell < stop && isBlank(*cell))
+        ++cell;
+      if (cell == stop)
+        break;
+      if (*cell != separator_)
+      {
+        ROS_ERROR_STREAM_NAMED(name_, "Unexpected character '" << *cell << "' on line " << line_number);
+        return false;
+      }
+
+      // Allow a trailing separator
+      ++cell;
+      while (cell < stop && isBlank(*cell))
+        ++cell;
+      if (cell == stop)
+        break;
+    }
+
+    const std::size_t columns = values_.size() - row_start;
+    if (rows_ == 0)
+    {
+      // All rows are this wide, so reserve for the whole file now
+      columns_ = columns;
+      values_.reserve(columns_ * (num_lines - line_number + 1));
+    }
+    else if (columns != columns_)
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Line " << line_number << " has " << columns << " columns, expected "
+                                            << columns_);
+      return false;
+    }
+    rows_++;
+    line = next_line;
+  }
+
+  return true;
+}
+
+const char *CSVReader::parseDouble(const char *begin, const char *end, double &value)
+{
+  const char *p = begin;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    ++p;
+  }
+
+  // Collect up to 19 significant digits, later digits only shift the exponent
+  std::uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any_digits = false;
+  for (; p < end && isDigit(*p); ++p)
+  {
+    any_digits = true;
+    if (digits < MAX_MANTISSA_DIGITS)
+    {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += mantissa != 0;
+    }
+    else
+      exponent++;
+  }
+  if (p < end && *p == '.')
+  {
+    for (++p; p < end && isDigit(*p); ++p)
+    {
+      any_digits = true;
+      if (digits < MAX_MANTISSA_DIGITS)
+      {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+        exponent--;
+      }
+    }
+  }
+
+  // nan, inf and hexadecimal are left to strtod
+  if (!any_digits)
+    return parseDoubleSlow(begin, end, value);
+
+  if (p < end && (*p == 'e' || *p == 'E'))
+  {
+    const char *q = p + 1;
+    bool negative_exponent = false;
+    if (q < end && (*q == '-' || *q == '+'))
+    {
+      negative_exponent = *q == '-';
+      ++q;
+    }
+    int explicit_exponent = 0;
+    const char *exponent_digits = q;
+    for (; q < end && isDigit(*q); ++q)
+      if (explicit_exponent < 10000)
+        explicit_exponent = explicit_exponent * 10 + (*q - '0');
+
+    // An 'e' without digits is not part of the number
+    if (q > exponent_digits)
+    {
+      exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+      p = q;
+    }
+  }
+
+  if (mantissa == 0)
+  {
+    value = negative ? -0.0 : 0.0;
+    return p;
+  }
+
+  // Both factors are exact, so the single rounding of the product or quotient is the correctly rounded result
+  if (mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_EXPONENT && exponent <= MAX_EXACT_EXPONENT)
+  {
+    double result = static_cast<double>(mantissa);
+    result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] : result * POWERS_OF_TEN[exponent];
+    value = negative ? -result : result;
+    return p;
+  }
+
+  return parseDoubleSlow(begin, p, value) ? p : NULL;
+}
+
+}  // namespace moveit_boilerplate
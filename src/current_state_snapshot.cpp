@@ -0,0 +1,173 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Lock-free copy of the robot's current joint values, fed by the planning scene monitor
+*/
+
+// C++
+#include <algorithm>
+
+// this package
+#include <moveit_boilerplate/current_state_snapshot.h>
+
+namespace moveit_boilerplate
+{
+CurrentStateSnapshot::CurrentStateSnapshot(psm::PlanningSceneMonitorPtr planning_scene_monitor) : buffer_(new Buffer())
+{
+  const std::size_t num_variables = planning_scene_monitor->getRobotModel()->getVariableCount();
+  buffer_->positions_.resize(num_variables);
+  buffer_->velocities_.resize(num_variables);
+
+  // Seed with the state the monitor currently has
+  {
+    boost::mutex::scoped_lock write_lock(buffer_->write_mutex_);
+    psm::LockedPlanningSceneRO scene(planning_scene_monitor);  // Lock planning scene
+    buffer_->base_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
+    write(*buffer_, scene->getCurrentState());
+  }  // end scoped pointer of locked planning scene
+
+  // The monitor has no way to remove a single callback, so it only gets weak pointers and the callback does nothing
+  // once this snapshot is destroyed
+  BufferWeakPtr weak_buffer(buffer_);
+  boost::weak_ptr<psm::PlanningSceneMonitor> weak_monitor(planning_scene_monitor);
+  planning_scene_monitor->addUpdateCallback(
+      boost::bind(&CurrentStateSnapshot::sceneUpdateCallback, weak_buffer, weak_monitor, _1));
+}
+
+moveit::core::RobotStatePtr CurrentStateSnapshot::getCurrentState() const
+{
+  moveit::core::RobotStatePtr robot_state;
+  std::size_t version = 0;
+  std::size_t scene_version = 0;
+  update(robot_state, version, scene_version);
+  return robot_state;
+}
+
+bool CurrentStateSnapshot::update(moveit::core::RobotStatePtr &robot_state, std::size_t &version,
+                                  std::size_t &scene_version) const
+{
+  // Read before the base state, which is replaced before the scene version changes, so the copy is never older
+  const std::size_t latest_scene_version = getSceneVersion();
+  if (!robot_state || latest_scene_version != scene_version)
+  {
+    moveit::core::RobotStateConstPtr base_state;
+    {
+      boost::mutex::scoped_lock base_state_lock(buffer_->base_state_mutex_);
+      base_state = buffer_->base_state_;
+    }
+
+    // Copied without the lock, the base state is never modified once published
+    if (robot_state)
+      *robot_state = *base_state;
+    else
+      robot_state.reset(new moveit::core::RobotState(*base_state));
+    scene_version = latest_scene_version;
+    version = 0;  // the joint values of the base state may be older than the buffer's
+  }
+
+  return update(*robot_state, version);
+}
+
+bool CurrentStateSnapshot::update(moveit::core::RobotState &robot_state, std::size_t &version) const
+{
+  std::size_t sequence;
+  do
+  {
+    sequence = buffer_->seqlock_.readBegin();
+    if (SeqLock::toVersion(sequence) == version)
+      return false;  // nothing changed since the caller's last read
+
+    read(*buffer_, robot_state);
+  } while (buffer_->seqlock_.readRetry(sequence));
+
+  // The values were written in place, so recompute all transforms
+  robot_state.update(true);
+  version = SeqLock::toVersion(sequence);
+  return true;
+}
+
+void CurrentStateSnapshot::write(Buffer &buffer, const moveit::core::RobotState &robot_state)
+{
+  const double *positions = robot_state.getVariablePositions();
+  const bool has_velocities = robot_state.hasVelocities();
+
+  buffer.seqlock_.writeBegin();
+  std::copy(positions, positions + buffer.positions_.size(), buffer.positions_.begin());
+  if (has_velocities)
+  {
+    const double *velocities = robot_state.getVariableVelocities();
+    std::copy(velocities, velocities + buffer.velocities_.size(), buffer.velocities_.begin());
+  }
+  buffer.has_velocities_ = has_velocities;
+  buffer.seqlock_.writeEnd();
+}
+
+void CurrentStateSnapshot::read(const Buffer &buffer, moveit::core::RobotState &robot_state)
+{
+  std::copy(buffer.positions_.begin(), buffer.positions_.end(), robot_state.getVariablePositions());
+  if (buffer.has_velocities_)
+    std::copy(buffer.velocities_.begin(), buffer.velocities_.end(), robot_state.getVariableVelocities());
+}
+
+void CurrentStateSnapshot::sceneUpdateCallback(const BufferWeakPtr &weak_buffer,
+                                               const boost::weak_ptr<psm::PlanningSceneMonitor> &planning_scene_monitor,
+                                               psm::PlanningSceneMonitor::SceneUpdateType type)
+{
+  // Transform only updates change neither the joint values nor the attached bodies
+  if (!(type & (psm::PlanningSceneMonitor::UPDATE_STATE | psm::PlanningSceneMonitor::UPDATE_GEOMETRY)))
+    return;
+
+  BufferPtr buffer = weak_buffer.lock();
+  psm::PlanningSceneMonitorPtr monitor = planning_scene_monitor.lock();
+  if (!buffer || !monitor)
+    return;
+
+  boost::mutex::scoped_lock write_lock(buffer->write_mutex_);
+  psm::LockedPlanningSceneRO scene(monitor);  // Lock planning scene
+
+  // Attaching and detaching objects are reported as geometry updates
+  if (type & psm::PlanningSceneMonitor::UPDATE_GEOMETRY)
+  {
+    moveit::core::RobotStateConstPtr base_state(new moveit::core::RobotState(scene->getCurrentState()));
+    {
+      boost::mutex::scoped_lock base_state_lock(buffer->base_state_mutex_);
+      buffer->base_state_ = base_state;
+    }
+    buffer->scene_version_.fetch_add(1, std::memory_order_release);
+  }
+
+  write(*buffer, scene->getCurrentState());
+}
+
+}  // namespace moveit_boilerplate
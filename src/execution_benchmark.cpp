@@ -0,0 +1,283 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Benchmark of the joint command modes of ExecutionInterface against a local fake controller
+
+   Usage, with only a roscore running:
+     rosrun moveit_boilerplate moveit_boilerplate_execution_benchmark _iterations:=100 _dofs:=[6,12]
+
+   Command latency is from calling executeTrajectoryAsync() until the fake controller receives the trajectory,
+   completion latency until the returned future is ready. The fake controller jumps to the end of every
+   trajectory, so completion includes the joint state round trip and the execution monitor but not playback.
+*/
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ROS
+#include <ros/ros.h>
+
+// MoveIt
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+// this package
+#include <moveit_boilerplate/benchmark_robot.h>
+#include <moveit_boilerplate/execution_interface.h>
+
+namespace
+{
+const std::string NAME = "execution_benchmark";
+const std::string CONTROLLER_NS = "/benchmark_controller";
+
+/** \brief Value below which the given fraction of sorted samples lie */
+double percentile(const std::vector<double> &sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0.0;
+  const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+  return sorted[index];
+}
+
+/** \brief Configure the execution interface for one command mode, with all debugging turned off */
+void setExecutionParams(const std::string &command_mode, const std::vector<std::string> &joint_names)
+{
+  const std::string ns = "~execution_interface/";
+  ros::param::set(ns + "command_mode", command_mode);
+  ros::param::set(ns + "joint_trajectory_topic", CONTROLLER_NS + "/command");
+  ros::param::set(ns + "cartesian_command_topic", "/benchmark_cartesian_command");
+  ros::param::set(ns + "cartesian_streaming_rate", 0.0);
+  ros::param::set(ns + "cartesian_interpolation_duration", 0.0);
+  ros::param::set(ns + "save_traj_to_file", false);
+  ros::param::set(ns + "save_traj_to_file_path", std::string("/tmp"));
+  ros::param::set(ns + "visualize_trajectory_line", false);
+  ros::param::set(ns + "visualize_trajectory_path", false);
+  ros::param::set(ns + "check_for_waypoint_jumps", false);
+  ros::param::set(ns + "latency_stats_period", 0.0);
+  ros::param::set(ns + "splice_blend_duration", 0.1);
+  ros::param::set(ns + "streaming_first_window", 0.1);
+  ros::param::set(ns + "streaming_window", 0.5);
+  ros::param::set(ns + "streaming_lead_time", 0.2);
+
+  // moveit_simple_controller_manager pointed at the fake controller's action server
+  ros::param::set("~moveit_controller_manager", std::string("moveit_simple_controller_manager/"
+                                                            "MoveItSimpleControllerManager"));
+  XmlRpc::XmlRpcValue controller_list;
+  controller_list.setSize(1);
+  controller_list[0]["name"] = CONTROLLER_NS.substr(1);
+  controller_list[0]["action_ns"] = std::string("follow_joint_trajectory");
+  controller_list[0]["type"] = std::string("FollowJointTrajectory");
+  controller_list[0]["default"] = true;
+  controller_list[0]["joints"].setSize(joint_names.size());
+  for (std::size_t i = 0; i < joint_names.size(); ++i)
+    controller_list[0]["joints"][i] = joint_names[i];
+  ros::param::set("~controller_list", controller_list);
+}
+
+/** \brief Sine sweep of all joints from zero to amplitude, waypoint_dt apart */
+robot_trajectory::RobotTrajectoryPtr makeTrajectory(const robot_model::RobotModelConstPtr &robot_model,
+                                                    const robot_model::JointModelGroup *jmg, std::size_t waypoints,
+                                                    double waypoint_dt, double amplitude)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory(new robot_trajectory::RobotTrajectory(robot_model, jmg));
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  std::vector<double> positions(jmg->getActiveJointModels().size());
+  for (std::size_t i = 0; i < waypoints; ++i)
+  {
+    const double s = waypoints > 1 ? static_cast<double>(i) / (waypoints - 1) : 1.0;
+    std::fill(positions.begin(), positions.end(), amplitude * std::sin(0.5 * M_PI * s));
+    state.setJointGroupPositions(jmg, positions);
+    trajectory->addSuffixWayPoint(state, i == 0 ? 0.0 : waypoint_dt);
+  }
+  return trajectory;
+}
+
+struct Result
+{
+  std::vector<double> command_latencies_;
+  std::vector<double> completion_latencies_;
+  std::size_t failures_ = 0;
+  double total_time_ = 0;
+};
+
+/** \brief Execute trajectories back and forth and time each one */
+Result runBenchmark(moveit_boilerplate::ExecutionInterface &execution_interface,
+                    moveit_boilerplate::FakeTrajectoryController &controller,
+                    const robot_trajectory::RobotTrajectoryPtr &forward,
+                    const robot_trajectory::RobotTrajectoryPtr &backward, JointModelGroup *jmg,
+                    std::size_t iterations, std::size_t warmup)
+{
+  typedef std::chrono::steady_clock Clock;
+  Result result;
+  const Clock::time_point benchmark_start = Clock::now();
+  for (std::size_t i = 0; i < warmup + iterations; ++i)
+  {
+    if (i == warmup)
+      result.total_time_ = -std::chrono::duration<double>(Clock::now() - benchmark_start).count();
+
+    const std::size_t command_count = controller.getCommandCount();
+    const Clock::time_point start = Clock::now();
+    moveit_boilerplate::ExecutionInterface::ExecutionFuture execution =
+        execution_interface.executeTrajectoryAsync(i % 2 ? backward : forward, jmg);
+    const bool success = execution.get() == moveit_controller_manager::ExecutionStatus::SUCCEEDED;
+    const Clock::time_point end = Clock::now();
+
+    if (i < warmup)
+      continue;
+    if (!success || controller.getCommandCount() == command_count)
+    {
+      result.failures_++;
+      continue;
+    }
+    result.command_latencies_.push_back(std::chrono::duration<double>(controller.getLastCommandTime() - start).count());
+    result.completion_latencies_.push_back(std::chrono::duration<double>(end - start).count());
+  }
+  result.total_time_ += std::chrono::duration<double>(Clock::now() - benchmark_start).count();
+
+  std::sort(result.command_latencies_.begin(), result.command_latencies_.end());
+  std::sort(result.completion_latencies_.begin(), result.completion_latencies_.end());
+  return result;
+}
+
+void printHeader()
+{
+  std::cout << std::left << std::setw(26) << "mode" << std::right << std::setw(5) << "dof" << std::setw(10)
+            << "waypoints" << std::setw(11) << "cmd p50" << std::setw(11) << "cmd p90" << std::setw(11) << "cmd p99"
+            << std::setw(11) << "cmd max" << std::setw(11) << "done p50" << std::setw(11) << "done p99"
+            << std::setw(11) << "traj/s" << std::setw(13) << "points/s" << std::setw(10) << "failures" << std::endl;
+}
+
+void printResult(const std::string &mode, std::size_t dof, std::size_t waypoints, const Result &result)
+{
+  const std::size_t completed = result.completion_latencies_.size();
+  const double rate = result.total_time_ > 0 ? completed / result.total_time_ : 0.0;
+  std::cout << std::left << std::setw(26) << mode << std::right << std::setw(5) << dof << std::setw(10) << waypoints
+            << std::fixed << std::setprecision(3) << std::setw(11)
+            << 1e3 * percentile(result.command_latencies_, 0.5) << std::setw(11)
+            << 1e3 * percentile(result.command_latencies_, 0.9) << std::setw(11)
+            << 1e3 * percentile(result.command_latencies_, 0.99) << std::setw(11)
+            << 1e3 * percentile(result.command_latencies_, 1.0) << std::setw(11)
+            << 1e3 * percentile(result.completion_latencies_, 0.5) << std::setw(11)
+            << 1e3 * percentile(result.completion_latencies_, 0.99) << std::setprecision(1) << std::setw(11) << rate
+            << std::setw(13) << rate * waypoints << std::setw(10) << result.failures_ << std::endl;
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, NAME);
+  ros::AsyncSpinner spinner(4);
+  spinner.start();
+
+  // Settings
+  ros::NodeHandle nh("~");
+  std::vector<int> dofs;
+  std::vector<int> waypoint_counts;
+  std::vector<std::string> modes;
+  int iterations;
+  int warmup;
+  double waypoint_dt;
+  nh.param("dofs", dofs, std::vector<int>{ 6, 12, 24 });
+  nh.param("waypoints", waypoint_counts, std::vector<int>{ 10, 100, 1000 });
+  nh.param("modes", modes, std::vector<std::string>{ "joint_execution_manager", "joint_publisher", "joint_streaming" });
+  nh.param("iterations", iterations, 50);
+  nh.param("warmup", warmup, 5);
+  nh.param("waypoint_dt", waypoint_dt, 0.001);
+
+  std::cout << "Command latency (cmd) and completion latency (done) in milliseconds, " << iterations
+            << " iterations each" << std::endl;
+  printHeader();
+
+  for (std::size_t d = 0; d < dofs.size() && ros::ok(); ++d)
+  {
+    const std::size_t dof = dofs[d];
+
+    // Fresh robot model for this number of joints
+    moveit_boilerplate::setBenchmarkRobotParams("robot_description", dof);
+    robot_model_loader::RobotModelLoaderPtr robot_model_loader(
+        new robot_model_loader::RobotModelLoader("robot_description"));
+    const robot_model::RobotModelPtr &robot_model = robot_model_loader->getModel();
+    if (!robot_model)
+    {
+      ROS_ERROR_STREAM_NAMED(NAME, "Unable to load the " << dof << " DOF benchmark robot");
+      return 1;
+    }
+    JointModelGroup *jmg = robot_model->getJointModelGroup("arm");
+    const std::vector<std::string> &joint_names = jmg->getActiveJointModelNames();
+
+    moveit_boilerplate::FakeTrajectoryController controller(ros::NodeHandle(CONTROLLER_NS), joint_names, 100.0);
+
+    planning_scene::PlanningScenePtr planning_scene(new planning_scene::PlanningScene(robot_model));
+    psm::PlanningSceneMonitorPtr planning_scene_monitor(
+        new psm::PlanningSceneMonitor(planning_scene, robot_model_loader, boost::shared_ptr<tf::Transformer>(), NAME));
+    planning_scene_monitor->startStateMonitor(CONTROLLER_NS + "/joint_states");
+    ros::Duration(0.5).sleep();  // first joint states
+
+    mvt::MoveItVisualToolsPtr visual_tools(
+        new mvt::MoveItVisualTools(robot_model->getModelFrame(), "/benchmark_markers", planning_scene_monitor));
+    visual_tools->getRemoteControl()->setFullAutonomous(true);  // never wait for confirmation
+
+    // Shared by the execution interfaces of all modes, like in Boilerplate
+    moveit_boilerplate::CurrentStateSnapshotPtr state_snapshot(
+        new moveit_boilerplate::CurrentStateSnapshot(planning_scene_monitor));
+
+    for (std::size_t m = 0; m < modes.size() && ros::ok(); ++m)
+    {
+      setExecutionParams(modes[m], joint_names);
+      moveit_boilerplate::ExecutionInterface execution_interface(planning_scene_monitor, visual_tools, state_snapshot);
+
+      for (std::size_t w = 0; w < waypoint_counts.size() && ros::ok(); ++w)
+      {
+        const std::size_t waypoints = waypoint_counts[w];
+        robot_trajectory::RobotTrajectoryPtr forward = makeTrajectory(robot_model, jmg, waypoints, waypoint_dt, 0.5);
+        robot_trajectory::RobotTrajectoryPtr backward(new robot_trajectory::RobotTrajectory(*forward));
+        backward->reverse();
+
+        Result result =
+            runBenchmark(execution_interface, controller, forward, backward, jmg, iterations, warmup);
+        printResult(modes[m], dof, waypoints, result);
+      }
+    }
+  }
+
+  ros::shutdown();
+  return 0;
+}
@@ -43,13 +43,21 @@
    moveit_simple_controller_manager   average: 0.00450083
    moveit_ros_control_interface       average: 0.222877 TODO this has gotten faster
    Direct publishing on ROS topic:    average: 0.00184441  (59% faster)
+   Current numbers for each stage: rosservice call /NODE/dump_execution_latency
 */
 
 // C++
+#include <algorithm>
+#include <cmath>
+#include <sstream>
 #include <string>
 
+// Boost
+#include <boost/make_shared.hpp>
+
 // MoveItManipulation
 #include <moveit_boilerplate/execution_interface.h>
+#include <moveit_boilerplate/splice_blend.h>
 
 // MoveIt
 #include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
@@ -63,17 +71,13 @@
 namespace moveit_boilerplate
 {
 ExecutionInterface::ExecutionInterface(psm::PlanningSceneMonitorPtr planning_scene_monitor,
-                                       mvt::MoveItVisualToolsPtr visual_tools)
+                                       mvt::MoveItVisualToolsPtr visual_tools, CurrentStateSnapshotPtr state_snapshot)
   : nh_("~")
   , planning_scene_monitor_(planning_scene_monitor)
   , visual_tools_(visual_tools)
+  , state_snapshot_(state_snapshot)
+  , latency_stats_({ "conversion", "visualization", "validation", "confirmation", "send", "save", "total" })
 {
-  // Create initial robot state
-  {
-    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-    current_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
-  }  // end scoped pointer of locked planning scene
-
   // Debug tools for visualizing in Rviz
   if (!visual_tools_)
     loadVisualTools();
@@ -95,6 +99,43 @@ ExecutionInterface::ExecutionInterface(psm::PlanningSceneMonitorPtr planning_sce
   error += !rosparam_shortcuts::get(name_, rpnh, "check_for_waypoint_jumps", check_for_waypoint_jumps_);
   rosparam_shortcuts::shutdownIfError(name_, error);
 
+  // Publish timing of the execution pipeline
+  double latency_stats_period = 0;
+  rpnh.param("latency_stats_period", latency_stats_period, latency_stats_period);
+  if (latency_stats_period > 0)
+  {
+    latency_stats_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>("execution_latency", 1);
+    latency_stats_timer_ = nh_.createTimer(ros::Duration(latency_stats_period),
+                                           &ExecutionInterface::publishLatencyStats, this);
+  }
+  latency_stats_service_ =
+      nh_.advertiseService("dump_execution_latency", &ExecutionInterface::dumpLatencyStats, this);
+
+  // Check every trajectory before it is sent
+  if (check_for_waypoint_jumps_)
+  {
+    double max_waypoint_jump;
+    error += !rosparam_shortcuts::get(name_, rpnh, "max_waypoint_jump", max_waypoint_jump);
+    rosparam_shortcuts::shutdownIfError(name_, error);
+
+    trajectory_validator_.reset(new TrajectoryValidator(planning_scene_monitor_->getRobotModel(), max_waypoint_jump));
+  }
+
+  // Record executed trajectories without slowing down execution
+  if (save_traj_to_file_)
+  {
+    int queue_size = 16;
+    int max_file_size_mb = 64;
+    int max_files = 10;
+    rpnh.param("save_traj_queue_size", queue_size, queue_size);
+    rpnh.param("save_traj_max_file_size_mb", max_file_size_mb, max_file_size_mb);
+    rpnh.param("save_traj_max_files", max_files, max_files);
+
+    trajectory_recorder_.reset(new TrajectoryRecorder(save_traj_to_file_path_, std::max(queue_size, 1),
+                                                      std::max(max_file_size_mb, 1) * std::size_t(1024 * 1024),
+                                                      std::max(max_files, 0)));
+  }
+
   // Choose mode from string
   joint_command_mode_ = stringToJointCommandMode(command_mode);
 
@@ -115,10 +156,34 @@ ExecutionInterface::ExecutionInterface(psm::PlanningSceneMonitorPtr planning_sce
       // Alternative method to sending trajectories than trajectory_execution_manager
       joint_trajectory_pub_ = nh_.advertise<trajectory_msgs::JointTrajectory>(joint_trajectory_topic, queue_size);
       break;
+    case JOINT_STREAMING:
+      ROS_DEBUG_STREAM_NAMED(name_, "Connecting to joint streaming publisher on topic " << joint_trajectory_topic);
+      rpnh.param("streaming_first_window", streaming_first_window_, streaming_first_window_);
+      rpnh.param("streaming_window", streaming_window_, streaming_window_);
+      rpnh.param("streaming_lead_time", streaming_lead_time_, streaming_lead_time_);
+
+      // Windows are queued on the controller side, so allow a few to be in flight
+      joint_trajectory_pub_ = nh_.advertise<trajectory_msgs::JointTrajectory>(joint_trajectory_topic, 10);
+      streaming_thread_ = boost::thread(&ExecutionInterface::streamingThread, this);
+      break;
     default:
       ROS_ERROR_STREAM_NAMED(name_, "Unknown control mode");
   }
 
+  // Completion of directly published trajectories is detected from the joint states
+  switch (joint_command_mode_)
+  {
+    case JOINT_PUBLISHER:
+    case JOINT_STREAMING:
+      rpnh.param("splice_blend_duration", splice_blend_duration_, splice_blend_duration_);
+      rpnh.param("goal_position_tolerance", goal_position_tolerance_, goal_position_tolerance_);
+      rpnh.param("goal_timeout_margin", goal_timeout_margin_, goal_timeout_margin_);
+      execution_monitor_thread_ = boost::thread(&ExecutionInterface::executionMonitorThread, this);
+      break;
+    default:
+      break;  // the execution manager reports completion itself
+  }
+
   // TODO(davetcoleman): check if publishers have connected yet
 
   // Load cartesian control method
@@ -128,11 +193,47 @@ ExecutionInterface::ExecutionInterface(psm::PlanningSceneMonitorPtr planning_sce
   // Set the world frame for cartesian control
   pose_stamped_msg_.header.frame_id = "world";
 
+  // Optionally publish cartesian commands at a fixed rate, independent of how often executePose() is called
+  double cartesian_streaming_rate = 0;
+  double cartesian_interpolation_duration = 0;
+  rpnh.param("cartesian_streaming_rate", cartesian_streaming_rate, cartesian_streaming_rate);
+  rpnh.param("cartesian_interpolation_duration", cartesian_interpolation_duration, cartesian_interpolation_duration);
+  if (cartesian_streaming_rate > 0)
+  {
+    cartesian_streamer_.reset(new CartesianStreamer(cartesian_command_pub_, pose_stamped_msg_.header.frame_id,
+                                                    cartesian_streaming_rate, cartesian_interpolation_duration));
+  }
+
   ROS_INFO_STREAM_NAMED(name_, "ExecutionInterface Ready.");
 }
 
+ExecutionInterface::~ExecutionInterface()
+{
+  {
+    boost::mutex::scoped_lock lock(streaming_mutex_);
+    streaming_shutdown_ = true;
+  }
+  streaming_condition_.notify_all();
+  if (streaming_thread_.joinable())
+    streaming_thread_.join();
+
+  {
+    boost::mutex::scoped_lock lock(execution_mutex_);
+    execution_shutdown_ = true;
+  }
+  execution_condition_.notify_all();
+  if (execution_monitor_thread_.joinable())
+    execution_monitor_thread_.join();
+}
+
 bool ExecutionInterface::executePose(const Eigen::Affine3d &pose)
 {
+  if (cartesian_streamer_)
+  {
+    cartesian_streamer_->setTarget(pose);
+    return true;
+  }
+
   pose_stamped_msg_.header.stamp = ros::Time::now();
   visual_tools_->convertPoseSafe(pose, pose_stamped_msg_.pose);
   cartesian_command_pub_.publish(pose_stamped_msg_);
@@ -142,9 +243,62 @@ bool ExecutionInterface::executePose(const Eigen::Affine3d &pose)
 bool ExecutionInterface::executeTrajectory(const robot_trajectory::RobotTrajectoryPtr robot_trajectory, JointModelGroup *jmg,
                                            bool wait_for_execution)
 {
-  // Convert trajectory to a message
-  moveit_msgs::RobotTrajectory trajectory_msg;
-  robot_trajectory->getRobotTrajectoryMsg(trajectory_msg);
+  ExecutionFuture execution = executeTrajectoryAsync(robot_trajectory, jmg);
+
+  // Optionally wait for completion
+  if (wait_for_execution)
+    return waitForExecution(execution);
+
+  ROS_DEBUG_STREAM_NAMED(name_, "Not waiting for execution to finish");
+
+  // Only a failure to send the trajectory can already be known
+  if (execution.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+      execution.get() != moveit_controller_manager::ExecutionStatus::SUCCEEDED)
+    return false;
+  return true;
+}
+
+ExecutionInterface::ExecutionFuture
+ExecutionInterface::executeTrajectoryAsync(const robot_trajectory::RobotTrajectoryPtr robot_trajectory,
+                                           JointModelGroup *jmg)
+{
+  return sendTrajectory(robot_trajectory, jmg, ros::Time());
+}
+
+ExecutionInterface::ExecutionFuture
+ExecutionInterface::spliceTrajectoryAsync(const robot_trajectory::RobotTrajectoryPtr robot_trajectory,
+                                          JointModelGroup *jmg, const ros::Duration &splice_delay)
+{
+  if (joint_command_mode_ == JOINT_EXECUTION_MANAGER)
+  {
+    ROS_WARN_STREAM_NAMED(name_, "The trajectory execution manager can't splice trajectories, preempting instead");
+    return sendTrajectory(robot_trajectory, jmg, ros::Time());
+  }
+  return sendTrajectory(robot_trajectory, jmg, ros::Time::now() + splice_delay);
+}
+
+ExecutionInterface::ExecutionFuture
+ExecutionInterface::sendTrajectory(const robot_trajectory::RobotTrajectoryPtr robot_trajectory, JointModelGroup *jmg,
+                                   const ros::Time &splice_time)
+{
+  ScopedLatencyTimer total_timer(latency_stats_.getStage(LATENCY_TOTAL));
+
+  // Nothing to do if the robot is idle and already where the trajectory would take it
+  const bool idle =
+      !last_execution_.valid() || last_execution_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  if (splice_time.isZero() && idle && isAtCurrentState(*robot_trajectory, jmg))
+  {
+    ROS_INFO_STREAM_NAMED(name_, "Not executing because current state and trajectory are close enough.");
+    return makeExecutionFuture(moveit_controller_manager::ExecutionStatus::SUCCEEDED);
+  }
+
+  // Convert trajectory to a message, reusing the buffers of a previously sent message
+  boost::shared_ptr<moveit_msgs::RobotTrajectory> trajectory_msg_ptr = acquireTrajectoryMsg();
+  moveit_msgs::RobotTrajectory &trajectory_msg = *trajectory_msg_ptr;
+  {
+    ScopedLatencyTimer timer(latency_stats_.getStage(LATENCY_CONVERSION));
+    convertToTrajectoryMsg(*robot_trajectory, trajectory_msg);
+  }
 
   trajectory_msgs::JointTrajectory &trajectory = trajectory_msg.joint_trajectory;
 
@@ -156,7 +310,7 @@ bool ExecutionInterface::executeTrajectory(const robot_trajectory::RobotTrajecto
   if (trajectory.points.empty())
   {
     ROS_ERROR_STREAM_NAMED(name_, "No points to execute, aborting trajectory execution");
-    return false;
+    return makeExecutionFuture(moveit_controller_manager::ExecutionStatus::FAILED);
   }
 
   // Optionally Remove velocity and acceleration from trajectories for testing
@@ -171,104 +325,167 @@ bool ExecutionInterface::executeTrajectory(const robot_trajectory::RobotTrajecto
     }
   }
 
-  // Optionally save to file
-  if (save_traj_to_file_)
+  // Continue from wherever the robot is commanded to be at the splice time
+  bool splice = !splice_time.isZero();
+  if (splice && !spliceIntoActiveTrajectory(trajectory, splice_time))
   {
-    saveTrajectory(trajectory_msg, jmg->getName() + "_moveit_trajectory_" +
-                                       boost::lexical_cast<std::string>(trajectory_filename_count_++) + ".csv",
-                   save_traj_to_file_path_);
+    ROS_INFO_STREAM_NAMED(name_, "Nothing to splice into, executing trajectory normally");
+    splice = false;
   }
 
-  // Optionally visualize the hand/wrist path in Rviz
-  if (visualize_trajectory_line_)
+  // Optionally visualize in Rviz
   {
-    if (trajectory.points.size() > 1 && !jmg->isEndEffector())
+    ScopedLatencyTimer timer(latency_stats_.getStage(LATENCY_VISUALIZATION));
+
+    // Optionally visualize the hand/wrist path in Rviz
+    if (visualize_trajectory_line_)
     {
-      visual_tools_->deleteAllMarkers();
-      visual_tools_->publishTrajectoryLine(robot_trajectory, jmg, rvt::LIME_GREEN);
-      visual_tools_->trigger();
+      if (trajectory.points.size() > 1 && !jmg->isEndEffector())
+      {
+        visual_tools_->deleteAllMarkers();
+        visual_tools_->publishTrajectoryLine(robot_trajectory, jmg, rvt::LIME_GREEN);
+        visual_tools_->trigger();
+      }
+      else
+        ROS_WARN_STREAM_NAMED(name_, "Not visualizing path because trajectory only has "
+                                         << trajectory.points.size() << " points or because is end effector");
     }
-    else
-      ROS_WARN_STREAM_NAMED(name_, "Not visualizing path because trajectory only has "
-                                       << trajectory.points.size() << " points or because is end effector");
-  }
 
-  // Optionally visualize trajectory in Rviz
-  if (visualize_trajectory_path_)
-  {
-    const bool wait_for_trajetory = false;
-    visual_tools_->publishTrajectoryPath(trajectory_msg, getCurrentState(), wait_for_trajetory);
+    // Optionally visualize trajectory in Rviz
+    if (visualize_trajectory_path_)
+    {
+      const bool wait_for_trajetory = false;
+      visual_tools_->publishTrajectoryPath(trajectory_msg, getCurrentState(), wait_for_trajetory);
+    }
   }
 
   // Optionally check for errors in trajectory
   if (check_for_waypoint_jumps_)
-    checkForWaypointJumps(trajectory);
+  {
+    ScopedLatencyTimer timer(latency_stats_.getStage(LATENCY_VALIDATION));
+    if (!checkForWaypointJumps(trajectory))
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Trajectory failed validation, aborting");
+      return makeExecutionFuture(moveit_controller_manager::ExecutionStatus::FAILED);
+    }
+  }
 
   // Confirm trajectory before continuing
   if (!visual_tools_->getRemoteControl()->getFullAutonomous())
   {
+    ScopedLatencyTimer timer(latency_stats_.getStage(LATENCY_CONFIRMATION));
     visual_tools_->getRemoteControl()->waitForNextFullStep("execute trajectory");
     ROS_INFO_STREAM_NAMED(name_, "Remote confirmed trajectory execution.");
+
+    // Waiting for a person would swamp the time spent in the pipeline itself
+    total_timer.exclude(timer.getElapsed());
+  }
+
+  // The controller would jump to catch up with a splice time in the past
+  if (splice && ros::Time::now() >= splice_time)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Splice time passed before the trajectory could be sent, aborting");
+    return makeExecutionFuture(moveit_controller_manager::ExecutionStatus::FAILED);
   }
 
   // Send new trajectory
-  switch (joint_command_mode_)
+  ExecutionFuture execution;
   {
-    case JOINT_EXECUTION_MANAGER:
-      ROS_INFO_STREAM_NAMED(name_, "Joint execution manager");
+    ScopedLatencyTimer timer(latency_stats_.getStage(LATENCY_SEND));
+    switch (joint_command_mode_)
+    {
+      case JOINT_EXECUTION_MANAGER:
+      {
+        ROS_INFO_STREAM_NAMED(name_, "Joint execution manager");
 
-      // Reset trajectory manager
-      trajectory_execution_manager_->clear();
+        // Preempt the previous trajectory if it is still running, otherwise just reset trajectory manager
+        if (last_execution_.valid() &&
+            last_execution_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+          trajectory_execution_manager_->stopExecution(true);
+        else
+          trajectory_execution_manager_->clear();
 
-      if (trajectory_execution_manager_->pushAndExecute(trajectory_msg))
-      {
-        // Optionally wait for completion
-        if (wait_for_execution)
+        if (!trajectory_execution_manager_->push(trajectory_msg))
         {
-          ros::Duration(trajectory.points.back().time_from_start).sleep();
-          //waitForExecution();
+          visual_tools_->getRemoteControl()->waitForNextFullStep("after execute trajectory 2");
+          ROS_ERROR_STREAM_NAMED(name_, "Failed to execute trajectory");
+          return makeExecutionFuture(moveit_controller_manager::ExecutionStatus::FAILED);
         }
-        else
-          ROS_DEBUG_STREAM_NAMED("exceution_interface", "Not waiting for execution to finish");
-      }
-      else
-      {
-        visual_tools_->getRemoteControl()->waitForNextFullStep("after execute trajectory 2");
-        ROS_ERROR_STREAM_NAMED(name_, "Failed to execute trajectory");
-        return false;
-      }
-      break;
-    case JOINT_PUBLISHER:
-      ROS_INFO_STREAM_NAMED(name_, "Joint publisher");
-      joint_trajectory_pub_.publish(trajectory);
 
-      if (wait_for_execution)
-      {
-        ROS_INFO_STREAM_NAMED(name_, "Sleeping while trajectory executes");
-        ros::Duration(trajectory.points.back().time_from_start).sleep();
+        // The execution manager reports the outcome from its own thread
+        boost::shared_ptr<ExecutionPromise> promise = boost::make_shared<ExecutionPromise>();
+        execution = promise->get_future().share();
+        trajectory_execution_manager_->execute(
+            boost::bind(&ExecutionInterface::executionCompleteCallback, promise, _1));
+        active_trajectory_start_ = ros::Time::now();  // the manager does not report when the controller starts
+        break;
       }
-      break;
-    default:
-      ROS_ERROR_STREAM_NAMED(name_, "Unknown control mode");
+      case JOINT_PUBLISHER:
+        ROS_INFO_STREAM_NAMED(name_, "Joint publisher");
+        // A zero stamp tells the controller to start immediately
+        if (splice)
+          trajectory.header.stamp = splice_time;
+        active_trajectory_start_ = splice ? splice_time : ros::Time::now();
+        execution = monitorExecution(trajectory, active_trajectory_start_);
+        joint_trajectory_pub_.publish(trajectory);
+        active_trajectory_.reset(trajectory_msg_ptr, &trajectory_msg_ptr->joint_trajectory);
+        break;
+      case JOINT_STREAMING:
+        ROS_INFO_STREAM_NAMED(name_, "Joint streaming");
+        trajectory.header.stamp = splice ? splice_time : ros::Time::now();
+        active_trajectory_start_ = trajectory.header.stamp;
+        execution = monitorExecution(trajectory, active_trajectory_start_);
+        streamTrajectory(trajectory_msg_ptr);
+        active_trajectory_.reset(trajectory_msg_ptr, &trajectory_msg_ptr->joint_trajectory);
+        break;
+      default:
+        ROS_ERROR_STREAM_NAMED(name_, "Unknown control mode");
+        return makeExecutionFuture(moveit_controller_manager::ExecutionStatus::FAILED);
+    }
   }
 
-  return true;
+  // Optionally save to file. The message is not modified after this, so the recorder can hold on to it
+  if (save_traj_to_file_)
+  {
+    ScopedLatencyTimer timer(latency_stats_.getStage(LATENCY_SAVE));
+    const std::string label =
+        jmg->getName() + "_moveit_trajectory_" + boost::lexical_cast<std::string>(trajectory_filename_count_++);
+    if (!trajectory_recorder_->record(trajectory_msg_ptr, label))
+      ROS_WARN_STREAM_NAMED(name_, "Trajectory recorder is behind, dropped " << label);
+  }
+
+  last_execution_ = execution;
+  return execution;
 }
 
 bool ExecutionInterface::stopExecution()
 {
   trajectory_msgs::JointTrajectory blank_trajectory;
 
+  // Stop streaming cartesian commands too
+  if (cartesian_streamer_)
+    cartesian_streamer_->clearTarget();
+
   switch (joint_command_mode_)
   {
     case JOINT_EXECUTION_MANAGER:
-      ROS_ERROR_STREAM_NAMED(name_, "Joint execution manager stopping not implemented");
-      // TODO(davetcoleman) Just send a blank trajectory
-      break;
+      ROS_DEBUG_STREAM_NAMED(name_, "Recieved stop motion command");
+      trajectory_execution_manager_->stopExecution(true);
+      return true;
+    case JOINT_STREAMING:
+      // Stop sending windows, then the same as the publisher
+      {
+        boost::mutex::scoped_lock lock(streaming_mutex_);
+        streaming_trajectory_.reset();
+      }
+      streaming_condition_.notify_one();
+    // fall through
     case JOINT_PUBLISHER:
       // Just send a blank trajectory
       ROS_DEBUG_STREAM_NAMED(name_, "Recieved stop motion command");
+      active_trajectory_.reset();
       joint_trajectory_pub_.publish(blank_trajectory);
+      finishMonitoredExecution(moveit_controller_manager::ExecutionStatus::PREEMPTED);
       return true;
       break;
     default:
@@ -279,20 +496,21 @@ bool ExecutionInterface::stopExecution()
 
 bool ExecutionInterface::waitForExecution()
 {
-  if (joint_command_mode_ != JOINT_EXECUTION_MANAGER)
+  if (!last_execution_.valid())
   {
-    ROS_WARN_STREAM_NAMED(name_, "Not waiting for execution because not in execution_manager mode");
+    ROS_WARN_STREAM_NAMED(name_, "Not waiting for execution because no trajectory has been executed");
     return true;
   }
 
-  ROS_DEBUG_STREAM_NAMED(name_, "Waiting for executing trajectory to finish");
-
-  //visual_tools_->getRemoteControl()->waitForNextFullStep("after execute trajectory - TODO, fix this bug");
+  return waitForExecution(last_execution_);
+}
 
+bool ExecutionInterface::waitForExecution(const ExecutionFuture &execution)
+{
+  ROS_DEBUG_STREAM_NAMED(name_, "Waiting for executing trajectory to finish");
 
   // wait for the trajectory to complete
-  moveit_controller_manager::ExecutionStatus execution_status = trajectory_execution_manager_->waitForExecution();
-
+  moveit_controller_manager::ExecutionStatus execution_status = execution.get();
 
   if (execution_status == moveit_controller_manager::ExecutionStatus::SUCCEEDED)
   {
@@ -310,42 +528,261 @@ bool ExecutionInterface::waitForExecution()
   return false;
 }
 
-void ExecutionInterface::checkForWaypointJumps(const trajectory_msgs::JointTrajectory &trajectory)
+ExecutionInterface::ExecutionFuture
+ExecutionInterface::makeExecutionFuture(moveit_controller_manager::ExecutionStatus status)
+{
+  ExecutionPromise promise;
+  promise.set_value(status);
+  return promise.get_future().share();
+}
+
+void ExecutionInterface::executionCompleteCallback(const boost::shared_ptr<ExecutionPromise> &promise,
+                                                   const moveit_controller_manager::ExecutionStatus &status)
+{
+  promise->set_value(status);
+}
+
+ExecutionInterface::ExecutionFuture
+ExecutionInterface::monitorExecution(const trajectory_msgs::JointTrajectory &trajectory,
+                                     const ros::Time &start_time)
+{
+  const robot_model::RobotModelConstPtr &robot_model = planning_scene_monitor_->getRobotModel();
+  ExecutionFuture execution;
+
+  {
+    boost::mutex::scoped_lock lock(execution_mutex_);
+
+    // A new trajectory replaces the one being executed
+    if (execution_active_)
+      execution_promise_.set_value(moveit_controller_manager::ExecutionStatus::PREEMPTED);
+    execution_promise_ = ExecutionPromise();
+    execution = execution_promise_.get_future().share();
+    execution_active_ = true;
+
+    // Remember where the robot should end up
+    execution_goal_indices_.resize(trajectory.joint_names.size());
+    for (std::size_t i = 0; i < trajectory.joint_names.size(); ++i)
+      execution_goal_indices_[i] = robot_model->getVariableIndex(trajectory.joint_names[i]);
+    execution_goal_positions_ = trajectory.points.back().positions;
+    execution_start_ = start_time;
+    execution_expected_end_ = start_time + trajectory.points.back().time_from_start;
+    execution_left_goal_ = false;
+  }
+  execution_condition_.notify_one();
+
+  return execution;
+}
+
+void ExecutionInterface::finishMonitoredExecution(moveit_controller_manager::ExecutionStatus status)
+{
+  boost::mutex::scoped_lock lock(execution_mutex_);
+  if (execution_active_)
+  {
+    execution_promise_.set_value(status);
+    execution_active_ = false;
+  }
+}
+
+void ExecutionInterface::executionMonitorThread()
+{
+  static const int POLL_PERIOD_MS = 10;
+
+  // Only the joint values are compared, so reuse one state instead of copying a new one every poll
+  moveit::core::RobotState monitor_state(planning_scene_monitor_->getRobotModel());
+  std::size_t monitor_state_version = 0;
+
+  boost::mutex::scoped_lock lock(execution_mutex_);
+  while (!execution_shutdown_)
+  {
+    if (!execution_active_)
+    {
+      execution_condition_.wait(lock);
+      continue;
+    }
+
+    // A spliced trajectory does not control the robot until its start time
+    const ros::Time now = ros::Time::now();
+    if (now >= execution_start_)
+    {
+      state_snapshot_->update(monitor_state, monitor_state_version);
+      const double *positions = monitor_state.getVariablePositions();
+
+      bool goal_reached = true;
+      for (std::size_t i = 0; i < execution_goal_indices_.size() && goal_reached; ++i)
+        goal_reached = fabs(positions[execution_goal_indices_[i]] - execution_goal_positions_[i]) <=
+                       goal_position_tolerance_;
+
+      // A trajectory that starts at its goal, e.g. a round trip, is not done until the robot has moved away
+      if (!goal_reached)
+        execution_left_goal_ = true;
+
+      // The robot may get there before the trajectory's duration is up
+      if (goal_reached && (execution_left_goal_ || now >= execution_expected_end_))
+      {
+        execution_promise_.set_value(moveit_controller_manager::ExecutionStatus::SUCCEEDED);
+        execution_active_ = false;
+        continue;
+      }
+
+      // The robot never got there, e.g. it was blocked or the controller dropped the trajectory
+      if (now > execution_expected_end_ + ros::Duration(goal_timeout_margin_))
+      {
+        ROS_ERROR_STREAM_NAMED(name_, "Joint states did not reach the end of the trajectory within "
+                                          << goal_position_tolerance_ << " of the goal");
+        execution_promise_.set_value(moveit_controller_manager::ExecutionStatus::TIMED_OUT);
+        execution_active_ = false;
+        continue;
+      }
+    }
+
+    // Wakes up early if the trajectory is replaced or stopped
+    execution_condition_.timed_wait(lock, boost::posix_time::milliseconds(POLL_PERIOD_MS));
+  }
+
+  // Do not leave anyone waiting
+  if (execution_active_)
+    execution_promise_.set_value(moveit_controller_manager::ExecutionStatus::PREEMPTED);
+  execution_active_ = false;
+}
+
+bool ExecutionInterface::isAtCurrentState(const robot_trajectory::RobotTrajectory &robot_trajectory,
+                                          JointModelGroup *jmg)
 {
-  // Debug: check for errors in trajectory
-  static const double MAX_TIME_STEP_SEC = 4.0;
-  ros::Duration max_time_step(MAX_TIME_STEP_SEC);
-  static const double WARN_TIME_STEP_SEC = 3.0;
-  ros::Duration warn_time_step(WARN_TIME_STEP_SEC);
-  ros::Duration diff;
-  for (std::size_t i = 0; i < trajectory.points.size() - 1; ++i)
+  if (robot_trajectory.empty())
+    return false;
+
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+
+  // Moving trajectories almost always differ at the last waypoint, so check it first
+  if (!active_variables_.statesEqual(robot_trajectory.getLastWayPoint(), *current_state, jmg))
+    return false;
+
+  for (std::size_t i = 0; i < robot_trajectory.getWayPointCount(); ++i)
+    if (!active_variables_.statesEqual(robot_trajectory.getWayPoint(i), *current_state, jmg))
+      return false;
+
+  return true;
+}
+
+bool ExecutionInterface::checkForWaypointJumps(const trajectory_msgs::JointTrajectory &trajectory)
+{
+  const bool valid = trajectory_validator_->validate(trajectory, validation_report_);
+
+  for (std::size_t i = 0; i < validation_report_.violations_.size(); ++i)
+  {
+    const TrajectoryViolation &violation = validation_report_.violations_[i];
+    std::stringstream message;
+    message << "Trajectory " << TrajectoryValidator::typeToString(violation.type_) << " check failed at point "
+            << violation.point_;
+    if (violation.type_ == TrajectoryViolation::POSITION_JUMP ||
+        violation.type_ == TrajectoryViolation::VELOCITY_LIMIT ||
+        violation.type_ == TrajectoryViolation::ACCELERATION_LIMIT)
+      message << " of joint " << trajectory.joint_names[violation.joint_];
+    message << ": " << violation.value_ << " (limit " << violation.limit_ << ")";
+
+    if (violation.error_)
+      ROS_ERROR_STREAM_NAMED(name_, message.str());
+    else
+      ROS_WARN_STREAM_NAMED(name_, message.str());
+  }
+
+  if (!valid)
   {
-    diff = (trajectory.points[i + 1].time_from_start - trajectory.points[i].time_from_start);
-    if (diff > max_time_step)
+    // This trajectory is not sent. Pause autonomy so the next motion waits for confirmation after a planning bug
+    visual_tools_->getRemoteControl()->setAutonomous(false);
+    visual_tools_->getRemoteControl()->setFullAutonomous(false);
+  }
+
+  return valid;
+}
+
+void ExecutionInterface::streamTrajectory(const boost::shared_ptr<moveit_msgs::RobotTrajectory> &trajectory_msg)
+{
+  // Keeps the pooled message in use until streaming is done
+  boost::shared_ptr<trajectory_msgs::JointTrajectory> streamed(trajectory_msg, &trajectory_msg->joint_trajectory);
+
+  // Every window shares this time reference so the controller splices them into one continuous trajectory
+  if (streamed->header.stamp.isZero())
+    streamed->header.stamp = ros::Time::now();
+
+  {
+    boost::mutex::scoped_lock lock(streaming_mutex_);
+
+    // When spliced in later, make sure the controller has points of the previous trajectory until then
+    if (streaming_trajectory_)
+    {
+      const trajectory_msgs::JointTrajectory &previous = *streaming_trajectory_;
+      const ros::Duration uncovered = streamed->header.stamp - previous.header.stamp -
+                                      previous.points[streaming_next_point_].time_from_start;
+      if (uncovered > ros::Duration(0))
+        publishStreamingWindow(previous, streaming_next_point_, uncovered.toSec());
+    }
+
+    // A short first window lets the controller start moving right away
+    streaming_next_point_ = publishStreamingWindow(*streamed, 0, streaming_first_window_);
+    ROS_DEBUG_STREAM_NAMED(name_ + ".streaming", "Sent first window with " << streaming_next_point_ + 1 << " of "
+                                                                           << streamed->points.size() << " points");
+
+    // Replaces any trajectory still being streamed
+    if (streaming_next_point_ + 1 < streamed->points.size())
+      streaming_trajectory_ = streamed;
+    else
+      streaming_trajectory_.reset();
+  }
+  streaming_condition_.notify_one();
+}
+
+std::size_t ExecutionInterface::publishStreamingWindow(const trajectory_msgs::JointTrajectory &trajectory,
+                                                       std::size_t begin, double duration)
+{
+  // Always send at least one segment
+  const std::size_t last = trajectory.points.size() - 1;
+  const ros::Duration window_end = trajectory.points[begin].time_from_start + ros::Duration(duration);
+  std::size_t end = std::min(begin + 1, last);
+  while (end < last && trajectory.points[end + 1].time_from_start <= window_end)
+    ++end;
+
+  // The window overlaps the previous one by its first point, which is where the controller splices it in
+  streaming_window_msg_.header = trajectory.header;
+  streaming_window_msg_.joint_names = trajectory.joint_names;
+  streaming_window_msg_.points.assign(trajectory.points.begin() + begin, trajectory.points.begin() + end + 1);
+  joint_trajectory_pub_.publish(streaming_window_msg_);
+
+  return end;
+}
+
+void ExecutionInterface::streamingThread()
+{
+  static const int POLL_PERIOD_MS = 10;
+
+  boost::mutex::scoped_lock lock(streaming_mutex_);
+  while (!streaming_shutdown_)
+  {
+    if (!streaming_trajectory_)
     {
-      ROS_ERROR_STREAM_NAMED(
-          name_, "Max time step between points exceeded, likely because of wrap around/IK bug. Point " << i);
-      std::cout << "First time: " << trajectory.points[i].time_from_start.toSec() << std::endl;
-      std::cout << "Next time: " << trajectory.points[i + 1].time_from_start.toSec() << std::endl;
-      std::cout << "Diff time: " << diff.toSec() << std::endl;
-      std::cout << "-------------------------------------------------------" << std::endl;
-      std::cout << std::endl;
-
-      visual_tools_->getRemoteControl()->setAutonomous(false);
-      visual_tools_->getRemoteControl()->setFullAutonomous(false);
-
-      // return false;
+      streaming_condition_.wait(lock);
+      continue;
     }
-    else if (diff > warn_time_step)
+
+    // Send the next window shortly before the controller reaches the end of the previous one
+    const trajectory_msgs::JointTrajectory &trajectory = *streaming_trajectory_;
+    const ros::Time send_time = trajectory.header.stamp + trajectory.points[streaming_next_point_].time_from_start -
+                                ros::Duration(streaming_lead_time_);
+    const double remaining = (send_time - ros::Time::now()).toSec();
+    if (remaining > 0)
     {
-      ROS_WARN_STREAM_NAMED(
-          name_, "Warn time step between points exceeded, likely because of wrap around/IK bug. Point " << i);
-      std::cout << "First time: " << trajectory.points[i].time_from_start.toSec() << std::endl;
-      std::cout << "Next time: " << trajectory.points[i + 1].time_from_start.toSec() << std::endl;
-      std::cout << "Diff time: " << diff.toSec() << std::endl;
-      std::cout << "-------------------------------------------------------" << std::endl;
-      std::cout << std::endl;
+      // The condition variable waits in wall time, so wake up regularly and compare in ROS time, which follows
+      // /use_sim_time. Wakes up early if the trajectory is replaced or stopped
+      const int wait_ms = std::min<int>(POLL_PERIOD_MS, std::ceil(remaining * 1000));
+      streaming_condition_.timed_wait(lock, boost::posix_time::milliseconds(wait_ms));
+      continue;
     }
+
+    streaming_next_point_ = publishStreamingWindow(trajectory, streaming_next_point_, streaming_window_);
+    ROS_DEBUG_STREAM_NAMED(name_ + ".streaming", "Sent window ending at point " << streaming_next_point_);
+
+    if (streaming_next_point_ + 1 >= trajectory.points.size())
+      streaming_trajectory_.reset();  // done
   }
 }
 
@@ -442,6 +879,102 @@ bool ExecutionInterface::checkTrajectoryController(ros::ServiceClient &service_c
   return true;
 }
 
+void ExecutionInterface::convertToTrajectoryMsg(const robot_trajectory::RobotTrajectory &robot_trajectory,
+                                                moveit_msgs::RobotTrajectory &trajectory_msg)
+{
+  // Without a group every joint of the robot is converted
+  const moveit::core::JointModelGroup *jmg = robot_trajectory.getGroup();
+  if (!jmg)
+  {
+    robot_trajectory.getRobotTrajectoryMsg(trajectory_msg);
+    return;
+  }
+  const std::vector<const moveit::core::JointModel *> &joints = jmg->getActiveJointModels();
+
+  // Cache where each active joint is in the robot state
+  if (conversion_group_name_ != jmg->getName())
+  {
+    conversion_indices_.clear();
+    for (std::size_t j = 0; j < joints.size(); ++j)
+    {
+      if (joints[j]->getVariableCount() != 1)
+      {
+        ROS_WARN_STREAM_NAMED(name_, "Joint " << joints[j]->getName() << " has multiple variables, using "
+                                                                         "getRobotTrajectoryMsg()");
+        conversion_indices_.clear();
+        break;
+      }
+      conversion_indices_.push_back(joints[j]->getFirstVariableIndex());
+    }
+    conversion_group_name_ = jmg->getName();
+  }
+  if (conversion_indices_.size() != joints.size())
+  {
+    robot_trajectory.getRobotTrajectoryMsg(trajectory_msg);
+    return;
+  }
+
+  trajectory_msgs::JointTrajectory &trajectory = trajectory_msg.joint_trajectory;
+  const std::size_t num_joints = conversion_indices_.size();
+  const std::size_t num_points = robot_trajectory.getWayPointCount();
+
+  trajectory.header.stamp = ros::Time(0);
+  trajectory.header.frame_id = robot_trajectory.getRobotModel()->getModelFrame();
+  trajectory.joint_names = jmg->getActiveJointModelNames();  // reuses the existing strings
+  trajectory.points.resize(num_points);
+  trajectory_msg.multi_dof_joint_trajectory.joint_names.clear();
+  trajectory_msg.multi_dof_joint_trajectory.points.clear();
+
+  double time_from_start = 0;
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    const moveit::core::RobotState &waypoint = robot_trajectory.getWayPoint(i);
+    trajectory_msgs::JointTrajectoryPoint &point = trajectory.points[i];
+
+    const double *positions = waypoint.getVariablePositions();
+    point.positions.resize(num_joints);
+    for (std::size_t j = 0; j < num_joints; ++j)
+      point.positions[j] = positions[conversion_indices_[j]];
+
+    if (waypoint.hasVelocities())
+    {
+      const double *velocities = waypoint.getVariableVelocities();
+      point.velocities.resize(num_joints);
+      for (std::size_t j = 0; j < num_joints; ++j)
+        point.velocities[j] = velocities[conversion_indices_[j]];
+    }
+    else
+      point.velocities.clear();
+
+    if (waypoint.hasAccelerations())
+    {
+      const double *accelerations = waypoint.getVariableAccelerations();
+      point.accelerations.resize(num_joints);
+      for (std::size_t j = 0; j < num_joints; ++j)
+        point.accelerations[j] = accelerations[conversion_indices_[j]];
+    }
+    else
+      point.accelerations.clear();
+
+    point.effort.clear();
+
+    time_from_start += robot_trajectory.getWayPointDurationFromPrevious(i);
+    point.time_from_start.fromSec(time_from_start);
+  }
+}
+
+boost::shared_ptr<moveit_msgs::RobotTrajectory> ExecutionInterface::acquireTrajectoryMsg()
+{
+  for (std::size_t i = 0; i < trajectory_msg_pool_.size(); ++i)
+    if (trajectory_msg_pool_[i].unique())
+      return trajectory_msg_pool_[i];
+
+  // Everything is still being streamed or recorded
+  trajectory_msg_pool_.push_back(boost::shared_ptr<moveit_msgs::RobotTrajectory>(new moveit_msgs::RobotTrajectory()));
+  ROS_DEBUG_STREAM_NAMED(name_, "Trajectory message pool grown to " << trajectory_msg_pool_.size());
+  return trajectory_msg_pool_.back();
+}
+
 bool ExecutionInterface::saveTrajectory(const moveit_msgs::RobotTrajectory &trajectory_msg,
                                         const std::string &file_name, const std::string &save_traj_to_file_path)
 {
@@ -499,11 +1032,187 @@ bool ExecutionInterface::saveTrajectory(const moveit_msgs::RobotTrajectory &traj
   return true;
 }
 
+bool ExecutionInterface::spliceIntoActiveTrajectory(trajectory_msgs::JointTrajectory &trajectory,
+                                                    const ros::Time &splice_time)
+{
+  if (!active_trajectory_)
+    return false;
+  const trajectory_msgs::JointTrajectory &active = *active_trajectory_;
+
+  // Commanded state of the active trajectory at the splice time
+  sampleTrajectory(active, (splice_time - active_trajectory_start_).toSec(), splice_positions_, splice_velocities_,
+                   splice_accelerations_);
+
+  // Offset between the two trajectories for each joint of the new one, kept in the sampled buffers
+  const std::size_t num_joints = trajectory.joint_names.size();
+  splice_offsets_.resize(3 * num_joints);
+  double *position_offsets = &splice_offsets_[0];
+  double *velocity_offsets = position_offsets + num_joints;
+  double *acceleration_offsets = velocity_offsets + num_joints;
+  const trajectory_msgs::JointTrajectoryPoint &first = trajectory.points.front();
+  for (std::size_t j = 0; j < num_joints; ++j)
+  {
+    const std::vector<std::string>::const_iterator it =
+        std::find(active.joint_names.begin(), active.joint_names.end(), trajectory.joint_names[j]);
+    if (it == active.joint_names.end())
+    {
+      ROS_WARN_STREAM_NAMED(name_, "Joint " << trajectory.joint_names[j] << " is not in the active trajectory");
+      return false;
+    }
+    const std::size_t k = it - active.joint_names.begin();
+    position_offsets[j] = splice_positions_[k] - first.positions[j];
+    velocity_offsets[j] = splice_velocities_[k] - (first.velocities.empty() ? 0.0 : first.velocities[j]);
+    acceleration_offsets[j] = splice_accelerations_[k] - (first.accelerations.empty() ? 0.0 : first.accelerations[j]);
+  }
+
+  // Fade the offsets out with a quintic, so position, velocity and acceleration are continuous at both ends
+  const double blend = std::min(splice_blend_duration_, trajectory.points.back().time_from_start.toSec());
+  for (std::size_t i = 0; i < trajectory.points.size(); ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint &point = trajectory.points[i];
+    const double t = point.time_from_start.toSec();
+    if (t >= blend && i > 0)
+      break;
+
+    const SpliceBlendWeights weights(t, blend);
+    for (std::size_t j = 0; j < num_joints; ++j)
+    {
+      point.positions[j] += weights.position(position_offsets[j], velocity_offsets[j], acceleration_offsets[j]);
+      if (!point.velocities.empty())
+        point.velocities[j] += weights.velocity(position_offsets[j], velocity_offsets[j], acceleration_offsets[j]);
+      if (!point.accelerations.empty())
+        point.accelerations[j] +=
+            weights.acceleration(position_offsets[j], velocity_offsets[j], acceleration_offsets[j]);
+    }
+  }
+
+  ROS_DEBUG_STREAM_NAMED(name_, "Spliced trajectory into the active one at "
+                                    << (splice_time - active_trajectory_start_).toSec() << "s");
+  return true;
+}
+
+void ExecutionInterface::sampleTrajectory(const trajectory_msgs::JointTrajectory &trajectory, double time,
+                                          std::vector<double> &positions, std::vector<double> &velocities,
+                                          std::vector<double> &accelerations)
+{
+  const std::vector<trajectory_msgs::JointTrajectoryPoint> &points = trajectory.points;
+  const std::size_t num_joints = trajectory.joint_names.size();
+  positions.resize(num_joints);
+  velocities.resize(num_joints);
+  accelerations.resize(num_joints);
+
+  // Before the start or after the end
+  if (time <= points.front().time_from_start.toSec() || points.size() == 1)
+  {
+    positions = points.front().positions;
+    if (points.front().velocities.empty() || points.size() == 1)
+      std::fill(velocities.begin(), velocities.end(), 0.0);
+    else
+      velocities = points.front().velocities;
+    if (points.front().accelerations.empty() || points.size() == 1)
+      std::fill(accelerations.begin(), accelerations.end(), 0.0);
+    else
+      accelerations = points.front().accelerations;
+    return;
+  }
+  if (time >= points.back().time_from_start.toSec())
+  {
+    positions = points.back().positions;
+    std::fill(velocities.begin(), velocities.end(), 0.0);
+    std::fill(accelerations.begin(), accelerations.end(), 0.0);
+    return;
+  }
+
+  // Segment containing time
+  std::size_t k = 0;
+  while (points[k + 1].time_from_start.toSec() <= time)
+    ++k;
+  const trajectory_msgs::JointTrajectoryPoint &p0 = points[k];
+  const trajectory_msgs::JointTrajectoryPoint &p1 = points[k + 1];
+  const double duration = p1.time_from_start.toSec() - p0.time_from_start.toSec();
+  const double t = time - p0.time_from_start.toSec();
+  const double s = t / duration;
+
+  if (p0.velocities.empty() || p1.velocities.empty())
+  {
+    for (std::size_t j = 0; j < num_joints; ++j)
+    {
+      positions[j] = p0.positions[j] + s * (p1.positions[j] - p0.positions[j]);
+      velocities[j] = (p1.positions[j] - p0.positions[j]) / duration;
+      accelerations[j] = 0;
+    }
+    return;
+  }
+
+  // Quintic through both points' accelerations, like ros_control's joint_trajectory_controller
+  if (!p0.accelerations.empty() && !p1.accelerations.empty())
+  {
+    const double T = duration;
+    const double T2 = T * T;
+    const double T3 = T2 * T;
+    for (std::size_t j = 0; j < num_joints; ++j)
+    {
+      const double q0 = p0.positions[j], q1 = p1.positions[j];
+      const double v0 = p0.velocities[j], v1 = p1.velocities[j];
+      const double a0 = p0.accelerations[j], a1 = p1.accelerations[j];
+      const double c3 = (-20 * q0 + 20 * q1 - 3 * a0 * T2 + a1 * T2 - 12 * v0 * T - 8 * v1 * T) / (2 * T3);
+      const double c4 = (30 * q0 - 30 * q1 + 3 * a0 * T2 - 2 * a1 * T2 + 16 * v0 * T + 14 * v1 * T) / (2 * T3 * T);
+      const double c5 = (-12 * q0 + 12 * q1 - a0 * T2 + a1 * T2 - 6 * v0 * T - 6 * v1 * T) / (2 * T3 * T2);
+      positions[j] = q0 + t * (v0 + t * (0.5 * a0 + t * (c3 + t * (c4 + t * c5))));
+      velocities[j] = v0 + t * (a0 + t * (3 * c3 + t * (4 * c4 + t * 5 * c5)));
+      accelerations[j] = a0 + t * (6 * c3 + t * (12 * c4 + t * 20 * c5));
+    }
+    return;
+  }
+
+  // Cubic Hermite basis
+  const double s2 = s * s;
+  const double s3 = s2 * s;
+  const double h00 = 2 * s3 - 3 * s2 + 1;
+  const double h10 = s3 - 2 * s2 + s;
+  const double h01 = -2 * s3 + 3 * s2;
+  const double h11 = s3 - s2;
+  for (std::size_t j = 0; j < num_joints; ++j)
+  {
+    positions[j] = h00 * p0.positions[j] + h10 * duration * p0.velocities[j] + h01 * p1.positions[j] +
+                   h11 * duration * p1.velocities[j];
+    velocities[j] = (6 * s2 - 6 * s) / duration * (p0.positions[j] - p1.positions[j]) +
+                    (3 * s2 - 4 * s + 1) * p0.velocities[j] + (3 * s2 - 2 * s) * p1.velocities[j];
+    accelerations[j] = (12 * s - 6) / (duration * duration) * (p0.positions[j] - p1.positions[j]) +
+                       ((6 * s - 4) * p0.velocities[j] + (6 * s - 2) * p1.velocities[j]) / duration;
+  }
+}
+
+void ExecutionInterface::publishLatencyStats(const ros::TimerEvent &event)
+{
+  diagnostic_msgs::DiagnosticArray diagnostics;
+  diagnostics.header.stamp = ros::Time::now();
+  diagnostics.status.resize(cartesian_streamer_ ? 2 : 1);
+  diagnostics.status[0].name = name_ + ": latency";
+  diagnostics.status[0].level = diagnostic_msgs::DiagnosticStatus::OK;
+  latency_stats_.getDiagnostics(diagnostics.status[0]);
+  if (cartesian_streamer_)
+  {
+    diagnostics.status[1].name = name_ + ": cartesian streaming";
+    diagnostics.status[1].level = diagnostic_msgs::DiagnosticStatus::OK;
+    cartesian_streamer_->getDiagnostics(diagnostics.status[1]);
+  }
+  latency_stats_pub_.publish(diagnostics);
+}
+
+bool ExecutionInterface::dumpLatencyStats(std_srvs::Trigger::Request &request, std_srvs::Trigger::Response &response)
+{
+  response.message = latency_stats_.toString();
+  if (cartesian_streamer_)
+    response.message += "\nCartesian streaming:\n" + cartesian_streamer_->toString();
+  response.success = true;
+  ROS_INFO_STREAM_NAMED(name_, "Execution latency:\n" << response.message);
+  return true;
+}
+
 moveit::core::RobotStatePtr ExecutionInterface::getCurrentState()
 {
-  // Get the real current state
-  psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-  (*current_state_) = scene->getCurrentState();
+  state_snapshot_->update(current_state_, current_state_version_, current_scene_version_);
   return current_state_;
 }
 
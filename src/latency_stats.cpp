@@ -0,0 +1,168 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Low overhead latency histograms for timing stages of a pipeline
+*/
+
+// C++
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// this package
+#include <moveit_boilerplate/latency_stats.h>
+
+namespace moveit_boilerplate
+{
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration duration)
+{
+  const std::int64_t signed_us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  const std::uint64_t us = signed_us > 0 ? signed_us : 0;
+
+  // floor(log2(us)), with 0 and 1 microseconds sharing the first bucket
+  std::size_t bucket = 63 - __builtin_clzll(us | 1);
+  if (bucket >= NUM_BUCKETS)
+    bucket = NUM_BUCKETS - 1;
+
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_us_.fetch_add(us, std::memory_order_relaxed);
+
+  std::uint64_t max_us = max_us_.load(std::memory_order_relaxed);
+  while (us > max_us && !max_us_.compare_exchange_weak(max_us, us, std::memory_order_relaxed))
+  {
+  }
+}
+
+std::size_t LatencyHistogram::getCount() const
+{
+  return count_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const
+{
+  const std::uint64_t count = count_.load(std::memory_order_relaxed);
+  return count ? 1e-6 * total_us_.load(std::memory_order_relaxed) / count : 0.0;
+}
+
+double LatencyHistogram::getMax() const
+{
+  return 1e-6 * max_us_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getPercentile(double fraction) const
+{
+  const std::uint64_t count = count_.load(std::memory_order_relaxed);
+  if (!count)
+    return 0.0;
+
+  const double target = fraction * count;
+  std::uint64_t cumulative = 0;
+  for (std::size_t b = 0; b < NUM_BUCKETS; ++b)
+  {
+    cumulative += buckets_[b].load(std::memory_order_relaxed);
+    if (cumulative >= target)
+      return std::min(1e-6 * (std::uint64_t(2) << b), getMax());
+  }
+  return getMax();
+}
+
+void LatencyHistogram::reset()
+{
+  for (std::size_t b = 0; b < NUM_BUCKETS; ++b)
+    buckets_[b].store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  total_us_.store(0, std::memory_order_relaxed);
+  max_us_.store(0, std::memory_order_relaxed);
+}
+
+LatencyStats::LatencyStats(const std::vector<std::string> &stage_names) : stage_names_(stage_names)
+{
+  for (std::size_t i = 0; i < stage_names_.size(); ++i)
+    histograms_.push_back(boost::shared_ptr<LatencyHistogram>(new LatencyHistogram()));
+}
+
+void LatencyStats::getDiagnostics(diagnostic_msgs::DiagnosticStatus &status) const
+{
+  status.values.clear();
+  for (std::size_t i = 0; i < stage_names_.size(); ++i)
+  {
+    const LatencyHistogram &histogram = *histograms_[i];
+    const std::string &stage = stage_names_[i];
+    const std::string suffixes[] = { " count", " mean ms", " p50 ms", " p99 ms", " max ms" };
+    const double values[] = { double(histogram.getCount()), 1e3 * histogram.getMean(),
+                              1e3 * histogram.getPercentile(0.5), 1e3 * histogram.getPercentile(0.99),
+                              1e3 * histogram.getMax() };
+    for (std::size_t k = 0; k < 5; ++k)
+    {
+      diagnostic_msgs::KeyValue key_value;
+      key_value.key = stage + suffixes[k];
+      std::stringstream value;
+      value << values[k];
+      key_value.value = value.str();
+      status.values.push_back(key_value);
+    }
+  }
+}
+
+std::string LatencyStats::toString() const
+{
+  std::stringstream table;
+  table << std::left << std::setw(16) << "stage" << std::right << std::setw(10) << "count" << std::setw(12)
+        << "mean ms" << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms" << std::setw(12) << "max ms"
+        << std::endl;
+  table << std::fixed << std::setprecision(3);
+  for (std::size_t i = 0; i < stage_names_.size(); ++i)
+  {
+    const LatencyHistogram &histogram = *histograms_[i];
+    table << std::left << std::setw(16) << stage_names_[i] << std::right << std::setw(10) << histogram.getCount()
+          << std::setw(12) << 1e3 * histogram.getMean() << std::setw(12) << 1e3 * histogram.getPercentile(0.5)
+          << std::setw(12) << 1e3 * histogram.getPercentile(0.99) << std::setw(12) << 1e3 * histogram.getMax()
+          << std::endl;
+  }
+  return table.str();
+}
+
+void LatencyStats::reset()
+{
+  for (std::size_t i = 0; i < histograms_.size(); ++i)
+    histograms_[i]->reset();
+}
+
+}  // namespace moveit_boilerplate
@@ -86,11 +86,8 @@ bool MoveItBase::init(ros::NodeHandle& nh)
     ROS_ERROR_STREAM_NAMED(name_, "Unable to load planning scene monitor");
   }
 
-  // Create initial robot state
-  {
-    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-    current_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
-  }  // end scoped pointer of locked planning scene
+  // One source of the current state for every component, so the monitor only copies it once per update
+  state_snapshot_.reset(new CurrentStateSnapshot(planning_scene_monitor_));
 
   // Load the Robot Viz Tools for publishing to Rviz
   loadVisualTools(rviz_markers_topic, rviz_robot_state_topic, rviz_trajectory_topic);
@@ -180,6 +177,8 @@ bool MoveItBase::showJointLimits(JointModelGroup* jmg)
 
   std::cout << std::endl;
 
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+
   // Loop through joints
   for (std::size_t i = 0; i < joints.size(); ++i)
   {
@@ -189,11 +188,10 @@ bool MoveItBase::showJointLimits(JointModelGroup* jmg)
       ROS_ERROR_STREAM_NAMED(name_, "Unable to handle joints with more than one var");
       return false;
     }
-    getCurrentState();
-    double current_value = current_state_->getVariablePosition(joints[i]->getName());
+    double current_value = current_state->getVariablePosition(joints[i]->getName());
 
     // check if bad position
-    bool out_of_bounds = !current_state_->satisfiesBounds(joints[i]);
+    bool out_of_bounds = !current_state->satisfiesBounds(joints[i]);
 
     const moveit::core::VariableBounds& bound = joints[i]->getVariableBounds()[0];
 
@@ -230,9 +228,7 @@ bool MoveItBase::showJointLimits(JointModelGroup* jmg)
 
 moveit::core::RobotStatePtr MoveItBase::getCurrentState()
 {
-  // Get the real current state
-  psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-  (*current_state_) = scene->getCurrentState();
+  state_snapshot_->update(current_state_, current_state_version_, current_scene_version_);
   return current_state_;
 }
 
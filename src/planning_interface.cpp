@@ -38,7 +38,9 @@
 
 // C++
 #include <string>
-// #include <algorithm>
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <vector>
 
 #include <moveit_boilerplate/planning_interface.h>
@@ -50,16 +52,21 @@
 // ROS parameter loading
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
 
+// Boost
+#include <boost/bind.hpp>
+
 namespace moveit_boilerplate
 {
 PlanningInterface::PlanningInterface(psm::PlanningSceneMonitorPtr planning_scene_monitor,
                                      mvt::MoveItVisualToolsPtr visual_tools, JointModelGroup* arm_jmg,
-                                     moveit_boilerplate::ExecutionInterfacePtr execution_interface)
+                                     moveit_boilerplate::ExecutionInterfacePtr execution_interface,
+                                     CurrentStateSnapshotPtr state_snapshot)
   : nh_("~")
   , planning_scene_monitor_(planning_scene_monitor)
   , visual_tools_(visual_tools)
   , arm_jmg_(arm_jmg)
   , execution_interface_(execution_interface)
+  , state_snapshot_(state_snapshot)
 {
   // Load rosparams
   // ros::NodeHandle rosparam_nh(nh_, parent_name);
@@ -84,14 +91,62 @@ PlanningInterface::PlanningInterface(psm::PlanningSceneMonitorPtr planning_scene
                                     "moveit_config/kinamatics.yaml is loaded in this namespace");
   }
 
-  // Create initial robot state
+  // Set robot model
+  robot_model_ = planning_scene_monitor_->getRobotModel();
+
+  // Interpolated waypoints are taken from here
+  state_pool_.reset(new RobotStatePool(robot_model_));
+
+  // Load rosparams
+  int interpolation_threads = 1;
+  int parallel_interpolation_min_states = 200;
+  std::string time_parameterization = IterativeParabolicParameterization::NAME;
+  double max_jerk = JerkLimitedParameterization::DEFAULT_MAX_JERK;
+  int ik_threads = 1;
+  int trajectory_cache_size = 0;
+  double trajectory_cache_quantization = 0.01;
+  std::string waypoint_density = "fixed";
+  double max_cartesian_deviation = 0.05;
+  double max_segment_duration = 0.25;
+  int parallel_validation_min_states = 200;
+  ros::NodeHandle rpnh(nh_, name_);
+  rpnh.param("interpolation_threads", interpolation_threads, interpolation_threads);
+  rpnh.param("parallel_interpolation_min_states", parallel_interpolation_min_states, parallel_interpolation_min_states);
+  rpnh.param("time_parameterization", time_parameterization, time_parameterization);
+  rpnh.param("max_jerk", max_jerk, max_jerk);
+  rpnh.param("ik_threads", ik_threads, ik_threads);
+  rpnh.param("trajectory_cache_size", trajectory_cache_size, trajectory_cache_size);
+  rpnh.param("trajectory_cache_quantization", trajectory_cache_quantization, trajectory_cache_quantization);
+  rpnh.param("waypoint_density", waypoint_density, waypoint_density);
+  rpnh.param("longest_valid_segment_fraction", longest_valid_segment_fraction_, longest_valid_segment_fraction_);
+  rpnh.param("max_cartesian_deviation", max_cartesian_deviation, max_cartesian_deviation);
+  rpnh.param("max_segment_duration", max_segment_duration, max_segment_duration);
+  rpnh.param("validate_before_execution", validate_before_execution_, validate_before_execution_);
+  rpnh.param("parallel_validation_min_states", parallel_validation_min_states, parallel_validation_min_states);
+
+  time_parameterization_ = createTimeParameterization(time_parameterization, max_jerk);
+  if (!time_parameterization_)
   {
-    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-    current_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
-  }  // end scoped pointer of locked planning scene
+    ROS_ERROR_STREAM_NAMED(name_, "Falling back to " << IterativeParabolicParameterization::NAME);
+    time_parameterization_.reset(new IterativeParabolicParameterization());
+  }
+  parallel_interpolation_min_states_ = std::max(0, parallel_interpolation_min_states);
+  parallel_validation_min_states_ = std::max(0, parallel_validation_min_states);
 
-  // Set robot model
-  robot_model_ = current_state_->getRobotModel();
+  // Negative uses one thread per core
+  if (interpolation_threads < 0 || interpolation_threads > 1)
+    interpolation_pool_.reset(new ThreadPool(std::max(0, interpolation_threads)));
+  if (ik_threads < 0 || ik_threads > 1)
+    ik_pool_.reset(new ThreadPool(std::max(0, ik_threads)));
+
+  if (waypoint_density == "adaptive")
+    waypoint_density_.reset(new WaypointDensity(max_cartesian_deviation, max_segment_duration));
+  else if (waypoint_density != "fixed")
+    ROS_ERROR_STREAM_NAMED(name_, "Unknown waypoint_density '" << waypoint_density << "', using fixed");
+
+  // Zero disables caching of SRDF pose trajectories
+  if (trajectory_cache_size > 0)
+    trajectory_cache_.reset(new TrajectoryCache(trajectory_cache_size, trajectory_cache_quantization));
 
   ROS_INFO_STREAM_NAMED(name_, "PlanningInterface Ready.");
 }
@@ -103,51 +158,98 @@ PlanningInterface::~PlanningInterface()
 bool PlanningInterface::moveToSRDFPoseNoPlan(JointModelGroup* jmg, const std::string& pose_name,
                                              double velocity_scaling_factor, const bool wait_for_execution)
 {
-  // Set goal state to initial pose
-  moveit::core::RobotStatePtr goal_state(new moveit::core::RobotState(*current_state_));
-  if (!goal_state->setToDefaultValues(jmg, pose_name))
+  // Get the start state
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+
+  // Reuse the trajectory of an earlier move from the same start state
+  const std::size_t scene_version = state_snapshot_->getSceneVersion();
+  robot_trajectory::RobotTrajectoryPtr robot_traj;
+  if (trajectory_cache_)
+    robot_traj = trajectory_cache_->lookup(*current_state, jmg, pose_name, velocity_scaling_factor, scene_version);
+
+  if (!robot_traj)
   {
-    ROS_ERROR_STREAM_NAMED(name_, "Failed to set pose '" << pose_name << "' for planning group '" << jmg->getName()
-                                                         << "'");
-    return false;
-  }
+    // Set goal state to initial pose
+    moveit::core::RobotStatePtr goal_state(new moveit::core::RobotState(*current_state));
+    if (!goal_state->setToDefaultValues(jmg, pose_name))
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Failed to set pose '" << pose_name << "' for planning group '" << jmg->getName()
+                                                           << "'");
+      return false;
+    }
+
+    // Check if already in new position
+    if (statesEqual(*current_state, *goal_state, jmg))
+    {
+      ROS_INFO_STREAM_NAMED(name_, "Not executing because current state and goal state are "
+                                   "close enough.");
+      return true;
+    }
+
+    robot_traj.reset(new robot_trajectory::RobotTrajectory(robot_model_, jmg));
+    if (!computeTrajectoryToState(jmg, *current_state, *goal_state, velocity_scaling_factor, robot_traj))
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Unable to execute state of SRDF pose");
+      return false;
+    }
 
-  if (!executeState(jmg, goal_state, velocity_scaling_factor, wait_for_execution))
+    if (trajectory_cache_)
+      trajectory_cache_->insert(*current_state, jmg, pose_name, velocity_scaling_factor, scene_version, robot_traj);
+  }
+  else
   {
-    ROS_ERROR_STREAM_NAMED(name_, "Unable to execute state of SRDF pose");
-    return false;
+    ROS_DEBUG_STREAM_NAMED(name_ + ".trajectory_cache", "Reusing cached trajectory to '" << pose_name << "'");
+
+    // The scene version only tracks geometry updates of the monitor, so check the scene still allows the motion.
+    // Cached trajectories were validated when inserted, so their transforms are up to date and are only read here
+    if (validate_before_execution_ && !validateTrajectory(*robot_traj, jmg))
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Cached trajectory to '" << pose_name << "' is in collision, not executing");
+      return false;
+    }
   }
 
-  return true;
+  return executeTrajectory(robot_traj, jmg, wait_for_execution);
 }
 
 bool PlanningInterface::executeState(JointModelGroup* jmg, const moveit::core::RobotStatePtr goal_state,
                                      double velocity_scaling_factor, const bool wait_for_execution)
 {
   // Get the start state
-  getCurrentState();
+  moveit::core::RobotStatePtr current_state = getCurrentState();
 
   // Visualize start/goal
-  // visual_start_state_->publishRobotState(current_state_, rvt::GREEN);
+  // visual_start_state_->publishRobotState(current_state, rvt::GREEN);
   // visual_goal_state_->publishRobotState(goal_state, rvt::ORANGE);
 
   // Check if already in new position
-  if (statesEqual(*current_state_, *goal_state, jmg))
+  if (statesEqual(*current_state, *goal_state, jmg))
   {
     ROS_INFO_STREAM_NAMED(name_, "Not executing because current state and goal state are "
                                  "close enough.");
     return true;
   }
 
-  // Create trajectory
+  robot_trajectory::RobotTrajectoryPtr robot_traj(new robot_trajectory::RobotTrajectory(robot_model_, jmg));
+  if (!computeTrajectoryToState(jmg, *current_state, *goal_state, velocity_scaling_factor, robot_traj))
+    return false;
+
+  return executeTrajectory(robot_traj, jmg, wait_for_execution);
+}
+
+bool PlanningInterface::computeTrajectoryToState(JointModelGroup* jmg, const moveit::core::RobotState& start_state,
+                                                 const moveit::core::RobotState& goal_state,
+                                                 double velocity_scaling_factor,
+                                                 robot_trajectory::RobotTrajectoryPtr robot_traj)
+{
+  // Create trajectory from copies, interpolate() keeps the end points so the caller's states must not end up in it
   std::vector<moveit::core::RobotStatePtr> robot_state_traj;
-  robot_state_traj.push_back(current_state_);
+  robot_state_traj.push_back(state_pool_->acquire(start_state));
 
   // Add goal state
-  robot_state_traj.push_back(goal_state);
+  robot_state_traj.push_back(state_pool_->acquire(goal_state));
 
   // Convert trajectory to a message
-  robot_trajectory::RobotTrajectoryPtr robot_traj(new robot_trajectory::RobotTrajectory(robot_model_, jmg));
   bool interpolate = true;
   if (!convertRobotStatesToTraj(robot_state_traj, robot_traj, jmg, velocity_scaling_factor, interpolate))
   {
@@ -155,6 +257,104 @@ bool PlanningInterface::executeState(JointModelGroup* jmg, const moveit::core::R
     return false;
   }
 
+  if (validate_before_execution_ && !validateTrajectory(*robot_traj, jmg))
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Interpolated trajectory is in collision, not executing");
+    return false;
+  }
+  return true;
+}
+
+bool PlanningInterface::validateTrajectory(const robot_trajectory::RobotTrajectory& robot_traj, JointModelGroup* jmg)
+{
+  ros::WallTime start_time = ros::WallTime::now();
+  const std::size_t num_waypoints = robot_traj.getWayPointCount();
+  if (num_waypoints < 2)
+    return true;
+
+  // Segment s is checked at states 1 to n of its n equal steps, the last of which is waypoint s + 1. The start state
+  // is not checked, to allow recovery from a collision state
+  const std::size_t num_segments = num_waypoints - 1;
+  std::vector<std::size_t> offsets(num_segments + 1);  // first check of each segment, then the number of checks
+  offsets[0] = 0;
+  for (std::size_t s = 0; s < num_segments; ++s)
+  {
+    const std::size_t steps =
+        std::max<std::size_t>(1, validSegmentCount(robot_traj.getWayPoint(s), robot_traj.getWayPoint(s + 1), NULL));
+    offsets[s + 1] = offsets[s] + steps;
+  }
+  const std::size_t num_checks = offsets.back();
+  std::vector<std::size_t> order;
+  computeBisectionOrder(0, num_checks, order);
+
+  // The waypoints are shared by the threads and only read, the states checked are written into per-chunk copies of
+  // this one, which carries the attached bodies of the start state
+  const moveit::core::RobotState prototype(robot_traj.getWayPoint(0));
+
+  psm::LockedPlanningSceneRO scene(planning_scene_monitor_);
+  const planning_scene::PlanningSceneConstPtr& planning_scene = scene;
+  StateValidityChecker checker(planning_scene.get());
+
+  // Chunks are taken in order, so the coarse checks at the front of the order run first
+  std::atomic<bool> collision(false);
+  ThreadPool::RangeFunction check = [&](std::size_t begin, std::size_t end)
+  {
+    moveit::core::RobotState state(prototype);
+    for (std::size_t i = begin; i < end && !collision.load(std::memory_order_relaxed); ++i)
+    {
+      const std::size_t index = order[i];
+      const std::size_t s = std::upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin() - 1;
+      const std::size_t step = index - offsets[s] + 1;
+      const std::size_t steps = offsets[s + 1] - offsets[s];
+
+      // Forward kinematics only for the states actually checked, spread across the threads
+      const moveit::core::RobotState& to = robot_traj.getWayPoint(s + 1);
+      if (step == steps)
+        state.setVariablePositions(to.getVariablePositions());
+      else
+        robot_traj.getWayPoint(s).interpolate(to, static_cast<double>(step) / steps, state);
+      state.update();
+      if (!checker.isStateValid(state, jmg))
+        collision = true;
+    }
+  };
+  if (interpolation_pool_ && num_checks >= parallel_validation_min_states_)
+    interpolation_pool_->parallelFor(0, num_checks, check);
+  else
+    check(0, num_checks);
+
+  ROS_DEBUG_STREAM_NAMED(name_ + ".validation", "Validated " << num_waypoints << " waypoints with " << num_checks
+                                                << " checks in "
+                                                << (ros::WallTime::now() - start_time).toSec() * 1000.0 << " ms");
+  return !collision;
+}
+
+void PlanningInterface::computeBisectionOrder(std::size_t begin, std::size_t end, std::vector<std::size_t>& order)
+{
+  order.clear();
+  if (begin >= end)
+    return;
+
+  // The goal first, then midpoints of ever smaller intervals, breadth first
+  order.push_back(end - 1);
+  std::vector<std::pair<std::size_t, std::size_t> > intervals(1, std::make_pair(begin, end - 1));
+  for (std::size_t i = 0; i < intervals.size(); ++i)
+  {
+    const std::size_t first = intervals[i].first;
+    const std::size_t last = intervals[i].second;
+    if (first >= last)
+      continue;
+
+    const std::size_t mid = first + (last - first) / 2;
+    order.push_back(mid);
+    intervals.push_back(std::make_pair(first, mid));
+    intervals.push_back(std::make_pair(mid + 1, last));
+  }
+}
+
+bool PlanningInterface::executeTrajectory(robot_trajectory::RobotTrajectoryPtr robot_traj, JointModelGroup* jmg,
+                                          const bool wait_for_execution)
+{
   if (!execution_interface_)
   {
     ROS_ERROR_STREAM_NAMED(name_, "Execution interface not intialized");
@@ -173,7 +373,8 @@ bool PlanningInterface::executeState(JointModelGroup* jmg, const moveit::core::R
 bool PlanningInterface::convertRobotStatesToTraj(const std::vector<moveit::core::RobotStatePtr>& robot_state_traj,
                                                  robot_trajectory::RobotTrajectoryPtr robot_traj,
                                                  JointModelGroup* jmg, const double& velocity_scaling_factor,
-                                                 bool use_interpolation)
+                                                 bool use_interpolation,
+                                                 const TimeParameterizationPtr& time_parameterization)
 {
   // Copy the vector of RobotStates to a RobotTrajectory
 
@@ -185,11 +386,12 @@ bool PlanningInterface::convertRobotStatesToTraj(const std::vector<moveit::core:
     robot_traj->addSuffixWayPoint(robot_state_traj[k], duration_from_previous);
   }
 
-  return convertRobotStatesToTraj(robot_traj, jmg, velocity_scaling_factor, use_interpolation);
+  return convertRobotStatesToTraj(robot_traj, jmg, velocity_scaling_factor, use_interpolation, time_parameterization);
 }
 
 bool PlanningInterface::convertRobotStatesToTraj(robot_trajectory::RobotTrajectoryPtr robot_traj, JointModelGroup* jmg,
-                                                 const double& velocity_scaling_factor, bool use_interpolation)
+                                                 const double& velocity_scaling_factor, bool use_interpolation,
+                                                 const TimeParameterizationPtr& time_parameterization)
 {
   ROS_INFO_STREAM_NAMED(name_, "convertRobotStatesToTraj()");
 
@@ -207,8 +409,14 @@ bool PlanningInterface::convertRobotStatesToTraj(robot_trajectory::RobotTrajecto
     }
   }
 
-  // Perform iterative parabolic smoothing
-  iterative_smoother_.computeTimeStamps(*robot_traj, velocity_scaling_factor);
+  // Add velocities, accelerations and timing
+  const TimeParameterizationPtr& parameterization =
+      time_parameterization ? time_parameterization : time_parameterization_;
+  if (!parameterization->computeTimeStamps(*robot_traj, velocity_scaling_factor))
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to parameterize trajectory with " << parameterization->getName());
+    return false;
+  }
 
   return true;
 }
@@ -217,159 +425,420 @@ bool PlanningInterface::interpolate(robot_trajectory::RobotTrajectoryPtr robot_t
 {
   double dummy_dt = 1;  // dummy value until parameterization
 
-  robot_trajectory::RobotTrajectoryPtr new_robot_traj(
-      new robot_trajectory::RobotTrajectory(robot_model_, robot_traj->getGroup()));
   std::size_t original_num_waypoints = robot_traj->getWayPointCount();
 
   // Error check
-  if (robot_traj->getWayPointCount() < 2)
+  if (original_num_waypoints < 2)
   {
     ROS_ERROR_STREAM_NAMED(name_, "Unable to interpolate between less than two states");
     return false;
   }
 
-  // Debug
-  // for (std::size_t i = 0; i < robot_traj->getWayPointCount(); ++i)
-  // {
-  //   moveit::core::robotStateToStream(robot_traj->getWayPoint(i), std::cout, false);
-  // }
-  // std::cout << "-------------------------------------------------------" << std::endl;
+  // Count the segments between each set of points (A,B) first, so that every new state is acquired at once
+  JointModelGroup* jmg = robot_traj->getGroup();
+  segment_counts_.resize(original_num_waypoints - 1);
+  std::size_t num_new_states = 0;
+  for (std::size_t i = 0; i < original_num_waypoints - 1; ++i)
+  {
+    segment_counts_[i] = std::max<std::size_t>(
+        1, validSegmentCount(robot_traj->getWayPoint(i), robot_traj->getWayPoint(i + 1), jmg));
+    num_new_states += segment_counts_[i] - 1;
+  }
+
+  // Keep the original waypoints, they are shared with the result rather than copied
+  original_waypoints_.resize(original_num_waypoints);
+  for (std::size_t i = 0; i < original_num_waypoints; ++i)
+    original_waypoints_[i] = robot_traj->getWayPointPtr(i);
 
-  // For each set of points (A,B) in the original trajectory
-  for (std::size_t i = 0; i < robot_traj->getWayPointCount() - 1; ++i)
+  state_pool_->acquire(num_new_states, robot_traj->getFirstWayPoint(), interpolated_states_);
+
+  // Where each segment's new states start in interpolated_states_
+  segment_offsets_.resize(segment_counts_.size());
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < segment_counts_.size(); ++i)
   {
-    // Add point A to final trajectory
-    new_robot_traj->addSuffixWayPoint(robot_traj->getWayPoint(i), dummy_dt);
+    segment_offsets_[i] = offset;
+    offset += segment_counts_[i] - 1;
+  }
 
-    std::size_t valid_segment_count = validSegmentCount(robot_traj->getWayPoint(i), robot_traj->getWayPoint(i + 1));
-    double discretization = 1.0 / valid_segment_count;
+  // Segments are independent, so long trajectories are split across threads. Each state is computed by the same
+  // code either way, so the result does not depend on the thread count. Chunks hold enough segments to be worth
+  // handing to a thread
+  if (interpolation_pool_ && num_new_states >= parallel_interpolation_min_states_)
+  {
+    static const std::size_t MIN_STATES_PER_CHUNK = 256;
+    const std::size_t states_per_segment = std::max<std::size_t>(1, num_new_states / segment_counts_.size());
+    const std::size_t min_chunk_size = std::max<std::size_t>(1, MIN_STATES_PER_CHUNK / states_per_segment);
+    interpolation_pool_->parallelFor(0, segment_counts_.size(),
+                                     boost::bind(&PlanningInterface::interpolateSegments, this, _1, _2),
+                                     min_chunk_size);
+  }
+  else
+    interpolateSegments(0, segment_counts_.size());
 
-    for (double t = discretization; t < 1; t += discretization)
-    {
-      // Create new state
-      moveit::core::RobotStatePtr interpolated_state(new moveit::core::RobotState(robot_traj->getFirstWayPoint()));
-      // Fill in new values
-      robot_traj->getWayPoint(i).interpolate(robot_traj->getWayPoint(i + 1), t, *interpolated_state);
-      // Add to trajectory
-      new_robot_traj->addSuffixWayPoint(interpolated_state, dummy_dt);
-
-      // std::cout << "inserting " << t << " at " << new_robot_traj->getWayPointCount() << std::endl;
-    }
+  // Refill the trajectory in place
+  robot_traj->clear();
+  for (std::size_t i = 0; i < original_num_waypoints - 1; ++i)
+  {
+    // Add point A to final trajectory
+    robot_traj->addSuffixWayPoint(original_waypoints_[i], dummy_dt);
+
+    for (std::size_t k = 1; k < segment_counts_[i]; ++k)
+      robot_traj->addSuffixWayPoint(interpolated_states_[segment_offsets_[i] + k - 1], dummy_dt);
   }
 
   // Add final waypoint
-  new_robot_traj->addSuffixWayPoint(robot_traj->getLastWayPoint(), dummy_dt);
+  robot_traj->addSuffixWayPoint(original_waypoints_.back(), dummy_dt);
 
-  // Debug
-  // for (std::size_t i = 0; i < new_robot_traj->getWayPointCount(); ++i)
-  // {
-  //   moveit::core::robotStateToStream(new_robot_traj->getWayPoint(i), std::cout, false);
-  // }
+  // Only the trajectory should hold these, so the pool can reuse them once it is gone
+  original_waypoints_.clear();
+  interpolated_states_.clear();
 
-  std::size_t modified_num_waypoints = new_robot_traj->getWayPointCount();
+  std::size_t modified_num_waypoints = robot_traj->getWayPointCount();
   ROS_DEBUG_STREAM_NAMED("planning_interface.interpolation",
-                         "Interpolated trajectory from " << original_num_waypoints << " to " << modified_num_waypoints);
-
-  // Copy back to original datastructure
-  *robot_traj = *new_robot_traj;
+                         "Interpolated trajectory from " << original_num_waypoints << " to " << modified_num_waypoints
+                                                         << " using pool of " << state_pool_->size() << " states");
 
   return true;
 }
 
+void PlanningInterface::interpolateSegments(std::size_t begin, std::size_t end)
+{
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const moveit::core::RobotState& from = *original_waypoints_[i];
+    const moveit::core::RobotState& to = *original_waypoints_[i + 1];
+
+    // Step by integer fraction so rounding can never add or drop a point near B
+    const std::size_t segment_count = segment_counts_[i];
+    for (std::size_t k = 1; k < segment_count; ++k)
+    {
+      moveit::core::RobotState& interpolated_state = *interpolated_states_[segment_offsets_[i] + k - 1];
+      // Transforms are left dirty, they are only computed if something needs them, e.g. for visualization
+      from.interpolate(to, static_cast<double>(k) / segment_count, interpolated_state);
+    }
+  }
+}
+
 std::size_t PlanningInterface::validSegmentCount(const moveit::core::RobotState& state1,
-                                                 const moveit::core::RobotState& state2) const
+                                                 const moveit::core::RobotState& state2, JointModelGroup* jmg) const
 {
+  if (waypoint_density_ && jmg)
+    return waypoint_density_->segmentCount(state1, state2, jmg);
+
   const double dist = state1.distance(state2);
   return ceil(dist / longest_valid_segment_fraction_);
 }
 
-moveit::core::RobotStatePtr PlanningInterface::getCurrentState()
+std::size_t PlanningInterface::computeIKBatch(JointModelGroup* jmg, const EigenSTL::vector_Affine3d& poses,
+                                              const moveit::core::RobotState& seed_state,
+                                              std::vector<moveit::core::RobotStatePtr>& solutions,
+                                              const IKBatchOptions& options)
 {
-  // Get the real current state
-  psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-  (*current_state_) = scene->getCurrentState();
-  return current_state_;
+  solutions.assign(poses.size(), moveit::core::RobotStatePtr());
+  if (poses.empty())
+    return 0;
+
+  const moveit::core::LinkModel* tip_link = getIKTip(jmg);
+  if (!tip_link)
+    return 0;
+  const std::string& tip = tip_link->getName();
+
+  // The threads check against a copy of the scene, so the monitor is only locked while it is made and not for the
+  // whole batch. Without collision checking the scene is not needed at all
+  planning_scene::PlanningScenePtr planning_scene;
+  StateValidityCheckerPtr checker;
+  if (options.check_collisions_)
+  {
+    {
+      psm::LockedPlanningSceneRO scene(planning_scene_monitor_);
+      planning_scene = planning_scene::PlanningScene::clone(scene);
+    }
+    checker.reset(new StateValidityChecker(planning_scene.get(), options.only_check_self_collision_,
+                                           options.collision_check_skip_every_));
+  }
+
+  const std::size_t chunk_size = std::max<std::size_t>(1, options.chunk_size_);
+  const std::size_t num_chunks = (poses.size() + chunk_size - 1) / chunk_size;
+
+  // Without threads the whole sequence is one chunk, so every pose is seeded from the previous one
+  if (!ik_pool_ || num_chunks < 2)
+  {
+    const std::size_t solved =
+        solveIKChunk(jmg, tip, poses, 0, poses.size(), seed_state, checker.get(), options, solutions);
+    ROS_DEBUG_STREAM_NAMED(name_ + ".ik_batch", "Solved IK for " << solved << " of " << poses.size() << " poses");
+    return solved;
+  }
+
+  ik_pool_->parallelFor(0, num_chunks, [&](std::size_t chunk_begin, std::size_t chunk_end)
+                        {
+                          for (std::size_t c = chunk_begin; c < chunk_end; ++c)
+                            solveIKChunk(jmg, tip, poses, c * chunk_size, std::min(poses.size(), (c + 1) * chunk_size),
+                                         seed_state, checker.get(), options, solutions);
+                        });
+
+  // Chunks were seeded independently, so where one may have landed on a different IK branch than the chunk before
+  // it, solve it again continuing from the end of that chunk
+  std::size_t resolved_chunks = 0;
+  moveit::core::RobotStatePtr previous;
+  for (std::size_t c = 0; c < num_chunks; ++c)
+  {
+    const std::size_t begin = c * chunk_size;
+    const std::size_t end = std::min(poses.size(), begin + chunk_size);
+    if (previous && (!solutions[begin] ||
+                     active_variables_.maxDifference(*previous, *solutions[begin], jmg) > options.max_joint_jump_))
+    {
+      solveIKChunk(jmg, tip, poses, begin, end, *previous, checker.get(), options, solutions);
+      resolved_chunks++;
+    }
+
+    for (std::size_t i = begin; i < end; ++i)
+      if (solutions[i])
+        previous = solutions[i];
+  }
+
+  std::size_t solved = 0;
+  for (std::size_t i = 0; i < solutions.size(); ++i)
+    solved += solutions[i] ? 1 : 0;
+
+  ROS_DEBUG_STREAM_NAMED(name_ + ".ik_batch", "Solved IK for " << solved << " of " << poses.size() << " poses in "
+                                                               << num_chunks << " chunks, " << resolved_chunks
+                                                               << " solved again for continuity");
+  return solved;
 }
 
-bool PlanningInterface::statesEqual(const moveit::core::RobotState& s1, const moveit::core::RobotState& s2,
-                                    JointModelGroup* jmg)
+std::size_t PlanningInterface::computeIKBatch(JointModelGroup* jmg, const std::vector<TimePose>& waypoints,
+                                              const moveit::core::RobotState& seed_state,
+                                              std::vector<moveit::core::RobotStatePtr>& solutions,
+                                              const IKBatchOptions& options)
 {
-  static const double STATES_EQUAL_THRESHOLD = 0.001;
+  EigenSTL::vector_Affine3d poses(waypoints.size());
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+    poses[i] = waypoints[i].pose_;
+  return computeIKBatch(jmg, poses, seed_state, solutions, options);
+}
 
-  double s1_vars[jmg->getVariableCount()];
-  double s2_vars[jmg->getVariableCount()];
-  s1.copyJointGroupPositions(jmg, s1_vars);
-  s2.copyJointGroupPositions(jmg, s2_vars);
+std::size_t PlanningInterface::solveIKChunk(JointModelGroup* jmg, const std::string& tip,
+                                            const EigenSTL::vector_Affine3d& poses, std::size_t begin, std::size_t end,
+                                            const moveit::core::RobotState& seed_state,
+                                            const StateValidityChecker* checker, const IKBatchOptions& options,
+                                            std::vector<moveit::core::RobotStatePtr>& solutions)
+{
+  moveit::core::RobotState state(seed_state);
+  std::vector<double> last_solution;
+  state.copyJointGroupPositions(jmg, last_solution);
+
+  // Each chunk counts collision_check_skip_every on its own
+  StateValidityChecker::ContextPtr context;
+  moveit::core::GroupStateValidityCallbackFn constraint;
+  if (checker)
+  {
+    context = checker->createContext();
+    if (!context)
+      return 0;
+    constraint = context->getCallback();
+  }
 
-  for (std::size_t i = 0; i < jmg->getVariableCount(); ++i)
+  std::size_t solved = 0;
+  for (std::size_t i = begin; i < end; ++i)
   {
-    const moveit::core::JointModel* this_joint = jmg->getJointModel(jmg->getVariableNames()[i]);
+    if (state.setFromIK(jmg, poses[i], tip, 0, options.timeout_, constraint))
+    {
+      state.copyJointGroupPositions(jmg, last_solution);
+      solutions[i].reset(new moveit::core::RobotState(state));
+      solved++;
+    }
+    else
+    {
+      // Seed the next pose from the last solution
+      solutions[i].reset();
+      state.setJointGroupPositions(jmg, last_solution);
+    }
+  }
+  return solved;
+}
+
+bool PlanningInterface::computeStraightLinePath(const Eigen::Vector3d& direction, double desired_distance,
+                                                std::vector<moveit::core::RobotStatePtr>& robot_state_trajectory,
+                                                const moveit::core::RobotState& start_state, JointModelGroup* jmg,
+                                                bool reverse_trajectory, double& path_length,
+                                                const CartesianPathOptions& options)
+{
+  ros::WallTime start_time = ros::WallTime::now();
+  robot_state_trajectory.clear();
+  path_length = 0;
+
+  const moveit::core::LinkModel* tip = getIKTip(jmg);
+  if (!tip)
+    return false;
+  if (direction.norm() < std::numeric_limits<double>::epsilon() || desired_distance <= 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Straight line path needs a direction and a positive distance");
+    return false;
+  }
+  const Eigen::Vector3d unit_direction = direction.normalized();
+
+  // Distance covered at each waypoint, for cutting the path at a collision
+  std::vector<double> distances;
+  robot_state_trajectory.push_back(moveit::core::RobotStatePtr(new moveit::core::RobotState(start_state)));
+  robot_state_trajectory.back()->update();
+  distances.push_back(0);
+  const Eigen::Affine3d start_pose = robot_state_trajectory.back()->getGlobalLinkTransform(tip);
+
+  // Solve IK along the line, adapting the step to how well the previous step went
+  const double min_step = std::max(std::numeric_limits<double>::epsilon(), options.min_step_);
+  double step = std::max(min_step, options.max_step_);
+  moveit::core::RobotState candidate(start_state);
+  while (distances.back() < desired_distance)
+  {
+    const moveit::core::RobotState& previous = *robot_state_trajectory.back();
+    const double distance = std::min(desired_distance, distances.back() + step);
+    Eigen::Affine3d pose = start_pose;
+    pose.translation() += unit_direction * distance;
+
+    candidate = previous;
+    if (!candidate.setFromIK(jmg, pose, tip->getName(), 0, options.ik_timeout_) ||
+        active_variables_.maxDifference(previous, candidate, jmg) > options.jump_threshold_)
+    {
+      if (step * 0.5 < min_step)
+      {
+        ROS_WARN_STREAM_NAMED(name_, "No continuous IK solution after " << distances.back() << " of "
+                                                                        << desired_distance << " m");
+        break;
+      }
+      step *= 0.5;
+      continue;
+    }
 
-    std::vector<const moveit::core::JointModel*>::const_iterator joint_it;
-    joint_it = std::find(jmg->getActiveJointModels().begin(), jmg->getActiveJointModels().end(), this_joint);
+    candidate.update();
+    robot_state_trajectory.push_back(moveit::core::RobotStatePtr(new moveit::core::RobotState(candidate)));
+    distances.push_back(distance);
+    step = std::min(std::max(min_step, options.max_step_), step * 2.0);
+  }
+
+  // Check the waypoints for collision now that the line is known to be reachable, skipping those after a collision
+  std::size_t num_valid = robot_state_trajectory.size();
+  if (!options.ignore_collision_ && num_valid > 1)
+  {
+    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);
+    const planning_scene::PlanningSceneConstPtr& planning_scene = scene;
+    StateValidityChecker checker(planning_scene.get());
 
-    // Make sure joint is active
-    if (joint_it != jmg->getActiveJointModels().end())
+    std::atomic<std::size_t> first_collision(robot_state_trajectory.size());
+    ThreadPool::RangeFunction check = [&](std::size_t begin, std::size_t end)
     {
-      if (fabs(s1_vars[i] - s2_vars[i]) > STATES_EQUAL_THRESHOLD)
+      for (std::size_t i = begin; i < end && i < first_collision; ++i)
       {
-        // std::cout << "    statesEqual: Variable " << jmg->getVariableNames()[i] << " beyond
-        // threshold, diff: "
-        // << fabs(s1_vars[i] - s2_vars[i]) << std::endl;
-        return false;
+        if (checker.isStateValid(*robot_state_trajectory[i], jmg))
+          continue;
+
+        std::size_t current = first_collision;
+        while (i < current && !first_collision.compare_exchange_weak(current, i))
+          ;
+        return;
       }
+    };
+
+    // The start state is not checked, to allow recovery from a collision state
+    if (ik_pool_)
+      ik_pool_->parallelFor(1, robot_state_trajectory.size(), check);
+    else
+      check(1, robot_state_trajectory.size());
+
+    num_valid = first_collision;
+    if (num_valid < robot_state_trajectory.size())
+    {
+      ROS_WARN_STREAM_NAMED(name_, "Straight line path in collision after " << distances[num_valid - 1] << " of "
+                                                                            << desired_distance << " m");
+      robot_state_trajectory.resize(num_valid);
     }
   }
+  path_length = distances[num_valid - 1];
+
+  if (reverse_trajectory)
+    std::reverse(robot_state_trajectory.begin(), robot_state_trajectory.end());
+
+  ROS_DEBUG_STREAM_NAMED(name_ + ".cartesian_path", "Straight line path of " << path_length << " m with "
+                                                    << robot_state_trajectory.size() << " waypoints computed in "
+                                                    << (ros::WallTime::now() - start_time).toSec() * 1000.0 << " ms");
 
+  if (path_length < desired_distance * options.min_fraction_)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Straight line path only covers " << path_length << " of " << desired_distance
+                                                                    << " m");
+    return false;
+  }
   return true;
 }
 
-}  // namespace moveit_boilerplate
-
-namespace
+bool PlanningInterface::executeCartesianPath(JointModelGroup* jmg, const Eigen::Vector3d& direction,
+                                             double desired_distance, double velocity_scaling_factor,
+                                             bool reverse_path, bool ignore_collision)
 {
-bool isStateValid(const planning_scene::PlanningScene* planning_scene, bool verbose, bool only_check_self_collision,
-                  mvt::MoveItVisualToolsPtr visual_tools, moveit::core::RobotState* robot_state, JointModelGroup* group,
-                  const double* ik_solution, std::size_t collision_check_skip_every)
-{
-  // Decide if we can skip this check
-  static int check_count = 0;  // TODO(davetcoleman) is static ok?
-  if (++check_count % collision_check_skip_every != 0)
-    return true;
-
-  // Apply IK solution to robot state
-  robot_state->setJointGroupPositions(group, ik_solution);
-  robot_state->update();
+  moveit::core::RobotStatePtr current_state = getCurrentState();
 
-  if (!planning_scene)
+  CartesianPathOptions options;
+  options.ignore_collision_ = ignore_collision;
+  std::vector<moveit::core::RobotStatePtr> robot_state_traj;
+  double path_length;
+  if (!computeStraightLinePath(reverse_path ? Eigen::Vector3d(-direction) : direction, desired_distance,
+                               robot_state_traj, *current_state, jmg, false, path_length, options))
   {
-    ROS_ERROR_STREAM_NAMED("planning_interface", "No planning scene provided");
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to compute straight line path");
     return false;
   }
-  if (only_check_self_collision)
+
+  // Waypoints are already close together
+  robot_trajectory::RobotTrajectoryPtr robot_traj(new robot_trajectory::RobotTrajectory(robot_model_, jmg));
+  bool interpolate = false;
+  if (!convertRobotStatesToTraj(robot_state_traj, robot_traj, jmg, velocity_scaling_factor, interpolate))
   {
-    // No easy API exists for only checking self-collision, so we do it here.
-    // TODO(davetcoleman): move this into planning_scene.cpp
-    collision_detection::CollisionRequest req;
-    req.verbose = false;
-    req.group_name = group->getName();
-    collision_detection::CollisionResult res;
-    planning_scene->checkSelfCollision(req, res, *robot_state);
-    if (!res.collision)
-      return true;  // not in collision
+    ROS_ERROR_STREAM_NAMED(name_, "Failed to convert to parameterized trajectory");
+    return false;
   }
-  else if (!planning_scene->isStateColliding(*robot_state, group->getName()))
-    return true;  // not in collision
 
-  // Display more info about the collision
-  if (verbose)
+  return executeTrajectory(robot_traj, jmg);
+}
+
+bool PlanningInterface::executeVerticlePathWithIK(JointModelGroup* jmg, double desired_lift_distance,
+                                                  double velocity_scaling_factor, bool up, bool ignore_collision)
+{
+  return executeCartesianPath(jmg, Eigen::Vector3d::UnitZ(), desired_lift_distance, velocity_scaling_factor, !up,
+                              ignore_collision);
+}
+
+bool PlanningInterface::executeRetreatPath(JointModelGroup* jmg, double desired_retreat_distance,
+                                           double velocity_scaling_factor, bool retreat, bool ignore_collision)
+{
+  const moveit::core::LinkModel* tip = getIKTip(jmg);
+  if (!tip)
+    return false;
+
+  // Approach direction of the end effector in the planning frame
+  const Eigen::Vector3d approach_direction = getCurrentState()->getGlobalLinkTransform(tip).rotation().col(0);
+  return executeCartesianPath(jmg, approach_direction, desired_retreat_distance, velocity_scaling_factor, retreat,
+                              ignore_collision);
+}
+
+const moveit::core::LinkModel* PlanningInterface::getIKTip(JointModelGroup* jmg) const
+{
+  if (jmg == arm_jmg_ && ik_tip_link_)
+    return ik_tip_link_;
+
+  std::vector<const moveit::core::LinkModel*> tips;
+  jmg->getEndEffectorTips(tips);
+  if (tips.size() != 1)
   {
-    visual_tools->publishRobotState(*robot_state, rvt::RED);
-    planning_scene->isStateColliding(*robot_state, group->getName(), true);
-    visual_tools->publishContactPoints(*robot_state, planning_scene);
-    ros::Duration(0.4).sleep();
+    ROS_ERROR_STREAM_NAMED(name_, "Solving IK needs exactly one end effector tip in group '" << jmg->getName() << "'");
+    return NULL;
   }
-  return false;
+  return tips.front();
+}
+
+moveit::core::RobotStatePtr PlanningInterface::getCurrentState()
+{
+  state_snapshot_->update(current_state_, current_state_version_, current_scene_version_);
+  return current_state_;
 }
 
-}  // end annonymous namespace
+}  // namespace moveit_boilerplate
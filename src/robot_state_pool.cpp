@@ -0,0 +1,99 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Reusable robot states, to avoid allocating a new state for every waypoint
+*/
+
+// this package
+#include <moveit_boilerplate/robot_state_pool.h>
+
+namespace moveit_boilerplate
+{
+const std::size_t RobotStatePool::DEFAULT_MAX_SIZE;
+
+RobotStatePool::RobotStatePool(moveit::core::RobotModelConstPtr robot_model, std::size_t max_size)
+  : robot_model_(robot_model), max_size_(max_size)
+{
+}
+
+moveit::core::RobotStatePtr RobotStatePool::acquire(const moveit::core::RobotState &prototype)
+{
+  // Start after the last state handed out, which is usually still in use
+  for (std::size_t n = 0; n < states_.size(); ++n)
+  {
+    const std::size_t i = (next_ + n) % states_.size();
+    if (states_[i].unique())
+    {
+      *states_[i] = prototype;
+      next_ = i + 1;
+      return states_[i];
+    }
+  }
+
+  moveit::core::RobotStatePtr state(new moveit::core::RobotState(prototype));
+  if (states_.size() < max_size_)
+    states_.push_back(state);
+  return state;
+}
+
+void RobotStatePool::acquire(std::size_t count, const moveit::core::RobotState &prototype,
+                             std::vector<moveit::core::RobotStatePtr> &states)
+{
+  states.clear();
+
+  // Free states first, in a single pass over the pool
+  for (std::size_t n = 0; n < states_.size() && states.size() < count; ++n)
+  {
+    const std::size_t i = (next_ + n) % states_.size();
+    if (states_[i].unique())
+    {
+      *states_[i] = prototype;
+      states.push_back(states_[i]);
+      next_ = i + 1;
+    }
+  }
+
+  // Grow for the rest, up to the size limit
+  if (states.size() < count)
+    ROS_DEBUG_STREAM_NAMED(name_, "Allocating " << count - states.size() << " robot states, pool has "
+                                                << states_.size() << " of at most " << max_size_);
+  while (states.size() < count)
+  {
+    states.push_back(moveit::core::RobotStatePtr(new moveit::core::RobotState(prototype)));
+    if (states_.size() < max_size_)
+      states_.push_back(states.back());
+  }
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,141 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Collision checking callback for IK solvers that can be used from several threads at once
+*/
+
+// this package
+#include <moveit_boilerplate/state_validity_checker.h>
+
+// Boost
+#include <boost/bind.hpp>
+
+namespace moveit_boilerplate
+{
+StateValidityChecker::Context::Context(const StateValidityChecker &checker)
+  : checker_(&checker), scratch_state_(checker.getPlanningScene()->getCurrentState())
+{
+}
+
+bool StateValidityChecker::Context::isValid(moveit::core::RobotState *state, JointModelGroup *group,
+                                            const double *ik_solution)
+{
+  // Decide if we can skip this check
+  if (++call_count_ % checker_->collision_check_skip_every_ != 0)
+    return true;
+
+  // Apply IK solution to the scratch state, leaving the solver's state alone
+  scratch_state_.setVariablePositions(state->getVariablePositions());
+  scratch_state_.setJointGroupPositions(group, ik_solution);
+  scratch_state_.update();
+
+  check_count_++;
+  if (checker_->isStateValid(scratch_state_, group))
+    return true;
+
+  collision_count_++;
+  return false;
+}
+
+moveit::core::GroupStateValidityCallbackFn StateValidityChecker::Context::getCallback()
+{
+  return boost::bind(&Context::isValid, this, _1, _2, _3);
+}
+
+void StateValidityChecker::Context::reset()
+{
+  call_count_ = 0;
+  check_count_ = 0;
+  collision_count_ = 0;
+}
+
+StateValidityChecker::StateValidityChecker(const planning_scene::PlanningScene *planning_scene,
+                                           bool only_check_self_collision, std::size_t collision_check_skip_every,
+                                           mvt::MoveItVisualToolsPtr visual_tools)
+  : planning_scene_(planning_scene)
+  , only_check_self_collision_(only_check_self_collision)
+  , collision_check_skip_every_(std::max<std::size_t>(1, collision_check_skip_every))
+  , visual_tools_(visual_tools)
+{
+  if (!planning_scene_)
+    ROS_ERROR_STREAM_NAMED(name_, "No planning scene provided");
+}
+
+StateValidityChecker::ContextPtr StateValidityChecker::createContext() const
+{
+  if (!planning_scene_)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to create a context without a planning scene");
+    return ContextPtr();
+  }
+  return ContextPtr(new Context(*this));
+}
+
+bool StateValidityChecker::isStateValid(const moveit::core::RobotState &state, JointModelGroup *group) const
+{
+  // Nothing to check against, so nothing can be shown to be collision free
+  if (!planning_scene_)
+    return false;
+
+  if (only_check_self_collision_)
+  {
+    // No easy API exists for only checking self-collision, so we do it here.
+    // TODO(davetcoleman): move this into planning_scene.cpp
+    collision_detection::CollisionRequest req;
+    req.verbose = false;
+    req.group_name = group->getName();
+    collision_detection::CollisionResult res;
+    planning_scene_->checkSelfCollision(req, res, state);
+    if (!res.collision)
+      return true;  // not in collision
+  }
+  else if (!planning_scene_->isStateColliding(state, group->getName()))
+    return true;  // not in collision
+
+  // Display more info about the collision
+  if (visual_tools_)
+  {
+    {
+      boost::mutex::scoped_lock lock(visual_tools_mutex_);
+      visual_tools_->publishRobotState(state, rvt::RED);
+      planning_scene_->isStateColliding(state, group->getName(), true);
+      visual_tools_->publishContactPoints(state, planning_scene_);
+    }
+    // Give time to look at it without holding up the other threads
+    ros::Duration(0.4).sleep();
+  }
+  return false;
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,733 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Loads a joint trajectory file in windows on a background thread and starts executing it before the whole
+           file has been read
+*/
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+// Boost
+#include <boost/scoped_ptr.hpp>
+
+// this package
+#include <moveit_boilerplate/streaming_trajectory_loader.h>
+#include <moveit_boilerplate/binary_trajectory.h>
+#include <moveit_boilerplate/compressed_trajectory.h>
+#include <moveit_boilerplate/csv_reader.h>
+
+// ROS parameter loading
+#include <rosparam_shortcuts/rosparam_shortcuts.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+/** \brief Reads the waypoints of a trajectory file a few at a time */
+class WaypointReader
+{
+public:
+  virtual ~WaypointReader()
+  {
+  }
+
+  /**
+   * \brief Append up to count waypoints, fewer only at the end of the file
+   * \return false on error
+   */
+  virtual bool read(std::size_t count, std::deque<moveit::core::RobotStatePtr> &states) = 0;
+
+  /** \brief True once every waypoint has been read */
+  virtual bool done() const = 0;
+};
+
+/** \brief Parses a CSV file of all robot variables a block of bytes at a time */
+class CSVWaypointReader : public WaypointReader
+{
+public:
+  static const std::size_t BLOCK_SIZE = 64 * 1024;
+
+  CSVWaypointReader(const moveit::core::RobotState &prototype, bool header)
+    : prototype_(prototype), skip_lines_(header ? 1 : 0)
+  {
+  }
+
+  bool open(const std::string &file_name)
+  {
+    input_file_.open(file_name.c_str(), std::ios::binary);
+    if (!input_file_.is_open())
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Unable to open file " << file_name);
+      return false;
+    }
+    return true;
+  }
+
+  bool read(std::size_t count, std::deque<moveit::core::RobotStatePtr> &states)
+  {
+    while (count > 0)
+    {
+      // Convert rows parsed from the last block
+      for (; next_row_ < csv_reader_.getRowCount() && count > 0; ++next_row_, --count)
+      {
+        moveit::core::RobotStatePtr state(new moveit::core::RobotState(prototype_));
+        state->setVariablePositions(csv_reader_.getRow(next_row_));
+        states.push_back(state);
+      }
+      if (count == 0 || end_of_file_)
+        break;
+
+      if (!parseBlock())
+        return false;
+    }
+    return true;
+  }
+
+  bool done() const
+  {
+    return end_of_file_ && next_row_ == csv_reader_.getRowCount();
+  }
+
+private:
+  /** \brief Read the next block and parse its complete lines, a partial line is kept for the next block */
+  bool parseBlock()
+  {
+    const std::size_t carried = buffer_.size();
+    buffer_.resize(carried + BLOCK_SIZE);
+    input_file_.read(&buffer_[carried], BLOCK_SIZE);
+    buffer_.resize(carried + input_file_.gcount());
+    end_of_file_ = !input_file_;
+
+    std::size_t size = buffer_.size();
+    if (!end_of_file_)
+    {
+      while (size > 0 && buffer_[size - 1] != '\n')
+        --size;
+    }
+
+    // Skipped lines are counted in the first block that has any complete lines
+    if (!csv_reader_.parse(buffer_.data(), size, size > 0 ? skip_lines_ : 0))
+      return false;
+    if (size > 0)
+      skip_lines_ = 0;
+    next_row_ = 0;
+    buffer_.erase(buffer_.begin(), buffer_.begin() + size);
+
+    if (csv_reader_.getRowCount() == 0)
+      return true;
+    if (csv_reader_.getColumnCount() < prototype_.getVariableCount())
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "CSV file has " << csv_reader_.getColumnCount() << " columns, the robot has "
+                                                    << prototype_.getVariableCount() << " variables");
+      return false;
+    }
+    return true;
+  }
+
+  // Short name of this class
+  std::string name_ = "streaming_trajectory_loader";
+
+  const moveit::core::RobotState &prototype_;
+  std::size_t skip_lines_;
+  std::ifstream input_file_;
+  bool end_of_file_ = false;
+
+  // Unparsed bytes, starting with the partial line left from the last block
+  std::vector<char> buffer_;
+  CSVReader csv_reader_;
+  std::size_t next_row_ = 0;
+};
+
+/** \brief Copies waypoints out of a memory mapped BinaryTrajectoryFile */
+class BinaryWaypointReader : public WaypointReader
+{
+public:
+  explicit BinaryWaypointReader(const moveit::core::RobotState &prototype) : prototype_(prototype)
+  {
+  }
+
+  bool open(const std::string &file_name)
+  {
+    if (!file_.open(file_name))
+      return false;
+
+    // Match the file's columns to the robot's variables by name
+    const std::vector<std::string> &robot_variables = prototype_.getRobotModel()->getVariableNames();
+    std::map<std::string, std::size_t> robot_indices;
+    for (std::size_t i = 0; i < robot_variables.size(); ++i)
+      robot_indices[robot_variables[i]] = i;
+
+    for (std::size_t i = 0; i < file_.getVariableCount(); ++i)
+    {
+      std::map<std::string, std::size_t>::const_iterator it = robot_indices.find(file_.getVariableNames()[i]);
+      if (it == robot_indices.end())
+      {
+        ROS_WARN_STREAM_NAMED(name_, "Ignoring variable " << file_.getVariableNames()[i] << " not in robot model");
+        continue;
+      }
+      file_columns_.push_back(i);
+      state_indices_.push_back(it->second);
+    }
+
+    values_.assign(prototype_.getVariablePositions(),
+                   prototype_.getVariablePositions() + prototype_.getVariableCount());
+    return true;
+  }
+
+  bool read(std::size_t count, std::deque<moveit::core::RobotStatePtr> &states)
+  {
+    const std::size_t end = std::min(next_waypoint_ + count, file_.getWaypointCount());
+    for (; next_waypoint_ < end; ++next_waypoint_)
+    {
+      for (std::size_t j = 0; j < file_columns_.size(); ++j)
+        values_[state_indices_[j]] = file_.getPositions(file_columns_[j])[next_waypoint_];
+
+      moveit::core::RobotStatePtr state(new moveit::core::RobotState(prototype_));
+      state->setVariablePositions(values_.data());
+      states.push_back(state);
+    }
+    return true;
+  }
+
+  bool done() const
+  {
+    return next_waypoint_ == file_.getWaypointCount();
+  }
+
+private:
+  // Short name of this class
+  std::string name_ = "streaming_trajectory_loader";
+
+  const moveit::core::RobotState &prototype_;
+  BinaryTrajectoryFile file_;
+  std::vector<std::size_t> file_columns_;
+  std::vector<std::size_t> state_indices_;
+  std::vector<double> values_;
+  std::size_t next_waypoint_ = 0;
+};
+
+/** \brief Decodes a CompressedTrajectoryFile a block at a time */
+class CompressedWaypointReader : public WaypointReader
+{
+public:
+  explicit CompressedWaypointReader(const moveit::core::RobotState &prototype) : prototype_(prototype)
+  {
+  }
+
+  bool open(const std::string &file_name)
+  {
+    if (!file_.open(file_name))
+      return false;
+
+    // Files without names hold all of the robot's variables in order
+    const std::vector<std::string> &robot_variables = prototype_.getRobotModel()->getVariableNames();
+    if (file_.getVariableNames().empty())
+    {
+      if (file_.getVariableCount() < robot_variables.size())
+      {
+        ROS_ERROR_STREAM_NAMED(name_, "Compressed file has " << file_.getVariableCount() << " variables, the robot has "
+                                                             << robot_variables.size());
+        return false;
+      }
+      for (std::size_t i = 0; i < robot_variables.size(); ++i)
+      {
+        file_columns_.push_back(i);
+        state_indices_.push_back(i);
+      }
+    }
+    else
+    {
+      std::map<std::string, std::size_t> robot_indices;
+      for (std::size_t i = 0; i < robot_variables.size(); ++i)
+        robot_indices[robot_variables[i]] = i;
+      for (std::size_t i = 0; i < file_.getVariableCount(); ++i)
+      {
+        std::map<std::string, std::size_t>::const_iterator it = robot_indices.find(file_.getVariableNames()[i]);
+        if (it == robot_indices.end())
+        {
+          ROS_WARN_STREAM_NAMED(name_, "Ignoring variable " << file_.getVariableNames()[i] << " not in robot model");
+          continue;
+        }
+        file_columns_.push_back(i);
+        state_indices_.push_back(it->second);
+      }
+    }
+
+    values_.assign(prototype_.getVariablePositions(),
+                   prototype_.getVariablePositions() + prototype_.getVariableCount());
+    return true;
+  }
+
+  bool read(std::size_t count, std::deque<moveit::core::RobotStatePtr> &states)
+  {
+    while (count > 0)
+    {
+      // Convert waypoints decoded from the last block
+      for (; next_waypoint_ < block_.getWaypointCount() && count > 0; ++next_waypoint_, --count)
+      {
+        const double *row = &block_.positions_[next_waypoint_ * block_.num_variables_];
+        for (std::size_t j = 0; j < file_columns_.size(); ++j)
+          values_[state_indices_[j]] = row[file_columns_[j]];
+
+        moveit::core::RobotStatePtr state(new moveit::core::RobotState(prototype_));
+        state->setVariablePositions(values_.data());
+        states.push_back(state);
+      }
+      if (count == 0 || next_block_ == file_.getBlockCount())
+        break;
+
+      if (!file_.readBlock(next_block_++, block_))
+        return false;
+      next_waypoint_ = 0;
+    }
+    return true;
+  }
+
+  bool done() const
+  {
+    return next_block_ == file_.getBlockCount() && next_waypoint_ == block_.getWaypointCount();
+  }
+
+private:
+  // Short name of this class
+  std::string name_ = "streaming_trajectory_loader";
+
+  const moveit::core::RobotState &prototype_;
+  CompressedTrajectoryFile file_;
+  std::vector<std::size_t> file_columns_;
+  std::vector<std::size_t> state_indices_;
+  std::vector<double> values_;
+
+  // Waypoints of the last block decoded
+  TrajectoryData block_;
+  std::size_t next_block_ = 0;
+  std::size_t next_waypoint_ = 0;
+};
+
+/** \brief Check the start of a file for the magic bytes of a binary format */
+bool hasMagic(const std::string &file_name, const char (&expected)[8])
+{
+  char magic[8];
+  std::ifstream input_file(file_name.c_str(), std::ios::binary);
+  return input_file.read(magic, sizeof(magic)) && std::memcmp(magic, expected, sizeof(magic)) == 0;
+}
+
+}  // namespace
+
+StreamingTrajectoryLoader::StreamingTrajectoryLoader(psm::PlanningSceneMonitorPtr planning_scene_monitor,
+                                                     ExecutionInterfacePtr execution_interface,
+                                                     TimeParameterizationPtr time_parameterization)
+  : name_("streaming_trajectory_loader")
+  , nh_("~")
+  , planning_scene_monitor_(planning_scene_monitor)
+  , execution_interface_(execution_interface)
+  , time_parameterization_(time_parameterization)
+{
+  if (!time_parameterization_)
+    time_parameterization_.reset(new IterativeParabolicParameterization());
+
+  // Load rosparams
+  int window_size;
+  int overlap;
+  int max_queued_windows;
+  ros::NodeHandle rpnh(nh_, name_);
+  std::size_t error = 0;
+  error += !rosparam_shortcuts::get(name_, rpnh, "window_size", window_size);
+  error += !rosparam_shortcuts::get(name_, rpnh, "overlap", overlap);
+  error += !rosparam_shortcuts::get(name_, rpnh, "splice_delay", splice_delay_);
+  error += !rosparam_shortcuts::get(name_, rpnh, "lookahead", lookahead_);
+  error += !rosparam_shortcuts::get(name_, rpnh, "max_queued_windows", max_queued_windows);
+  rosparam_shortcuts::shutdownIfError(name_, error);
+
+  // The overlap before a window must hold at least the last waypoint of the previous one to time the seam
+  window_size_ = std::max(1, window_size);
+  overlap_ = std::min<std::size_t>(std::max(1, overlap), window_size_);
+  max_queued_windows_ = std::max(1, max_queued_windows);
+  if (lookahead_ < 2 * splice_delay_)
+  {
+    ROS_WARN_STREAM_NAMED(name_, "Lookahead must leave time to splice, using " << 2 * splice_delay_ << " seconds");
+    lookahead_ = 2 * splice_delay_;
+  }
+}
+
+StreamingTrajectoryLoader::~StreamingTrajectoryLoader()
+{
+  stop();
+  if (load_thread_.joinable())
+    load_thread_.join();
+}
+
+bool StreamingTrajectoryLoader::execute(const std::string &file_name, JointModelGroup *jmg,
+                                        double velocity_scaling_factor, bool header)
+{
+  ROS_DEBUG_STREAM_NAMED(name_, "Streaming trajectory from file " << file_name);
+
+  // Reset from the last call
+  if (load_thread_.joinable())
+    load_thread_.join();
+  windows_.clear();
+  loading_done_ = false;
+  stop_requested_ = false;
+  pending_states_.clear();
+  pending_times_.clear();
+  loaded_duration_ = 0;
+  previous_tail_.clear();
+  previous_tail_durations_.clear();
+  raw_waypoints_ = 0;
+  queued_waypoints_ = 0;
+  loaded_waypoints_ = 0;
+  peak_buffered_waypoints_ = 0;
+
+  {
+    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
+    start_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
+  }  // end scoped pointer of locked planning scene
+
+  load_thread_ = boost::thread(&StreamingTrajectoryLoader::loadThread, this, file_name, jmg, velocity_scaling_factor,
+                               header);
+
+  // Start moving as soon as the first window is ready
+  Window window;
+  if (!popWindow(window))
+  {
+    load_thread_.join();
+    return false;
+  }
+  pending_states_.insert(pending_states_.end(), window.states_.begin(), window.states_.end());
+  pending_times_.insert(pending_times_.end(), window.times_.begin(), window.times_.end());
+
+  peak_buffered_waypoints_ = raw_waypoints_ + queued_waypoints_ + pending_states_.size() + window.tail_.size();
+
+  ExecutionInterface::ExecutionFuture execution =
+      execution_interface_->executeTrajectoryAsync(makeTrajectory(jmg, 0.0, window), jmg);
+  if (execution.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Execution of the first window ended as soon as it was sent");
+    stop();
+    load_thread_.join();
+    return false;
+  }
+
+  // Time 0 of the file is when the controller got the first window, which is after the checks and any confirmation
+  // in the execution interface, so not a clock read before sending
+  ros::Time start = execution_interface_->getActiveTrajectoryStart();
+
+  while (!window.last_)
+  {
+    // Hand over the next window shortly before the robot reaches the end of the previous one
+    if (!waitUntil(pending_times_.back() - lookahead_, start) || !popWindow(window))
+    {
+      execution_interface_->stopExecution();
+      load_thread_.join();
+      return false;
+    }
+    if (execution.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Execution ended after " << (ros::Time::now() - start).toSec()
+                                                             << " seconds, before loading caught up");
+      stop();
+      load_thread_.join();
+      return false;
+    }
+    pending_states_.insert(pending_states_.end(), window.states_.begin(), window.states_.end());
+    pending_times_.insert(pending_times_.end(), window.times_.begin(), window.times_.end());
+
+    // Forget waypoints the robot will have passed by the time the new trajectory takes over
+    const double splice_time = (ros::Time::now() - start).toSec() + splice_delay_;
+    while (pending_times_.size() > 1 && pending_times_[1] <= splice_time)
+    {
+      pending_states_.pop_front();
+      pending_times_.pop_front();
+    }
+    const double begin = std::max(splice_time, pending_times_.front());
+
+    peak_buffered_waypoints_ =
+        std::max<std::size_t>(peak_buffered_waypoints_, raw_waypoints_ + queued_waypoints_ + pending_states_.size() +
+                                                            window.tail_.size());
+
+    execution = execution_interface_->spliceTrajectoryAsync(
+        makeTrajectory(jmg, begin, window), jmg, ros::Duration(begin - (ros::Time::now() - start).toSec()));
+
+    // The splice is stamped with when it takes over, which is file time begin. A splice that was not sent ends
+    // its execution right away, which is reported above on the next window
+    if (execution.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      start = execution_interface_->getActiveTrajectoryStart() - ros::Duration(begin);
+  }
+
+  load_thread_.join();
+  return execution_interface_->waitForExecution(execution);
+}
+
+void StreamingTrajectoryLoader::stop()
+{
+  boost::mutex::scoped_lock lock(windows_mutex_);
+  stop_requested_ = true;
+  windows_condition_.notify_all();
+}
+
+void StreamingTrajectoryLoader::loadThread(std::string file_name, JointModelGroup *jmg,
+                                           double velocity_scaling_factor, bool header)
+{
+  boost::scoped_ptr<WaypointReader> reader;
+  if (hasMagic(file_name, BinaryTrajectoryFile::MAGIC))
+  {
+    BinaryWaypointReader *binary_reader = new BinaryWaypointReader(*start_state_);
+    reader.reset(binary_reader);
+    if (!binary_reader->open(file_name))
+    {
+      finishLoading();
+      return;
+    }
+  }
+  else if (hasMagic(file_name, CompressedTrajectoryFile::MAGIC))
+  {
+    CompressedWaypointReader *compressed_reader = new CompressedWaypointReader(*start_state_);
+    reader.reset(compressed_reader);
+    if (!compressed_reader->open(file_name))
+    {
+      finishLoading();
+      return;
+    }
+  }
+  else
+  {
+    CSVWaypointReader *csv_reader = new CSVWaypointReader(*start_state_, header);
+    reader.reset(csv_reader);
+    if (!csv_reader->open(file_name))
+    {
+      finishLoading();
+      return;
+    }
+  }
+
+  // Waypoints from the overlap before the current window to the overlap after it
+  std::deque<moveit::core::RobotStatePtr> raw;
+  std::size_t lead = 0;
+  while (!stop_requested_)
+  {
+    const std::size_t needed = lead + window_size_ + overlap_;
+    const std::size_t previous_size = raw.size();
+    if (raw.size() < needed && !reader->read(needed - raw.size(), raw))
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Failed to read file " << file_name);
+      break;
+    }
+    loaded_waypoints_ += raw.size() - previous_size;
+    raw_waypoints_ = raw.size();
+
+    // A remainder shorter than the overlap is added to the last window rather than being timed on its own
+    const bool last = reader->done() && raw.size() <= needed;
+    const std::size_t count = last ? raw.size() - lead : window_size_;
+    if (count == 0)
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "No states loaded from file " << file_name);
+      break;
+    }
+
+    if (!queueWindow(raw, lead, count, last, jmg, velocity_scaling_factor))
+    {
+      ROS_ERROR_STREAM_NAMED(name_, "Failed to time parameterize the window ending at waypoint "
+                                        << loaded_waypoints_ - (raw.size() - lead - count));
+      break;
+    }
+    if (last)
+      break;
+
+    // Keep the overlap before the next window
+    raw.erase(raw.begin(), raw.begin() + (lead + count - overlap_));
+    lead = overlap_;
+  }
+
+  finishLoading();
+}
+
+bool StreamingTrajectoryLoader::queueWindow(const std::deque<moveit::core::RobotStatePtr> &raw, std::size_t lead,
+                                            std::size_t count, bool last, JointModelGroup *jmg,
+                                            double velocity_scaling_factor)
+{
+  // Parameterize copies, the overlaps are also timed by the neighboring windows
+  const std::size_t end = last ? lead + count : std::min(raw.size(), lead + count + overlap_);
+  robot_trajectory::RobotTrajectory trajectory(start_state_->getRobotModel(), jmg);
+  for (std::size_t i = 0; i < end; ++i)
+    trajectory.addSuffixWayPoint(moveit::core::RobotStatePtr(new moveit::core::RobotState(*raw[i])), 0.0);
+  if (!time_parameterization_->computeTimeStamps(trajectory, velocity_scaling_factor))
+    return false;
+
+  // The previous window timed the start of this one as its tail, which is where the robot already is when this
+  // window takes over. Crossfade from that timing to this window's, which started from rest in the lead, so that
+  // durations, velocities and accelerations change gradually across the seam
+  const std::size_t crossfade = std::min(previous_tail_.size(), count);
+  for (std::size_t j = 0; j < crossfade; ++j)
+  {
+    const double weight = static_cast<double>(j + 1) / (crossfade + 1);
+    const moveit::core::RobotState &previous = *previous_tail_[j];
+    moveit::core::RobotState &state = *trajectory.getWayPointPtr(lead + j);
+    for (std::size_t k = 0; k < state.getVariableCount(); ++k)
+    {
+      state.setVariableVelocity(k, (1 - weight) * previous.getVariableVelocity(k) +
+                                       weight * state.getVariableVelocity(k));
+      state.setVariableAcceleration(k, (1 - weight) * previous.getVariableAcceleration(k) +
+                                           weight * state.getVariableAcceleration(k));
+    }
+    const double duration = trajectory.getWayPointDurationFromPrevious(lead + j);
+    trajectory.setWayPointDurationFromPrevious(lead + j,
+                                               (1 - weight) * previous_tail_durations_[j] + weight * duration);
+  }
+
+  // Continue the timing of the previous window across the seam
+  Window window;
+  window.last_ = last;
+  double time = loaded_duration_;
+  for (std::size_t i = lead; i < lead + count; ++i)
+  {
+    time += trajectory.getWayPointDurationFromPrevious(i);
+    window.states_.push_back(trajectory.getWayPointPtr(i));
+    window.times_.push_back(time);
+  }
+  loaded_duration_ = time;
+  previous_tail_.clear();
+  previous_tail_durations_.clear();
+  for (std::size_t i = lead + count; i < end; ++i)
+  {
+    time += trajectory.getWayPointDurationFromPrevious(i);
+    window.tail_.push_back(trajectory.getWayPointPtr(i));
+    window.tail_times_.push_back(time);
+    previous_tail_.push_back(trajectory.getWayPointPtr(i));
+    previous_tail_durations_.push_back(trajectory.getWayPointDurationFromPrevious(i));
+  }
+
+  // Wait for room in the queue
+  boost::mutex::scoped_lock lock(windows_mutex_);
+  while (windows_.size() >= max_queued_windows_ && !stop_requested_)
+    windows_condition_.wait(lock);
+  queued_waypoints_ += window.states_.size() + window.tail_.size();
+  windows_.push_back(std::move(window));
+  windows_condition_.notify_all();
+  return true;
+}
+
+bool StreamingTrajectoryLoader::popWindow(Window &window)
+{
+  boost::mutex::scoped_lock lock(windows_mutex_);
+  while (windows_.empty() && !loading_done_ && !stop_requested_)
+    windows_condition_.wait(lock);
+  if (stop_requested_ || windows_.empty())
+    return false;
+
+  window = std::move(windows_.front());
+  windows_.pop_front();
+  queued_waypoints_ -= window.states_.size() + window.tail_.size();
+  windows_condition_.notify_all();
+  return true;
+}
+
+bool StreamingTrajectoryLoader::waitUntil(double file_time, const ros::Time &start)
+{
+  static const int POLL_PERIOD_MS = 10;
+
+  // The condition variable waits in wall time, so wake up regularly and compare in ROS time
+  boost::mutex::scoped_lock lock(windows_mutex_);
+  while (!stop_requested_)
+  {
+    const double wait = file_time - (ros::Time::now() - start).toSec();
+    if (wait <= 0)
+      break;
+
+    // Wakes up early if stop() is called
+    const int wait_ms = std::min<int>(POLL_PERIOD_MS, std::ceil(wait * 1000));
+    windows_condition_.timed_wait(lock, boost::posix_time::milliseconds(wait_ms));
+  }
+  return !stop_requested_;
+}
+
+robot_trajectory::RobotTrajectoryPtr StreamingTrajectoryLoader::makeTrajectory(JointModelGroup *jmg,
+                                                                               double start_time,
+                                                                               const Window &latest) const
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory(
+      new robot_trajectory::RobotTrajectory(start_state_->getRobotModel(), jmg));
+
+  // Start exactly at start_time so the splice does not shift the motion in time
+  std::size_t first = 0;
+  if (pending_times_.size() > 1 && start_time > pending_times_[0])
+  {
+    const moveit::core::RobotState &from = *pending_states_[0];
+    const moveit::core::RobotState &to = *pending_states_[1];
+    const double fraction = (start_time - pending_times_[0]) / (pending_times_[1] - pending_times_[0]);
+
+    moveit::core::RobotStatePtr state(new moveit::core::RobotState(from));
+    from.interpolate(to, fraction, *state);
+    for (std::size_t i = 0; i < state->getVariableCount(); ++i)
+    {
+      state->setVariableVelocity(i, from.getVariableVelocity(i) +
+                                        fraction * (to.getVariableVelocity(i) - from.getVariableVelocity(i)));
+      const double acceleration_change = to.getVariableAcceleration(i) - from.getVariableAcceleration(i);
+      state->setVariableAcceleration(i, from.getVariableAcceleration(i) + fraction * acceleration_change);
+    }
+    trajectory->addSuffixWayPoint(state, 0.0);
+    first = 1;
+  }
+  else
+  {
+    start_time = pending_times_[0];
+  }
+
+  double previous_time = start_time;
+  for (std::size_t i = first; i < pending_states_.size(); ++i)
+  {
+    trajectory->addSuffixWayPoint(pending_states_[i], i > 0 ? pending_times_[i] - previous_time : 0.0);
+    previous_time = pending_times_[i];
+  }
+  for (std::size_t i = 0; i < latest.tail_.size(); ++i)
+  {
+    trajectory->addSuffixWayPoint(latest.tail_[i], latest.tail_times_[i] - previous_time);
+    previous_time = latest.tail_times_[i];
+  }
+  return trajectory;
+}
+
+void StreamingTrajectoryLoader::finishLoading()
+{
+  boost::mutex::scoped_lock lock(windows_mutex_);
+  loading_done_ = true;
+  windows_condition_.notify_all();
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,155 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Fixed set of worker threads for splitting a loop over independent items
+*/
+
+// C++
+#include <algorithm>
+
+// this package
+#include <moveit_boilerplate/thread_pool.h>
+
+// ROS
+#include <ros/ros.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+// Chunks per thread, more gives better balance for uneven work at the cost of more hand-offs
+const std::size_t CHUNKS_PER_THREAD = 4;
+}
+
+ThreadPool::ThreadPool(std::size_t num_threads) : next_chunk_(0)
+{
+  if (num_threads == 0)
+    num_threads = std::max(1u, boost::thread::hardware_concurrency());
+
+  for (std::size_t i = 1; i < num_threads; ++i)
+    workers_.push_back(boost::shared_ptr<boost::thread>(new boost::thread(&ThreadPool::workerLoop, this)));
+
+  ROS_DEBUG_STREAM_NAMED(name_, "Started thread pool with " << num_threads << " threads");
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    shutdown_ = true;
+  }
+  work_cond_.notify_all();
+
+  for (std::size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->join();
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, const RangeFunction &fn, std::size_t min_chunk_size)
+{
+  if (end <= begin)
+    return;
+
+  const std::size_t count = end - begin;
+  min_chunk_size = std::max<std::size_t>(1, min_chunk_size);
+
+  // Not worth waking anyone
+  if (workers_.empty() || count <= min_chunk_size)
+  {
+    fn(begin, end);
+    return;
+  }
+
+  boost::mutex::scoped_lock call_lock(call_mutex_);
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    const std::size_t target_chunks = getNumThreads() * CHUNKS_PER_THREAD;
+    job_fn_ = &fn;
+    job_begin_ = begin;
+    job_end_ = end;
+    job_chunk_size_ = std::max(min_chunk_size, (count + target_chunks - 1) / target_chunks);
+    job_num_chunks_ = (count + job_chunk_size_ - 1) / job_chunk_size_;
+    next_chunk_.store(0);
+    busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_cond_.notify_all();
+
+  // Help out
+  runChunks();
+
+  boost::mutex::scoped_lock lock(mutex_);
+  while (busy_workers_ > 0)
+    done_cond_.wait(lock);
+  job_fn_ = NULL;
+}
+
+void ThreadPool::workerLoop()
+{
+  std::size_t seen_generation = 0;
+  while (true)
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (generation_ == seen_generation && !shutdown_)
+        work_cond_.wait(lock);
+      if (shutdown_)
+        return;
+      seen_generation = generation_;
+    }
+
+    runChunks();
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (--busy_workers_ == 0)
+        done_cond_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::runChunks()
+{
+  while (true)
+  {
+    const std::size_t chunk = next_chunk_.fetch_add(1);
+    if (chunk >= job_num_chunks_)
+      return;
+
+    const std::size_t chunk_begin = job_begin_ + chunk * job_chunk_size_;
+    const std::size_t chunk_end = std::min(job_end_, chunk_begin + job_chunk_size_);
+    (*job_fn_)(chunk_begin, chunk_end);
+  }
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,549 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Interchangeable methods for adding velocities, accelerations and timing to a path
+*/
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// this package
+#include <moveit_boilerplate/time_parameterization.h>
+
+// ROS
+#include <ros/ros.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+const std::string LOGNAME = "time_parameterization";
+
+// Limits of joints without one in the robot model, same as IterativeParabolicTimeParameterization
+const double DEFAULT_VELOCITY = 1.0;
+const double DEFAULT_ACCELERATION = 1.0;
+
+const double EPSILON = 1e-9;
+
+// Duration of a segment between identical waypoints, controllers reject times that do not increase
+const double MIN_SEGMENT_DURATION = 1e-3;
+
+// Smallest factor the acceleration budget of a segment is lowered by in one pass of the jerk limiting
+const double MIN_BUDGET_FACTOR = 0.5;
+
+// Relative amount a limit may be exceeded by before a segment is slowed down
+const double LIMIT_TOLERANCE = 1e-2;
+
+/** \brief Positions and limits of the group variables of a trajectory */
+struct Path
+{
+  std::size_t num_points_ = 0;
+  std::size_t dof_ = 0;
+  std::vector<int> indices_;       // into the robot state's variables
+  std::vector<double> positions_;  // num_points_ x dof_, row major
+  std::vector<double> max_velocity_;
+  std::vector<double> max_acceleration_;
+
+  const double *point(std::size_t i) const
+  {
+    return &positions_[i * dof_];
+  }
+};
+
+double checkScalingFactor(double factor, const std::string &type)
+{
+  if (factor > 0 && factor <= 1)
+    return factor;
+
+  ROS_WARN_STREAM_NAMED(LOGNAME, "Invalid max_" << type << "_scaling_factor " << factor << " specified, defaulting "
+                                                                                         "to 1.0");
+  return 1.0;
+}
+
+/** \brief Positive limit, or the default if the model has none */
+double getLimit(bool bounded, double min_limit, double max_limit, double default_limit, const std::string &variable)
+{
+  if (!bounded)
+    return default_limit;
+
+  const double limit = std::min(std::fabs(max_limit), std::fabs(min_limit));
+  if (limit > EPSILON)
+    return limit;
+
+  ROS_WARN_STREAM_NAMED(LOGNAME, "Variable '" << variable << "' has a limit of zero, using " << default_limit);
+  return default_limit;
+}
+
+bool loadPath(const robot_trajectory::RobotTrajectory &trajectory, double velocity_scaling_factor,
+              double acceleration_scaling_factor, Path &path)
+{
+  const moveit::core::JointModelGroup *jmg = trajectory.getGroup();
+  if (!jmg)
+  {
+    ROS_ERROR_STREAM_NAMED(LOGNAME, "It looks like the planner did not set the group the plan was computed for");
+    return false;
+  }
+
+  velocity_scaling_factor = checkScalingFactor(velocity_scaling_factor, "velocity");
+  acceleration_scaling_factor = checkScalingFactor(acceleration_scaling_factor, "acceleration");
+
+  path.num_points_ = trajectory.getWayPointCount();
+  path.dof_ = jmg->getVariableCount();
+  path.indices_ = jmg->getVariableIndexList();
+
+  const moveit::core::RobotModel &robot_model = *trajectory.getRobotModel();
+  const std::vector<std::string> &names = jmg->getVariableNames();
+  path.max_velocity_.resize(path.dof_);
+  path.max_acceleration_.resize(path.dof_);
+  for (std::size_t j = 0; j < path.dof_; ++j)
+  {
+    const moveit::core::VariableBounds &bounds = robot_model.getVariableBounds(names[j]);
+    path.max_velocity_[j] = velocity_scaling_factor * getLimit(bounds.velocity_bounded_, bounds.min_velocity_,
+                                                               bounds.max_velocity_, DEFAULT_VELOCITY, names[j]);
+    path.max_acceleration_[j] =
+        acceleration_scaling_factor * getLimit(bounds.acceleration_bounded_, bounds.min_acceleration_,
+                                               bounds.max_acceleration_, DEFAULT_ACCELERATION, names[j]);
+  }
+
+  path.positions_.resize(path.num_points_ * path.dof_);
+  for (std::size_t i = 0; i < path.num_points_; ++i)
+  {
+    const moveit::core::RobotState &state = trajectory.getWayPoint(i);
+    for (std::size_t j = 0; j < path.dof_; ++j)
+      path.positions_[i * path.dof_ + j] = state.getVariablePosition(path.indices_[j]);
+  }
+
+  return true;
+}
+
+/** \brief Geometry of the piecewise linear path through the waypoints */
+struct Segments
+{
+  std::vector<double> length_;
+  std::vector<double> direction_;     // unit vector of each segment, num segments x dof
+  std::vector<double> curvature_;     // largest turn per unit length at either end, num segments x dof
+  std::vector<double> max_velocity_;  // path speed the joint velocity limits allow
+  std::vector<double> speed_limit_;   // path speed at each waypoint allowed by both segments and the turn there
+};
+
+void computeSegments(const Path &path, Segments &segments)
+{
+  const std::size_t num_points = path.num_points_;
+  const std::size_t num_segments = num_points - 1;
+  const std::size_t dof = path.dof_;
+
+  // Length, unit direction and the path speed each joint allows along every segment
+  segments.length_.assign(num_segments, 0.0);
+  segments.direction_.assign(num_segments * dof, 0.0);
+  segments.curvature_.assign(num_segments * dof, 0.0);
+  segments.max_velocity_.assign(num_segments, std::numeric_limits<double>::infinity());
+  for (std::size_t s = 0; s < num_segments; ++s)
+  {
+    const double *from = path.point(s);
+    const double *to = path.point(s + 1);
+
+    double squared_length = 0;
+    for (std::size_t j = 0; j < dof; ++j)
+      squared_length += (to[j] - from[j]) * (to[j] - from[j]);
+    if (squared_length < EPSILON * EPSILON)
+      continue;
+    const double length = std::sqrt(squared_length);
+    segments.length_[s] = length;
+
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const double u = (to[j] - from[j]) / length;
+      segments.direction_[s * dof + j] = u;
+      if (std::fabs(u) > EPSILON)
+        segments.max_velocity_[s] = std::min(segments.max_velocity_[s], path.max_velocity_[j] / std::fabs(u));
+    }
+  }
+
+  // Change of direction at each interior waypoint, spread over half of each segment next to it. The robot starts
+  // and ends at rest
+  segments.speed_limit_.assign(num_points, 0.0);
+  for (std::size_t k = 1; k < num_points - 1; ++k)
+  {
+    double limit = std::min(segments.max_velocity_[k - 1], segments.max_velocity_[k]);
+    const double turn_length = 0.5 * (segments.length_[k - 1] + segments.length_[k]);
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const double turn = std::fabs(segments.direction_[k * dof + j] - segments.direction_[(k - 1) * dof + j]);
+      if (turn < EPSILON || turn_length == 0)
+        continue;
+
+      // Turning alone may use the whole acceleration limit
+      limit = std::min(limit, std::sqrt(path.max_acceleration_[j] * turn_length / turn));
+
+      const double curvature = turn / turn_length;
+      double &before = segments.curvature_[(k - 1) * dof + j];
+      double &after = segments.curvature_[k * dof + j];
+      before = std::max(before, curvature);
+      after = std::max(after, curvature);
+    }
+    segments.speed_limit_[k] = limit;
+  }
+}
+
+/**
+ * \brief Largest path acceleration along a segment at a path speed
+ *        Joint acceleration is u * s'' + k * s'^2, so turning uses up part of each joint's limit
+ * \param budget - fraction of the acceleration left after turning that may be used
+ */
+double getPathAcceleration(const Path &path, const Segments &segments, std::size_t s, double speed, double budget)
+{
+  double acceleration = std::numeric_limits<double>::infinity();
+  for (std::size_t j = 0; j < path.dof_; ++j)
+  {
+    const double u = std::fabs(segments.direction_[s * path.dof_ + j]);
+    if (u > EPSILON)
+    {
+      const double available = path.max_acceleration_[j] - segments.curvature_[s * path.dof_ + j] * speed * speed;
+      acceleration = std::min(acceleration, budget * std::max(0.0, available) / u);
+    }
+  }
+  return acceleration;
+}
+
+/** \brief Fastest speed reachable over a segment from a speed, evaluating the turning at both ends */
+double getReachableSpeed(const Path &path, const Segments &segments, std::size_t s, double speed, double budget)
+{
+  const double length = segments.length_[s];
+  double reachable = std::sqrt(speed * speed + 2 * getPathAcceleration(path, segments, s, speed, budget) * length);
+  reachable = std::sqrt(speed * speed + 2 * getPathAcceleration(path, segments, s, reachable, budget) * length);
+  return reachable;
+}
+
+/**
+ * \brief Fastest path speed at each waypoint
+ * \param budget - fraction of the acceleration limits each segment may use
+ */
+void computeSpeedProfile(const Path &path, const Segments &segments, const std::vector<double> &budget,
+                         std::vector<double> &speed)
+{
+  const std::size_t num_segments = segments.length_.size();
+  speed = segments.speed_limit_;
+
+  // Forward pass limits acceleration, backward pass deceleration
+  for (std::size_t s = 0; s < num_segments; ++s)
+  {
+    if (segments.length_[s] > 0)
+      speed[s + 1] = std::min(speed[s + 1], getReachableSpeed(path, segments, s, speed[s], budget[s]));
+    else
+      speed[s + 1] = std::min(speed[s + 1], speed[s]);
+  }
+  for (std::size_t s = num_segments; s-- > 0;)
+  {
+    if (segments.length_[s] > 0)
+      speed[s] = std::min(speed[s], getReachableSpeed(path, segments, s, speed[s + 1], budget[s]));
+    else
+      speed[s] = std::min(speed[s], speed[s + 1]);
+  }
+}
+
+/**
+ * \brief Time of each segment when accelerating, cruising and decelerating within it
+ * \param durations - output, time from the previous waypoint for each waypoint
+ * \param phase_accelerations - output, path acceleration at the start and at the end of each segment, num segments x 2
+ */
+void computeDurations(const Path &path, const Segments &segments, const std::vector<double> &budget,
+                      const std::vector<double> &speed, std::vector<double> &durations,
+                      std::vector<double> &phase_accelerations)
+{
+  const std::size_t num_segments = segments.length_.size();
+  durations.assign(num_segments + 1, 0.0);
+  phase_accelerations.assign(num_segments * 2, 0.0);
+  for (std::size_t s = 0; s < num_segments; ++s)
+  {
+    const double length = segments.length_[s];
+    if (length == 0)
+    {
+      durations[s + 1] = MIN_SEGMENT_DURATION;
+      continue;
+    }
+
+    const double start = speed[s];
+    const double end = speed[s + 1];
+    double acceleration = getPathAcceleration(path, segments, s, std::max(start, end), budget[s]);
+    double peak = std::max(start, end);
+    if (acceleration > EPSILON)
+    {
+      // Turning is harder at the peak than at either end
+      peak = std::min(segments.max_velocity_[s], std::sqrt(acceleration * length + 0.5 * (start * start + end * end)));
+      acceleration = std::max(EPSILON, getPathAcceleration(path, segments, s, peak, budget[s]));
+      peak = std::min(peak, std::sqrt(acceleration * length + 0.5 * (start * start + end * end)));
+      peak = std::max(peak, std::max(start, end));  // rounding
+    }
+
+    if (acceleration <= EPSILON || peak - std::min(start, end) < EPSILON)
+    {
+      // Moving at the speed the turning allows, changing speed evenly over the segment
+      durations[s + 1] = 2 * length / (start + end);
+      phase_accelerations[s * 2] = phase_accelerations[s * 2 + 1] = (end - start) / durations[s + 1];
+      continue;
+    }
+
+    const double accelerate_length = (peak * peak - start * start) / (2 * acceleration);
+    const double decelerate_length = (peak * peak - end * end) / (2 * acceleration);
+    const double cruise_length = std::max(0.0, length - accelerate_length - decelerate_length);
+    durations[s + 1] = (peak - start) / acceleration + (peak - end) / acceleration + cruise_length / peak;
+    phase_accelerations[s * 2] = peak - start > EPSILON ? acceleration : 0.0;
+    phase_accelerations[s * 2 + 1] = peak - end > EPSILON ? -acceleration : 0.0;
+  }
+}
+
+/**
+ * \brief Velocities and accelerations at the waypoints from the speed profile
+ *        Velocities are the path speed along the mean direction of the segments next to a waypoint, accelerations are
+ *        the change of those velocities over the segments next to it
+ */
+void computeDerivatives(const Path &path, const Segments &segments, const std::vector<double> &speed,
+                        const std::vector<double> &durations, std::vector<double> &velocities,
+                        std::vector<double> &accelerations)
+{
+  const std::size_t num_points = path.num_points_;
+  const std::size_t dof = path.dof_;
+  velocities.assign(num_points * dof, 0.0);
+  accelerations.assign(num_points * dof, 0.0);
+  if (num_points < 2)
+    return;
+
+  // Velocities, the robot is at rest at both ends
+  for (std::size_t k = 1; k < num_points - 1; ++k)
+  {
+    const bool moves_before = segments.length_[k - 1] > 0;
+    const bool moves_after = segments.length_[k] > 0;
+    const double before_weight = moves_after ? (moves_before ? 0.5 : 0.0) : 1.0;
+    for (std::size_t j = 0; j < dof; ++j)
+      velocities[k * dof + j] = speed[k] * (before_weight * segments.direction_[(k - 1) * dof + j] +
+                                            (1 - before_weight) * segments.direction_[k * dof + j]);
+  }
+
+  // Accelerations, one sided at the ends
+  for (std::size_t k = 0; k < num_points; ++k)
+  {
+    const std::size_t previous = k > 0 ? k - 1 : k;
+    const std::size_t next = k < num_points - 1 ? k + 1 : k;
+    const double dt = (k > 0 ? durations[k] : 0.0) + (k < num_points - 1 ? durations[k + 1] : 0.0);
+    for (std::size_t j = 0; j < dof; ++j)
+      accelerations[k * dof + j] = (velocities[next * dof + j] - velocities[previous * dof + j]) / dt;
+  }
+}
+
+void writeTimeStamps(robot_trajectory::RobotTrajectory &trajectory, const Path &path,
+                     const std::vector<double> &durations, const std::vector<double> &velocities,
+                     const std::vector<double> &accelerations)
+{
+  for (std::size_t k = 0; k < path.num_points_; ++k)
+  {
+    moveit::core::RobotState &state = *trajectory.getWayPointPtr(k);
+    for (std::size_t j = 0; j < path.dof_; ++j)
+    {
+      state.setVariableVelocity(path.indices_[j], velocities[k * path.dof_ + j]);
+      state.setVariableAcceleration(path.indices_[j], accelerations[k * path.dof_ + j]);
+    }
+    trajectory.setWayPointDurationFromPrevious(k, durations[k]);
+  }
+}
+}  // namespace
+
+const std::string IterativeParabolicParameterization::NAME = "iterative_parabolic";
+const std::string TrapezoidalParameterization::NAME = "trapezoidal";
+const std::string JerkLimitedParameterization::NAME = "jerk_limited";
+const double JerkLimitedParameterization::DEFAULT_MAX_JERK = 10.0;
+
+bool IterativeParabolicParameterization::computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory,
+                                                           double velocity_scaling_factor,
+                                                           double acceleration_scaling_factor) const
+{
+  return iterative_smoother_.computeTimeStamps(trajectory, velocity_scaling_factor, acceleration_scaling_factor);
+}
+
+bool TrapezoidalParameterization::computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory,
+                                                    double velocity_scaling_factor,
+                                                    double acceleration_scaling_factor) const
+{
+  Path path;
+  if (!loadPath(trajectory, velocity_scaling_factor, acceleration_scaling_factor, path))
+    return false;
+
+  std::vector<double> durations;
+  std::vector<double> velocities;
+  std::vector<double> accelerations;
+  if (path.num_points_ > 1)
+  {
+    Segments segments;
+    std::vector<double> speed;
+    std::vector<double> phase_accelerations;
+    const std::vector<double> budget(path.num_points_ - 1, 1.0);
+    computeSegments(path, segments);
+    computeSpeedProfile(path, segments, budget, speed);
+    computeDurations(path, segments, budget, speed, durations, phase_accelerations);
+    computeDerivatives(path, segments, speed, durations, velocities, accelerations);
+  }
+  else
+  {
+    durations.assign(path.num_points_, 0.0);
+    velocities.assign(path.num_points_ * path.dof_, 0.0);
+    accelerations.assign(path.num_points_ * path.dof_, 0.0);
+  }
+  writeTimeStamps(trajectory, path, durations, velocities, accelerations);
+  return true;
+}
+
+JerkLimitedParameterization::JerkLimitedParameterization(double max_jerk, std::size_t max_iterations)
+  : max_jerk_(max_jerk), max_iterations_(max_iterations)
+{
+  if (max_jerk_ <= 0)
+  {
+    ROS_WARN_STREAM_NAMED(LOGNAME, "Invalid max_jerk " << max_jerk_ << ", using " << DEFAULT_MAX_JERK);
+    max_jerk_ = DEFAULT_MAX_JERK;
+  }
+}
+
+bool JerkLimitedParameterization::computeTimeStamps(robot_trajectory::RobotTrajectory &trajectory,
+                                                    double velocity_scaling_factor,
+                                                    double acceleration_scaling_factor) const
+{
+  Path path;
+  if (!loadPath(trajectory, velocity_scaling_factor, acceleration_scaling_factor, path))
+    return false;
+
+  std::vector<double> durations;
+  std::vector<double> velocities;
+  std::vector<double> accelerations;
+  if (path.num_points_ < 2)
+  {
+    durations.assign(path.num_points_, 0.0);
+    velocities.assign(path.num_points_ * path.dof_, 0.0);
+    accelerations.assign(path.num_points_ * path.dof_, 0.0);
+    writeTimeStamps(trajectory, path, durations, velocities, accelerations);
+    return true;
+  }
+
+  Segments segments;
+  computeSegments(path, segments);
+  const std::size_t num_segments = segments.length_.size();
+  const std::size_t dof = path.dof_;
+
+  // Lower the acceleration budget and speed limit around every segment where the joint jerk is over the limit,
+  // until the trapezoidal profile for those limits is within it
+  std::vector<double> budget(num_segments, 1.0);
+  std::vector<double> speed;
+  std::vector<double> phase_accelerations;
+  const double min_acceleration = *std::min_element(path.max_acceleration_.begin(), path.max_acceleration_.end());
+  std::vector<bool> violations(num_segments, false);
+  std::vector<bool> previous_violations(num_segments, false);
+  bool violated = true;
+  for (std::size_t iteration = 0; iteration < max_iterations_ && violated; ++iteration)
+  {
+    computeSpeedProfile(path, segments, budget, speed);
+    computeDurations(path, segments, budget, speed, durations, phase_accelerations);
+    computeDerivatives(path, segments, speed, durations, velocities, accelerations);
+
+    // The controller's spline can only change the acceleration between waypoints, so a segment's jerk is the spread
+    // of every acceleration it passes through - at both waypoints and in each of its phases, including the switch
+    // from accelerating to decelerating - over its duration
+    violated = false;
+    std::fill(violations.begin(), violations.end(), false);
+    for (std::size_t s = 0; s < num_segments; ++s)
+    {
+      double jerk = 0;
+      for (std::size_t j = 0; j < dof; ++j)
+      {
+        const double u = segments.direction_[s * dof + j];
+        const double values[4] = { accelerations[s * dof + j], u * phase_accelerations[s * 2],
+                                   u * phase_accelerations[s * 2 + 1], accelerations[(s + 1) * dof + j] };
+        jerk = std::max(jerk, *std::max_element(values, values + 4) - *std::min_element(values, values + 4));
+      }
+      jerk /= durations[s + 1];
+      if (jerk <= max_jerk_ * (1 + LIMIT_TOLERANCE))
+        continue;
+
+      // Jerk from speeding up scales with the acceleration. If lowering that was not enough the jerk is likely from
+      // turning, which scales with the cube of the speed
+      violated = true;
+      const double factor = std::max(MIN_BUDGET_FACTOR, max_jerk_ / jerk);
+      budget[s] *= factor;
+      if (previous_violations[s])
+      {
+        segments.speed_limit_[s] *= std::cbrt(factor);
+        segments.speed_limit_[s + 1] *= std::cbrt(factor);
+      }
+      violations[s] = true;
+    }
+    previous_violations.swap(violations);
+
+    // Let the budget grow back around each lowered segment no faster than the jerk limit allows the acceleration to,
+    // so it ramps up and down instead of stepping
+    for (std::size_t s = 1; s < num_segments; ++s)
+      budget[s] = std::min(budget[s], budget[s - 1] + max_jerk_ * durations[s + 1] / min_acceleration);
+    for (std::size_t s = num_segments - 1; s-- > 0;)
+      budget[s] = std::min(budget[s], budget[s + 1] + max_jerk_ * durations[s + 1] / min_acceleration);
+  }
+
+  if (violated)
+    ROS_WARN_STREAM_NAMED(LOGNAME, "Trajectory still exceeds the jerk limit after " << max_iterations_
+                                                                                   << " iterations");
+
+  writeTimeStamps(trajectory, path, durations, velocities, accelerations);
+  return true;
+}
+
+TimeParameterizationPtr createTimeParameterization(const std::string &name, double max_jerk)
+{
+  if (name == IterativeParabolicParameterization::NAME)
+    return TimeParameterizationPtr(new IterativeParabolicParameterization());
+  if (name == TrapezoidalParameterization::NAME)
+    return TimeParameterizationPtr(new TrapezoidalParameterization());
+  if (name == JerkLimitedParameterization::NAME)
+    return TimeParameterizationPtr(new JerkLimitedParameterization(max_jerk));
+
+  const std::vector<std::string> names = getTimeParameterizationNames();
+  std::string known;
+  for (std::size_t i = 0; i < names.size(); ++i)
+    known += (i ? ", " : "") + names[i];
+  ROS_ERROR_STREAM_NAMED(LOGNAME, "Unknown time parameterization '" << name << "', expected one of " << known);
+  return TimeParameterizationPtr();
+}
+
+std::vector<std::string> getTimeParameterizationNames()
+{
+  return { IterativeParabolicParameterization::NAME, TrapezoidalParameterization::NAME,
+           JerkLimitedParameterization::NAME };
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,225 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Benchmark of the time parameterization methods on the same paths
+
+   Usage, with only a roscore running:
+     rosrun moveit_boilerplate moveit_boilerplate_time_parameterization_benchmark _iterations:=20 _dofs:=[6,12]
+
+   Every method times identical copies of each path. Computation time excludes copying the path, duration is the
+   time_from_start of the last waypoint. The benchmark robot has no acceleration limits, so all joints use 1.0.
+*/
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ROS
+#include <ros/ros.h>
+
+// MoveIt
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+// this package
+#include <moveit_boilerplate/benchmark_robot.h>
+#include <moveit_boilerplate/time_parameterization.h>
+
+namespace
+{
+const std::string NAME = "time_parameterization_benchmark";
+
+/** \brief Value below which the given fraction of sorted samples lie */
+double percentile(const std::vector<double> &sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0.0;
+  const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+  return sorted[index];
+}
+
+/** \brief Joints sweep out and back at different frequencies, so the path bends at every waypoint */
+std::vector<moveit::core::RobotStatePtr> makePath(const robot_model::RobotModelConstPtr &robot_model,
+                                                  const robot_model::JointModelGroup *jmg, std::size_t waypoints,
+                                                  double amplitude)
+{
+  std::vector<moveit::core::RobotStatePtr> path;
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  std::vector<double> positions(jmg->getActiveJointModels().size());
+  for (std::size_t i = 0; i < waypoints; ++i)
+  {
+    const double s = waypoints > 1 ? static_cast<double>(i) / (waypoints - 1) : 1.0;
+    for (std::size_t j = 0; j < positions.size(); ++j)
+      positions[j] = amplitude * std::sin(M_PI * s * (1.0 + 0.25 * j));
+    state.setJointGroupPositions(jmg, positions);
+    state.update();
+    path.push_back(moveit::core::RobotStatePtr(new moveit::core::RobotState(state)));
+  }
+  return path;
+}
+
+struct Result
+{
+  std::vector<double> compute_times_;
+  double duration_ = 0;
+  std::size_t failures_ = 0;
+};
+
+/** \brief Parameterize fresh copies of the path and time each one */
+Result runBenchmark(const moveit_boilerplate::TimeParameterization &parameterization,
+                    const robot_model::RobotModelConstPtr &robot_model, const robot_model::JointModelGroup *jmg,
+                    const std::vector<moveit::core::RobotStatePtr> &path, std::size_t iterations, std::size_t warmup)
+{
+  typedef std::chrono::steady_clock Clock;
+  Result result;
+  for (std::size_t i = 0; i < warmup + iterations; ++i)
+  {
+    robot_trajectory::RobotTrajectory trajectory(robot_model, jmg);
+    for (std::size_t k = 0; k < path.size(); ++k)
+      trajectory.addSuffixWayPoint(*path[k], 0.0);
+
+    const Clock::time_point start = Clock::now();
+    const bool success = parameterization.computeTimeStamps(trajectory);
+    const Clock::time_point end = Clock::now();
+
+    if (i < warmup)
+      continue;
+    if (!success)
+    {
+      result.failures_++;
+      continue;
+    }
+    result.compute_times_.push_back(std::chrono::duration<double>(end - start).count());
+    result.duration_ = trajectory.getWaypointDurationFromStart(trajectory.getWayPointCount() - 1);
+  }
+
+  std::sort(result.compute_times_.begin(), result.compute_times_.end());
+  return result;
+}
+
+void printHeader()
+{
+  std::cout << std::left << std::setw(22) << "method" << std::right << std::setw(5) << "dof" << std::setw(10)
+            << "waypoints" << std::setw(12) << "calc p50" << std::setw(12) << "calc p90" << std::setw(12)
+            << "calc max" << std::setw(12) << "duration" << std::setw(10) << "relative" << std::setw(10)
+            << "failures" << std::endl;
+}
+
+void printResult(const std::string &method, std::size_t dof, std::size_t waypoints, const Result &result,
+                 double reference_duration)
+{
+  std::cout << std::left << std::setw(22) << method << std::right << std::setw(5) << dof << std::setw(10)
+            << waypoints << std::fixed << std::setprecision(3) << std::setw(12)
+            << 1e3 * percentile(result.compute_times_, 0.5) << std::setw(12)
+            << 1e3 * percentile(result.compute_times_, 0.9) << std::setw(12)
+            << 1e3 * percentile(result.compute_times_, 1.0) << std::setw(12) << result.duration_ << std::setw(10)
+            << (reference_duration > 0 ? result.duration_ / reference_duration : 0.0) << std::setw(10)
+            << result.failures_ << std::endl;
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, NAME);
+
+  // Settings
+  ros::NodeHandle nh("~");
+  std::vector<int> dofs;
+  std::vector<int> waypoint_counts;
+  std::vector<std::string> methods;
+  int iterations;
+  int warmup;
+  double max_jerk;
+  double amplitude;
+  nh.param("dofs", dofs, std::vector<int>{ 6, 12 });
+  nh.param("waypoints", waypoint_counts, std::vector<int>{ 10, 100, 1000 });
+  nh.param("methods", methods, moveit_boilerplate::getTimeParameterizationNames());
+  nh.param("iterations", iterations, 20);
+  nh.param("warmup", warmup, 2);
+  nh.param("max_jerk", max_jerk, moveit_boilerplate::JerkLimitedParameterization::DEFAULT_MAX_JERK);
+  nh.param("amplitude", amplitude, 1.0);
+
+  std::vector<moveit_boilerplate::TimeParameterizationPtr> parameterizations;
+  for (std::size_t m = 0; m < methods.size(); ++m)
+  {
+    moveit_boilerplate::TimeParameterizationPtr parameterization =
+        moveit_boilerplate::createTimeParameterization(methods[m], max_jerk);
+    if (!parameterization)
+      return 1;
+    parameterizations.push_back(parameterization);
+  }
+
+  std::cout << "Computation time (calc) in milliseconds and trajectory duration in seconds, " << iterations
+            << " iterations each. Relative is the duration compared to the first method" << std::endl;
+  printHeader();
+
+  for (std::size_t d = 0; d < dofs.size() && ros::ok(); ++d)
+  {
+    const std::size_t dof = dofs[d];
+
+    // Fresh robot model for this number of joints
+    moveit_boilerplate::setBenchmarkRobotParams("robot_description", dof);
+    robot_model_loader::RobotModelLoader robot_model_loader("robot_description");
+    const robot_model::RobotModelPtr &robot_model = robot_model_loader.getModel();
+    if (!robot_model)
+    {
+      ROS_ERROR_STREAM_NAMED(NAME, "Unable to load the " << dof << " DOF benchmark robot");
+      return 1;
+    }
+    const robot_model::JointModelGroup *jmg = robot_model->getJointModelGroup("arm");
+
+    for (std::size_t w = 0; w < waypoint_counts.size() && ros::ok(); ++w)
+    {
+      const std::size_t waypoints = waypoint_counts[w];
+      const std::vector<moveit::core::RobotStatePtr> path = makePath(robot_model, jmg, waypoints, amplitude);
+
+      double reference_duration = 0;
+      for (std::size_t m = 0; m < parameterizations.size() && ros::ok(); ++m)
+      {
+        Result result = runBenchmark(*parameterizations[m], robot_model, jmg, path, iterations, warmup);
+        if (m == 0)
+          reference_duration = result.duration_;
+        printResult(parameterizations[m]->getName(), dof, waypoints, result, reference_duration);
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Reuses parameterized trajectories of motions that are repeated from the same start state
+*/
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+// this package
+#include <moveit_boilerplate/trajectory_cache.h>
+
+namespace moveit_boilerplate
+{
+bool TrajectoryCache::Key::operator<(const Key &other) const
+{
+  if (velocity_ != other.velocity_)
+    return velocity_ < other.velocity_;
+  if (start_ != other.start_)
+    return start_ < other.start_;
+  if (target_ != other.target_)
+    return target_ < other.target_;
+  return group_ < other.group_;
+}
+
+TrajectoryCache::TrajectoryCache(std::size_t capacity, double quantization, double start_tolerance)
+  : capacity_(std::max<std::size_t>(1, capacity)), quantization_(quantization), start_tolerance_(start_tolerance)
+{
+  if (quantization_ < start_tolerance_)
+  {
+    ROS_WARN_STREAM_NAMED(name_, "Quantization " << quantization_ << " is below the start tolerance, using "
+                                                 << start_tolerance_);
+    quantization_ = start_tolerance_;
+  }
+  if (quantization_ <= 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Quantization must be positive, using " << ActiveVariableCache::DEFAULT_THRESHOLD);
+    quantization_ = ActiveVariableCache::DEFAULT_THRESHOLD;
+  }
+}
+
+robot_trajectory::RobotTrajectoryPtr TrajectoryCache::lookup(const moveit::core::RobotState &start_state,
+                                                             JointModelGroup *jmg, const std::string &target,
+                                                             double velocity_scaling_factor, std::size_t scene_version)
+{
+  Key key;
+  std::vector<double> start_positions;
+  makeKey(start_state, jmg, target, velocity_scaling_factor, key, start_positions);
+
+  boost::mutex::scoped_lock lock(mutex_);
+  checkSceneVersion(scene_version);
+
+  std::map<Key, Entry>::iterator it = entries_.find(key);
+  if (it == entries_.end() ||
+      ActiveVariableCache::maxAbsDifference(start_positions.data(), it->second.start_positions_.data(),
+                                            start_positions.size()) > start_tolerance_)
+  {
+    miss_count_++;
+    return robot_trajectory::RobotTrajectoryPtr();
+  }
+
+  // Mark as most recently used
+  recent_keys_.splice(recent_keys_.begin(), recent_keys_, it->second.recent_);
+  hit_count_++;
+  return it->second.trajectory_;
+}
+
+void TrajectoryCache::insert(const moveit::core::RobotState &start_state, JointModelGroup *jmg,
+                             const std::string &target, double velocity_scaling_factor, std::size_t scene_version,
+                             const robot_trajectory::RobotTrajectoryPtr &trajectory)
+{
+  Key key;
+  std::vector<double> start_positions;
+  makeKey(start_state, jmg, target, velocity_scaling_factor, key, start_positions);
+
+  boost::mutex::scoped_lock lock(mutex_);
+  checkSceneVersion(scene_version);
+
+  std::map<Key, Entry>::iterator it = entries_.find(key);
+  if (it == entries_.end())
+  {
+    if (entries_.size() >= capacity_)
+    {
+      entries_.erase(recent_keys_.back());
+      recent_keys_.pop_back();
+    }
+    recent_keys_.push_front(key);
+    it = entries_.insert(std::make_pair(key, Entry())).first;
+    it->second.recent_ = recent_keys_.begin();
+  }
+  else
+    recent_keys_.splice(recent_keys_.begin(), recent_keys_, it->second.recent_);
+
+  it->second.trajectory_ = trajectory;
+  it->second.start_positions_.swap(start_positions);
+}
+
+void TrajectoryCache::clear()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  entries_.clear();
+  recent_keys_.clear();
+}
+
+std::size_t TrajectoryCache::size() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+std::size_t TrajectoryCache::getHitCount() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return hit_count_;
+}
+
+std::size_t TrajectoryCache::getMissCount() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return miss_count_;
+}
+
+void TrajectoryCache::makeKey(const moveit::core::RobotState &start_state, JointModelGroup *jmg,
+                              const std::string &target, double velocity_scaling_factor, Key &key,
+                              std::vector<double> &start_positions)
+{
+  const std::vector<int> &indices = active_variables_.getActiveVariables(jmg).indices_;
+  const double *positions = start_state.getVariablePositions();
+
+  key.group_ = jmg->getName();
+  key.target_ = target;
+  key.velocity_ = std::llround(velocity_scaling_factor / ActiveVariableCache::DEFAULT_THRESHOLD);
+  key.start_.resize(indices.size());
+  for (std::size_t i = 0; i < indices.size(); ++i)
+    key.start_[i] = std::llround(positions[indices[i]] / quantization_);
+
+  // Every joint can collide with the trajectory, not only the group's
+  start_positions.assign(positions, positions + start_state.getVariableCount());
+}
+
+void TrajectoryCache::checkSceneVersion(std::size_t scene_version)
+{
+  if (scene_version == scene_version_)
+    return;
+
+  if (!entries_.empty())
+    ROS_DEBUG_STREAM_NAMED(name_, "Planning scene changed, dropping " << entries_.size() << " trajectories");
+  entries_.clear();
+  recent_keys_.clear();
+  scene_version_ = scene_version;
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,274 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Convert CSV trajectory files to the compressed format and report the compression ratio and maximum error
+*/
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+// ROS
+#include <ros/ros.h>
+
+// this package
+#include <moveit_boilerplate/compressed_trajectory.h>
+#include <moveit_boilerplate/csv_reader.h>
+
+namespace
+{
+namespace fs = boost::filesystem;
+typedef std::chrono::steady_clock Clock;
+
+const std::string NAME = "trajectory_compress";
+
+/** \brief Totals over all converted files */
+struct Summary
+{
+  std::size_t files_ = 0;
+  std::size_t failures_ = 0;
+  std::uintmax_t csv_bytes_ = 0;
+  std::uintmax_t compressed_bytes_ = 0;
+  double position_error_ = 0;
+  double velocity_error_ = 0;
+  double acceleration_error_ = 0;
+  double time_error_ = 0;
+  std::size_t waypoints_ = 0;
+  double decode_seconds_ = 0;
+};
+
+/** \brief Largest absolute difference between two arrays of the same size */
+double maxError(const std::vector<double> &original, const std::vector<double> &decoded)
+{
+  double error = 0;
+  for (std::size_t i = 0; i < original.size(); ++i)
+    error = std::max(error, std::abs(original[i] - decoded[i]));
+  return error;
+}
+
+/**
+ * \brief Parse a CSV file into trajectory data
+ *        Files written by ExecutionInterface::saveTrajectory() start with a header of time_from_start followed by the
+ *        position, velocity and acceleration of each joint. Files without that header hold only positions, like the
+ *        ones written by TrajectoryIO::saveJointTrajectoryToFile()
+ * \return true on success
+ */
+bool parseCSV(const std::string &file_name, moveit_boilerplate::CSVReader &csv_reader,
+              moveit_boilerplate::TrajectoryData &data)
+{
+  std::ifstream input_file(file_name.c_str(), std::ios::binary);
+  const std::string contents((std::istreambuf_iterator<char>(input_file)), std::istreambuf_iterator<char>());
+  if (!input_file)
+  {
+    ROS_ERROR_STREAM_NAMED(NAME, "Unable to read " << file_name);
+    return false;
+  }
+
+  data = moveit_boilerplate::TrajectoryData();
+  const std::string header = contents.substr(0, contents.find('\n'));
+  const bool executed = header.compare(0, 15, "time_from_start") == 0;
+  if (!csv_reader.parse(contents.data(), contents.size(), executed ? 1 : 0))
+    return false;
+  const std::size_t columns = csv_reader.getColumnCount();
+  const std::size_t rows = csv_reader.getRowCount();
+
+  if (!executed)
+  {
+    data.num_variables_ = columns;
+    data.positions_.reserve(rows * columns);
+    for (std::size_t i = 0; i < rows; ++i)
+      data.positions_.insert(data.positions_.end(), csv_reader.getRow(i), csv_reader.getRow(i) + columns);
+    return true;
+  }
+
+  // Joint names are the header's position columns without their suffix
+  std::size_t start = header.find(',');
+  while (start != std::string::npos && start + 1 < header.size())
+  {
+    const std::size_t end = header.find(',', start + 1);
+    const std::string column = header.substr(start + 1, end == std::string::npos ? end : end - start - 1);
+    if (column.size() > 4 && column.compare(column.size() - 4, 4, "_pos") == 0)
+      data.variable_names_.push_back(column.substr(0, column.size() - 4));
+    start = end;
+  }
+  data.num_variables_ = data.variable_names_.size();
+  if (rows > 0 && columns != 1 + 3 * data.num_variables_)
+  {
+    ROS_ERROR_STREAM_NAMED(NAME, file_name << " has " << columns << " columns, expected "
+                                           << 1 + 3 * data.num_variables_ << " for its header");
+    return false;
+  }
+
+  for (std::size_t i = 0; i < rows; ++i)
+  {
+    const double *row = csv_reader.getRow(i);
+    data.times_.push_back(row[0]);
+    for (std::size_t j = 0; j < data.num_variables_; ++j)
+    {
+      data.positions_.push_back(row[1 + 3 * j]);
+      data.velocities_.push_back(row[2 + 3 * j]);
+      data.accelerations_.push_back(row[3 + 3 * j]);
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Compress one file, decode it again and compare
+ * \return true if the file was converted and every value is within its error bound
+ */
+bool convert(const std::string &input_file, const std::string &output_file,
+             const moveit_boilerplate::CompressionOptions &options, moveit_boilerplate::CSVReader &csv_reader,
+             Summary &summary)
+{
+  moveit_boilerplate::TrajectoryData original;
+  if (!parseCSV(input_file, csv_reader, original))
+    return false;
+
+  if (fs::path(output_file).has_parent_path())
+    fs::create_directories(fs::path(output_file).parent_path());
+  if (!moveit_boilerplate::CompressedTrajectoryFile::write(output_file, original, options))
+    return false;
+
+  const Clock::time_point start = Clock::now();
+  moveit_boilerplate::CompressedTrajectoryFile file;
+  moveit_boilerplate::TrajectoryData decoded;
+  if (!file.open(output_file) || !file.read(decoded))
+    return false;
+  const double decode_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  const double position_error = maxError(original.positions_, decoded.positions_);
+  const double velocity_error = maxError(original.velocities_, decoded.velocities_);
+  const double acceleration_error = maxError(original.accelerations_, decoded.accelerations_);
+  const double time_error = maxError(original.times_, decoded.times_);
+
+  const std::uintmax_t csv_bytes = fs::file_size(input_file);
+  const std::uintmax_t compressed_bytes = fs::file_size(output_file);
+  ROS_INFO_STREAM_NAMED(NAME, input_file << ": " << original.getWaypointCount() << " waypoints, " << csv_bytes
+                                         << " -> " << compressed_bytes << " bytes, ratio "
+                                         << static_cast<double>(csv_bytes) / compressed_bytes
+                                         << ", max position error " << position_error << ", decoded in "
+                                         << decode_seconds * 1000.0 << " ms");
+
+  summary.csv_bytes_ += csv_bytes;
+  summary.compressed_bytes_ += compressed_bytes;
+  summary.position_error_ = std::max(summary.position_error_, position_error);
+  summary.velocity_error_ = std::max(summary.velocity_error_, velocity_error);
+  summary.acceleration_error_ = std::max(summary.acceleration_error_, acceleration_error);
+  summary.time_error_ = std::max(summary.time_error_, time_error);
+  summary.waypoints_ += original.getWaypointCount();
+  summary.decode_seconds_ += decode_seconds;
+
+  // Allow for the rounding of the reconstruction itself
+  const double tolerance = 1.0 + 1e-6;
+  return position_error <= options.position_error_ * tolerance &&
+         velocity_error <= options.velocity_error_ * tolerance &&
+         acceleration_error <= options.acceleration_error_ * tolerance && time_error <= options.time_error_ * tolerance;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2 || argc > 5)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " <trajectory.csv or directory> [output_directory] [position_error] [block_size]" << std::endl;
+    return 1;
+  }
+  const fs::path input(argv[1]);
+  const std::string output_directory = argc > 2 ? argv[2] : "";
+  moveit_boilerplate::CompressionOptions options;
+  if (argc > 3)
+    options.position_error_ = std::atof(argv[3]);
+  if (argc > 4)
+    options.block_size_ = std::atoi(argv[4]);
+
+  // Convert a single file or every CSV file below a directory
+  std::vector<fs::path> files;
+  if (fs::is_directory(input))
+  {
+    for (fs::recursive_directory_iterator it(input), end; it != end; ++it)
+      if (fs::is_regular_file(it->status()) && it->path().extension() == ".csv")
+        files.push_back(it->path());
+    std::sort(files.begin(), files.end());
+  }
+  else
+    files.push_back(input);
+
+  Summary summary;
+  moveit_boilerplate::CSVReader csv_reader;
+  for (std::size_t i = 0; i < files.size(); ++i)
+  {
+    // Write next to the CSV file, or to the same place below the output directory
+    fs::path output_file = files[i];
+    if (!output_directory.empty())
+    {
+      const std::string relative = fs::is_directory(input) ? files[i].string().substr(input.string().size()) :
+                                                             files[i].filename().string();
+      output_file = fs::path(output_directory) / relative;
+    }
+    output_file.replace_extension(".ctraj");
+
+    summary.files_++;
+    if (!convert(files[i].string(), output_file.string(), options, csv_reader, summary))
+    {
+      ROS_ERROR_STREAM_NAMED(NAME, "Failed to convert " << files[i].string());
+      summary.failures_++;
+    }
+  }
+
+  ROS_INFO_STREAM_NAMED(NAME, "Converted " << summary.files_ - summary.failures_ << " of " << summary.files_
+                                           << " files, " << summary.csv_bytes_ << " -> " << summary.compressed_bytes_
+                                           << " bytes, ratio "
+                                           << static_cast<double>(summary.csv_bytes_) /
+                                                  std::max<std::uintmax_t>(1, summary.compressed_bytes_));
+  ROS_INFO_STREAM_NAMED(NAME, "Max error: position " << summary.position_error_ << ", velocity "
+                                                     << summary.velocity_error_ << ", acceleration "
+                                                     << summary.acceleration_error_ << ", time "
+                                                     << summary.time_error_);
+  if (summary.decode_seconds_ > 0)
+    ROS_INFO_STREAM_NAMED(NAME, "Decoded " << summary.waypoints_ / summary.decode_seconds_ << " waypoints per second");
+  return summary.failures_ == 0 ? 0 : 1;
+}
@@ -41,6 +41,8 @@
 // C++
 #include <string>
 #include <algorithm>
+#include <cctype>
+#include <map>
 #include <vector>
 
 // MoveItManipuation
@@ -58,56 +60,49 @@
 
 namespace moveit_boilerplate
 {
-TrajectoryIO::TrajectoryIO(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools)
+TrajectoryIO::TrajectoryIO(psm::PlanningSceneMonitorPtr planning_scene_monitor, mvt::MoveItVisualToolsPtr visual_tools,
+                           CurrentStateSnapshotPtr state_snapshot)
   : name_("trajectory_io")
   , planning_scene_monitor_(planning_scene_monitor)
   , visual_tools_(visual_tools)
+  , state_snapshot_(state_snapshot)
+  , state_pool_(new RobotStatePool(planning_scene_monitor->getRobotModel()))
 {
-  // Create initial robot state
-  {
-    psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-    current_state_.reset(new moveit::core::RobotState(scene->getCurrentState()));
-  }  // end scoped pointer of locked planning scene
 }
 
 bool TrajectoryIO::loadJointTrajectoryFromFile(const std::string& file_name, JointModelGroup* arm_jmg, bool header)
 {
-  std::ifstream input_file;
-  input_file.open(file_name.c_str());
   ROS_DEBUG_STREAM_NAMED(name_, "Loading trajectory from file " << file_name);
 
-  std::string line;
-  getCurrentState();
+  // Check if the first line of the CSV should be skipped
+  if (!csv_reader_.parseFile(file_name, header ? 1 : 0))
+    return false;
 
-  joint_trajectory_.reset(new robot_trajectory::RobotTrajectory(current_state_->getRobotModel(), arm_jmg));
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+  joint_trajectory_.reset(new robot_trajectory::RobotTrajectory(current_state->getRobotModel(), arm_jmg));
   double dummy_dt = 1;  // temp value
 
-  // Read each line
-  while (std::getline(input_file, line))
-  {
-    // Check if the first line of the CSV should be skipped
-    if (header)
-    {
-      header = false;
-      continue;
-    }
-
-    // Convert line to a robot state
-    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(*current_state_));
-    moveit::core::streamToRobotState(*new_state, line, ",");
-    joint_trajectory_->addSuffixWayPoint(new_state, dummy_dt);
-  }
-
-  ROS_DEBUG_STREAM_NAMED(name_, "Closing file");
-  // Close file
-  input_file.close();
-
   // Error check
-  if (joint_trajectory_->getWayPointCount() == 0)
+  if (csv_reader_.getRowCount() == 0)
   {
     ROS_ERROR_STREAM_NAMED(name_, "No states loaded from CSV file " << file_name);
     return false;
   }
+  if (csv_reader_.getColumnCount() < current_state->getVariableCount())
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "CSV file " << file_name << " has " << csv_reader_.getColumnCount()
+                                              << " columns, the robot has " << current_state->getVariableCount()
+                                              << " variables");
+    return false;
+  }
+
+  // Convert each row to a robot state
+  for (std::size_t i = 0; i < csv_reader_.getRowCount(); ++i)
+  {
+    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(*current_state));
+    new_state->setVariablePositions(csv_reader_.getRow(i));
+    joint_trajectory_->addSuffixWayPoint(new_state, dummy_dt);
+  }
 
   return true;
 }
@@ -117,12 +112,12 @@ bool TrajectoryIO::loadJointTrajectoryFromStream(std::istringstream& input_strea
   ROS_DEBUG_STREAM_NAMED(name_, "Loading trajectory from string.");
 
   std::string line;
-  getCurrentState();
-  joint_trajectory_.reset(new robot_trajectory::RobotTrajectory(current_state_->getRobotModel(), arm_jmg));
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+  joint_trajectory_.reset(new robot_trajectory::RobotTrajectory(current_state->getRobotModel(), arm_jmg));
   double dummy_dt = 1;  // temp value
 
   std::cout << "var names: " << std::endl;
-  std::copy(current_state_->getVariableNames().begin(), current_state_->getVariableNames().end(),
+  std::copy(current_state->getVariableNames().begin(), current_state->getVariableNames().end(),
             std::ostream_iterator<std::string>(std::cout, "\n"));
 
   // Read each line
@@ -135,7 +130,7 @@ bool TrajectoryIO::loadJointTrajectoryFromStream(std::istringstream& input_strea
     std::cout << "line: " << line << std::endl;
 
     // Convert line to a robot state
-    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(*current_state_));
+    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(*current_state));
     moveit::core::streamToRobotState(*new_state, line);
     joint_trajectory_->addSuffixWayPoint(new_state, dummy_dt);
   }
@@ -170,34 +165,181 @@ bool TrajectoryIO::saveJointTrajectoryToFile(const std::string& file_path)
   return true;
 }
 
+bool TrajectoryIO::loadJointTrajectoryFromBinaryFile(const std::string& file_name, JointModelGroup* arm_jmg)
+{
+  ROS_DEBUG_STREAM_NAMED(name_, "Loading binary trajectory from file " << file_name);
+  BinaryTrajectoryFile file;
+  if (!file.open(file_name))
+    return false;
+
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+  const moveit::core::RobotModelConstPtr& robot_model = current_state->getRobotModel();
+
+  // Releases the previous trajectory's states to the pool before taking new ones
+  joint_trajectory_.reset(new robot_trajectory::RobotTrajectory(robot_model, arm_jmg));
+  std::vector<moveit::core::RobotStatePtr> states;
+  state_pool_->acquire(file.getWaypointCount(), *current_state, states);
+
+  // Match the file's columns to the robot's variables by name
+  const std::vector<std::string>& robot_variables = robot_model->getVariableNames();
+  std::vector<std::size_t> file_columns;
+  std::vector<std::size_t> state_indices;
+  matchVariableNames(file.getVariableNames(), file_columns, state_indices);
+
+  const double* times = file.getTimes();
+  std::vector<double> values(current_state->getVariablePositions(),
+                             current_state->getVariablePositions() + robot_variables.size());
+  std::vector<double> derivatives(robot_variables.size(), 0.0);
+  for (std::size_t waypoint = 0; waypoint < file.getWaypointCount(); ++waypoint)
+  {
+    const moveit::core::RobotStatePtr& new_state = states[waypoint];
+
+    for (std::size_t j = 0; j < file_columns.size(); ++j)
+      values[state_indices[j]] = file.getPositions(file_columns[j])[waypoint];
+    new_state->setVariablePositions(values.data());
+
+    if (file.getVelocities(0))
+    {
+      for (std::size_t j = 0; j < file_columns.size(); ++j)
+        derivatives[state_indices[j]] = file.getVelocities(file_columns[j])[waypoint];
+      new_state->setVariableVelocities(derivatives.data());
+    }
+    if (file.getAccelerations(0))
+    {
+      for (std::size_t j = 0; j < file_columns.size(); ++j)
+        derivatives[state_indices[j]] = file.getAccelerations(file_columns[j])[waypoint];
+      new_state->setVariableAccelerations(derivatives.data());
+    }
+
+    joint_trajectory_->addSuffixWayPoint(new_state, waypoint > 0 ? times[waypoint] - times[waypoint - 1] : times[0]);
+  }
+
+  // Error check
+  if (joint_trajectory_->getWayPointCount() == 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "No states loaded from binary file " << file_name);
+    return false;
+  }
+
+  return true;
+}
+
+bool TrajectoryIO::saveJointTrajectoryToBinaryFile(const std::string& file_name)
+{
+  ROS_DEBUG_STREAM_NAMED(name_, "Saving binary joint trajectory to file " << file_name);
+  return BinaryTrajectoryFile::write(file_name, *joint_trajectory_);
+}
+
+bool TrajectoryIO::loadJointTrajectoryFromCompressedFile(const std::string& file_name, JointModelGroup* arm_jmg)
+{
+  ROS_DEBUG_STREAM_NAMED(name_, "Loading compressed trajectory from file " << file_name);
+  CompressedTrajectoryFile file;
+  TrajectoryData data;
+  if (!file.open(file_name) || !file.read(data))
+    return false;
+
+  moveit::core::RobotStatePtr current_state = getCurrentState();
+  const moveit::core::RobotModelConstPtr& robot_model = current_state->getRobotModel();
+  joint_trajectory_.reset(new robot_trajectory::RobotTrajectory(robot_model, arm_jmg));
+
+  // Files without names hold all of the robot's variables in order, like CSV files
+  const std::size_t num_variables = robot_model->getVariableCount();
+  std::vector<std::size_t> file_columns;
+  std::vector<std::size_t> state_indices;
+  if (!data.variable_names_.empty())
+    matchVariableNames(data.variable_names_, file_columns, state_indices);
+  else if (data.num_variables_ >= num_variables)
+  {
+    for (std::size_t i = 0; i < num_variables; ++i)
+    {
+      file_columns.push_back(i);
+      state_indices.push_back(i);
+    }
+  }
+  else
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Compressed file " << file_name << " has " << data.num_variables_
+                                                     << " variables, the robot has " << num_variables);
+    return false;
+  }
+
+  std::vector<double> values(current_state->getVariablePositions(),
+                             current_state->getVariablePositions() + num_variables);
+  std::vector<double> derivatives(num_variables, 0.0);
+  double dummy_dt = 1;  // temp value for files without times
+  for (std::size_t waypoint = 0; waypoint < data.getWaypointCount(); ++waypoint)
+  {
+    moveit::core::RobotStatePtr new_state(new moveit::core::RobotState(*current_state));
+    const std::size_t row = waypoint * data.num_variables_;
+
+    for (std::size_t j = 0; j < file_columns.size(); ++j)
+      values[state_indices[j]] = data.positions_[row + file_columns[j]];
+    new_state->setVariablePositions(values.data());
+
+    if (!data.velocities_.empty())
+    {
+      for (std::size_t j = 0; j < file_columns.size(); ++j)
+        derivatives[state_indices[j]] = data.velocities_[row + file_columns[j]];
+      new_state->setVariableVelocities(derivatives.data());
+    }
+    if (!data.accelerations_.empty())
+    {
+      for (std::size_t j = 0; j < file_columns.size(); ++j)
+        derivatives[state_indices[j]] = data.accelerations_[row + file_columns[j]];
+      new_state->setVariableAccelerations(derivatives.data());
+    }
+
+    double dt = dummy_dt;
+    if (!data.times_.empty())
+      dt = waypoint > 0 ? data.times_[waypoint] - data.times_[waypoint - 1] : data.times_[0];
+    joint_trajectory_->addSuffixWayPoint(new_state, dt);
+  }
+
+  // Error check
+  if (joint_trajectory_->getWayPointCount() == 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "No states loaded from compressed file " << file_name);
+    return false;
+  }
+
+  return true;
+}
+
+bool TrajectoryIO::saveJointTrajectoryToCompressedFile(const std::string& file_name,
+                                                      const CompressionOptions& options)
+{
+  ROS_DEBUG_STREAM_NAMED(name_, "Saving compressed joint trajectory to file " << file_name);
+  return CompressedTrajectoryFile::write(file_name, *joint_trajectory_, options);
+}
+
 bool TrajectoryIO::loadCartTrajectoryFromFile(const std::string& file_name)
 {
-  std::ifstream input_file;
-  std::string line;
-  input_file.open(file_name.c_str());
   ROS_DEBUG_STREAM_NAMED(name_, "Loading waypoints from file " << file_name);
+  if (!csv_reader_.parseFile(file_name))
+    return false;
 
-  // Read each line
-  while (std::getline(input_file, line))
+  // Each row is x, y, z, roll, pitch, yaw, seconds
+  static const std::size_t NUM_COLUMNS = 7;
+  if (csv_reader_.getRowCount() > 0 && csv_reader_.getColumnCount() < NUM_COLUMNS)
   {
-    // Ignore empty lines
-    if (line.empty())
-      continue;
+    ROS_ERROR_STREAM_NAMED(name_, "CSV file " << file_name << " has " << csv_reader_.getColumnCount()
+                                              << " columns, expected " << NUM_COLUMNS);
+    return false;
+  }
 
-    // Convert line to a robot state
-    Eigen::Affine3d pose;
-    double sec;
-    streamToAffine3d(pose, sec, line);
+  cartesian_trajectory_.reserve(cartesian_trajectory_.size() + csv_reader_.getRowCount());
+  for (std::size_t i = 0; i < csv_reader_.getRowCount(); ++i)
+  {
+    const double* row = csv_reader_.getRow(i);
+    Eigen::Affine3d pose = rvt::RvizVisualTools::convertFromXYZRPY(row[0], row[1], row[2], row[3], row[4], row[5],
+                                                                   rviz_visual_tools::XYZ);
 
     // Debug
     visual_tools_->publishZArrow(pose, rvt::RED);
 
-    cartesian_trajectory_.push_back(TimePose(sec, pose));
+    cartesian_trajectory_.push_back(TimePose(row[6], pose));
   }
 
-  // Close file
-  input_file.close();
-
   // Error check
   if (cartesian_trajectory_.empty())
   {
@@ -245,6 +387,22 @@ bool TrajectoryIO::getFilePath(std::string& file_path, const std::string& file_n
 {
   namespace fs = boost::filesystem;
 
+  std::string directory;
+  if (!getTrajectoryDirectory(directory))
+    return false;
+
+  // Append the group name as the file name
+  fs::path path = fs::path(directory) / fs::path(file_name + ".csv");
+  file_path = path.string();
+
+  ROS_DEBUG_STREAM_NAMED("manipulation.file_path", "Using full file path" << file_path);
+  return true;
+}
+
+bool TrajectoryIO::getTrajectoryDirectory(std::string& directory)
+{
+  namespace fs = boost::filesystem;
+
   // Get package path
   if (package_path_.empty())
     package_path_ = ros::package::getPath("moveit_boilerplate");
@@ -268,18 +426,14 @@ bool TrajectoryIO::getFilePath(std::string& file_path, const std::string& file_n
     return false;
   }
 
-  // Directories successfully created, append the group name as the file name
-  path = path / fs::path(file_name + ".csv");
-  file_path = path.string();
-
-  ROS_DEBUG_STREAM_NAMED("manipulation.file_path", "Using full file path" << file_path);
+  directory = path.string();
   return true;
 }
 
 bool TrajectoryIO::streamToAffine3d(Eigen::Affine3d& pose, double& sec, const std::string& line)
 {
-  std::stringstream line_stream(line);
-  std::string cell;
+  const char* cell = line.c_str();
+  const char* end = cell + line.size();
   std::vector<double> transform6;
   transform6.resize(6);
 
@@ -287,36 +441,59 @@ bool TrajectoryIO::streamToAffine3d(Eigen::Affine3d& pose, double& sec, const st
   for (std::size_t i = 0; i < transform6.size(); ++i)
   {
     // Get a variable
-    if (!std::getline(line_stream, cell, ','))
+    while (cell < end && std::isblank(*cell))
+      ++cell;
+    cell = cell < end ? CSVReader::parseDouble(cell, end, transform6[i]) : NULL;
+    if (!cell)
     {
-      ROS_ERROR_STREAM_NAMED(name_, "Missing variable " << i << " on cell '" << cell << "' line '" << line
-                                                                  << "'");
+      ROS_ERROR_STREAM_NAMED(name_, "Missing variable " << i << " on line '" << line << "'");
       return false;
     }
-
-    transform6[i] = atof(cell.c_str());  // TODO(davetcoleman) improve with boost cast
+    cell = std::find(cell, end, ',');
+    cell += cell < end ? 1 : 0;
   }
 
   // Get time
-  if (!std::getline(line_stream, cell, ','))
+  while (cell < end && std::isblank(*cell))
+    ++cell;
+  if (cell >= end || !CSVReader::parseDouble(cell, end, sec))
   {
     ROS_WARN_STREAM_NAMED(name_, "No time available");
     return false;
   }
 
-  sec = atof(cell.c_str());  // TODO(davetcoleman) improve with boost cast
-
   // Convert to eigen
   pose = rvt::RvizVisualTools::convertFromXYZRPY(transform6, rviz_visual_tools::XYZ);
 
   return true;
 }
 
+void TrajectoryIO::matchVariableNames(const std::vector<std::string>& file_variables,
+                                      std::vector<std::size_t>& file_columns, std::vector<std::size_t>& state_indices)
+{
+  const std::vector<std::string>& robot_variables = planning_scene_monitor_->getRobotModel()->getVariableNames();
+  std::map<std::string, std::size_t> robot_indices;
+  for (std::size_t i = 0; i < robot_variables.size(); ++i)
+    robot_indices[robot_variables[i]] = i;
+
+  file_columns.clear();
+  state_indices.clear();
+  for (std::size_t i = 0; i < file_variables.size(); ++i)
+  {
+    std::map<std::string, std::size_t>::const_iterator it = robot_indices.find(file_variables[i]);
+    if (it == robot_indices.end())
+    {
+      ROS_WARN_STREAM_NAMED(name_, "Ignoring variable " << file_variables[i] << " not in robot model");
+      continue;
+    }
+    file_columns.push_back(i);
+    state_indices.push_back(it->second);
+  }
+}
+
 moveit::core::RobotStatePtr TrajectoryIO::getCurrentState()
 {
-  // Get the real current state
-  psm::LockedPlanningSceneRO scene(planning_scene_monitor_);  // Lock planning scene
-  (*current_state_) = scene->getCurrentState();
+  state_snapshot_->update(current_state_, current_state_version_, current_scene_version_);
   return current_state_;
 }
 
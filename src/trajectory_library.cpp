@@ -0,0 +1,390 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Loads a directory of trajectory files in parallel into a named index with a memory budget
+*/
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <set>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+// this package
+#include <moveit_boilerplate/trajectory_library.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+/** \brief True for the extensions of files written by TrajectoryIO */
+bool isTrajectoryFile(const boost::filesystem::path &path)
+{
+  const std::string extension = path.extension().string();
+  return extension == ".csv" || extension == ".bin" || extension == ".ctraj";
+}
+
+/** \brief Trajectory files directly in a directory, sorted so that the load order does not depend on the OS */
+std::vector<boost::filesystem::path> listTrajectoryFiles(const boost::filesystem::path &directory)
+{
+  namespace fs = boost::filesystem;
+  std::vector<fs::path> files;
+  boost::system::error_code error;
+  for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    if (fs::is_regular_file(it->status()) && isTrajectoryFile(it->path()))
+      files.push_back(it->path());
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+}  // namespace
+
+TrajectoryLibrary::TrajectoryLibrary(psm::PlanningSceneMonitorPtr planning_scene_monitor,
+                                     CurrentStateSnapshotPtr state_snapshot, std::size_t memory_budget,
+                                     std::size_t num_threads)
+  : planning_scene_monitor_(planning_scene_monitor)
+  , state_snapshot_(state_snapshot)
+  , thread_pool_(num_threads)
+  , memory_budget_(memory_budget)
+{
+}
+
+bool TrajectoryLibrary::loadDirectory(const std::string &directory, JointModelGroup *default_jmg)
+{
+  namespace fs = boost::filesystem;
+  const Clock::time_point start = Clock::now();
+
+  const fs::path root(directory);
+  if (!fs::is_directory(root))
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Trajectory directory " << root.string() << " does not exist");
+    return false;
+  }
+
+  // Find the files and the group each belongs to
+  std::vector<fs::path> files = listTrajectoryFiles(root);
+  std::vector<JointModelGroup *> jmgs(files.size(), default_jmg);
+  std::vector<fs::path> subdirectories;
+  boost::system::error_code error;
+  for (fs::directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+    if (fs::is_directory(it->status()))
+      subdirectories.push_back(it->path());
+  std::sort(subdirectories.begin(), subdirectories.end());
+
+  const moveit::core::RobotModelConstPtr &robot_model = planning_scene_monitor_->getRobotModel();
+  for (std::size_t i = 0; i < subdirectories.size(); ++i)
+  {
+    const std::string group = subdirectories[i].filename().string();
+    if (!robot_model->hasJointModelGroup(group))
+    {
+      ROS_DEBUG_STREAM_NAMED(name_, "Ignoring directory " << subdirectories[i].string() << ", not a planning group");
+      continue;
+    }
+    const std::vector<fs::path> group_files = listTrajectoryFiles(subdirectories[i]);
+    files.insert(files.end(), group_files.begin(), group_files.end());
+    jmgs.resize(files.size(), robot_model->getJointModelGroup(group));
+  }
+
+  // Name each file, the first of several with the same name and group wins
+  std::set<Key> names;
+  std::vector<Key> keys;
+  std::vector<std::string> file_names;
+  std::vector<JointModelGroup *> file_jmgs;
+  for (std::size_t i = 0; i < files.size(); ++i)
+  {
+    const Key key(jmgs[i]->getName(), files[i].stem().string());
+    if (!names.insert(key).second)
+    {
+      ROS_WARN_STREAM_NAMED(name_, "Skipping " << files[i].string() << ", another file is already named " << key.second
+                                               << " in group " << key.first);
+      continue;
+    }
+    keys.push_back(key);
+    file_names.push_back(files[i].string());
+    file_jmgs.push_back(jmgs[i]);
+  }
+  ROS_INFO_STREAM_NAMED(name_, "Loading " << file_names.size() << " trajectories from " << root.string() << " on "
+                                          << thread_pool_.getNumThreads() << " threads");
+
+  // Load in parallel, each file is indexed as soon as it is ready
+  std::vector<TrajectoryLoadStats> report(file_names.size());
+  thread_pool_.parallelFor(0, file_names.size(), [&](std::size_t begin, std::size_t end)
+                           {
+                             for (std::size_t i = begin; i < end; ++i)
+                             {
+                               report[i].group_ = keys[i].first;
+                               report[i].name_ = keys[i].second;
+                               robot_trajectory::RobotTrajectoryPtr trajectory =
+                                   loadFile(file_names[i], file_jmgs[i], report[i]);
+                               if (!trajectory)
+                                 continue;
+
+                               boost::mutex::scoped_lock lock(mutex_);
+                               Entry &entry = index_[keys[i]];
+                               entry.file_ = file_names[i];
+                               entry.jmg_ = file_jmgs[i];
+                               storeLoaded(keys[i], entry, trajectory, report[i].memory_bytes_);
+                             }
+                           });
+
+  std::size_t failures = 0;
+  for (std::size_t i = 0; i < report.size(); ++i)
+    failures += !report[i].success_;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  load_report_.swap(report);
+  load_seconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+  if (failures > 0)
+    ROS_ERROR_STREAM_NAMED(name_, "Failed to load " << failures << " of " << load_report_.size() << " trajectories");
+  return failures == 0;
+}
+
+robot_trajectory::RobotTrajectoryPtr TrajectoryLibrary::getTrajectory(const std::string &group,
+                                                                      const std::string &name)
+{
+  const Key key(group, name);
+  std::string file;
+  JointModelGroup *jmg = NULL;
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    std::map<Key, Entry>::iterator it = index_.find(key);
+    if (it == index_.end())
+    {
+      ROS_WARN_STREAM_NAMED(name_, "No trajectory named " << name << " in group " << group);
+      return robot_trajectory::RobotTrajectoryPtr();
+    }
+
+    Entry &entry = it->second;
+    if (entry.trajectory_)
+    {
+      recent_keys_.splice(recent_keys_.begin(), recent_keys_, entry.recent_);
+      return entry.trajectory_;
+    }
+    file = entry.file_;
+    jmg = entry.jmg_;
+  }
+
+  // Reload an evicted trajectory without blocking other callers
+  ROS_DEBUG_STREAM_NAMED(name_, "Reloading evicted trajectory " << name << " from " << file);
+  TrajectoryLoadStats stats;
+  robot_trajectory::RobotTrajectoryPtr trajectory = loadFile(file, jmg, stats);
+  if (!trajectory)
+    return trajectory;
+
+  boost::mutex::scoped_lock lock(mutex_);
+  std::map<Key, Entry>::iterator it = index_.find(key);
+  if (it == index_.end())  // cleared in the meantime
+    return trajectory;
+  if (!it->second.trajectory_)
+    storeLoaded(key, it->second, trajectory, stats.memory_bytes_);
+  return it->second.trajectory_;
+}
+
+bool TrajectoryLibrary::hasTrajectory(const std::string &group, const std::string &name) const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return index_.count(Key(group, name)) > 0;
+}
+
+std::vector<std::string> TrajectoryLibrary::getTrajectoryNames(const std::string &group) const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  std::vector<std::string> names;
+  for (std::map<Key, Entry>::const_iterator it = index_.lower_bound(Key(group, "")); it != index_.end(); ++it)
+  {
+    if (it->first.first != group)
+      break;
+    names.push_back(it->first.second);
+  }
+  return names;
+}
+
+void TrajectoryLibrary::clear()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  index_.clear();
+  recent_keys_.clear();
+  memory_usage_ = 0;
+}
+
+std::size_t TrajectoryLibrary::getMemoryUsage() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return memory_usage_;
+}
+
+void TrajectoryLibrary::setMemoryBudget(std::size_t memory_budget)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  memory_budget_ = memory_budget;
+  evict();
+}
+
+std::vector<TrajectoryLoadStats> TrajectoryLibrary::getLoadReport() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  return load_report_;
+}
+
+void TrajectoryLibrary::printLoadReport() const
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  std::size_t file_bytes = 0;
+  std::size_t memory_bytes = 0;
+  for (std::size_t i = 0; i < load_report_.size(); ++i)
+  {
+    const TrajectoryLoadStats &stats = load_report_[i];
+    ROS_INFO_STREAM_NAMED(name_, stats.group_ << "/" << stats.name_ << ": "
+                                              << (stats.success_ ? "" : "FAILED, ") << stats.waypoints_
+                                              << " waypoints in " << stats.seconds_ * 1000.0 << " ms, "
+                                              << stats.file_bytes_ << " bytes on disk, " << stats.memory_bytes_
+                                              << " bytes in memory");
+    file_bytes += stats.file_bytes_;
+    memory_bytes += stats.memory_bytes_;
+  }
+  ROS_INFO_STREAM_NAMED(name_, "Loaded " << load_report_.size() << " files in " << load_seconds_ << " s, "
+                                         << file_bytes << " bytes on disk, " << memory_bytes << " bytes in memory, "
+                                         << memory_usage_ << " of " << memory_budget_ << " bytes kept");
+}
+
+std::size_t TrajectoryLibrary::estimateMemoryUsage(const robot_trajectory::RobotTrajectory &trajectory)
+{
+  // A RobotState allocates its positions, velocities and accelerations and a transform per joint, link and
+  // collision body of the model in one block
+  const moveit::core::RobotModelConstPtr &robot_model = trajectory.getRobotModel();
+  const std::size_t state_bytes = sizeof(moveit::core::RobotState) +
+                                  3 * robot_model->getVariableCount() * sizeof(double) +
+                                  (robot_model->getJointModelCount() + 2 * robot_model->getLinkModelCount()) *
+                                      sizeof(Eigen::Affine3d);
+
+  // Each waypoint also has a shared pointer with its control block and a duration
+  const std::size_t waypoint_bytes = state_bytes + sizeof(moveit::core::RobotStatePtr) + 2 * sizeof(void *) +
+                                     sizeof(double);
+  return sizeof(robot_trajectory::RobotTrajectory) + trajectory.getWayPointCount() * waypoint_bytes;
+}
+
+robot_trajectory::RobotTrajectoryPtr TrajectoryLibrary::loadFile(const std::string &file, JointModelGroup *jmg,
+                                                                 TrajectoryLoadStats &stats)
+{
+  namespace fs = boost::filesystem;
+  const Clock::time_point start = Clock::now();
+  stats.file_ = file;
+  boost::system::error_code error;
+  stats.file_bytes_ = fs::file_size(file, error);
+  if (error)
+    stats.file_bytes_ = 0;
+
+  TrajectoryIOPtr trajectory_io = acquireTrajectoryIO();
+  const fs::path extension = fs::path(file).extension();
+  if (extension == ".bin")
+    stats.success_ = trajectory_io->loadJointTrajectoryFromBinaryFile(file, jmg);
+  else if (extension == ".ctraj")
+    stats.success_ = trajectory_io->loadJointTrajectoryFromCompressedFile(file, jmg);
+  else
+    stats.success_ = trajectory_io->loadJointTrajectoryFromFile(file, jmg);
+
+  // Each load creates a new trajectory, so it is not changed by the next file loaded with this TrajectoryIO
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  if (stats.success_)
+    trajectory = trajectory_io->getJointTrajectory();
+  releaseTrajectoryIO(trajectory_io);
+
+  if (trajectory)
+  {
+    stats.waypoints_ = trajectory->getWayPointCount();
+    stats.memory_bytes_ = estimateMemoryUsage(*trajectory);
+  }
+  stats.seconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+  return trajectory;
+}
+
+TrajectoryIOPtr TrajectoryLibrary::acquireTrajectoryIO()
+{
+  {
+    boost::mutex::scoped_lock lock(trajectory_io_mutex_);
+    if (!idle_trajectory_io_.empty())
+    {
+      TrajectoryIOPtr trajectory_io = idle_trajectory_io_.back();
+      idle_trajectory_io_.pop_back();
+      return trajectory_io;
+    }
+  }
+  return TrajectoryIOPtr(new TrajectoryIO(planning_scene_monitor_, mvt::MoveItVisualToolsPtr(), state_snapshot_));
+}
+
+void TrajectoryLibrary::releaseTrajectoryIO(const TrajectoryIOPtr &trajectory_io)
+{
+  boost::mutex::scoped_lock lock(trajectory_io_mutex_);
+  idle_trajectory_io_.push_back(trajectory_io);
+}
+
+void TrajectoryLibrary::storeLoaded(const Key &key, Entry &entry,
+                                    const robot_trajectory::RobotTrajectoryPtr &trajectory, std::size_t bytes)
+{
+  // Replace a trajectory loaded from before
+  if (entry.trajectory_)
+  {
+    memory_usage_ -= entry.bytes_;
+    recent_keys_.erase(entry.recent_);
+  }
+
+  entry.trajectory_ = trajectory;
+  entry.bytes_ = bytes;
+  recent_keys_.push_front(key);
+  entry.recent_ = recent_keys_.begin();
+  memory_usage_ += bytes;
+  evict();
+}
+
+void TrajectoryLibrary::evict()
+{
+  while (memory_usage_ > memory_budget_ && recent_keys_.size() > 1)
+  {
+    Entry &entry = index_[recent_keys_.back()];
+    ROS_DEBUG_STREAM_NAMED(name_, "Evicting trajectory " << recent_keys_.back().second << " of group "
+                                                         << recent_keys_.back().first);
+    memory_usage_ -= entry.bytes_;
+    entry.trajectory_.reset();
+    recent_keys_.pop_back();
+  }
+  if (memory_usage_ > memory_budget_)
+    ROS_WARN_STREAM_NAMED(name_, "Trajectory of " << memory_usage_ << " bytes is over the memory budget of "
+                                                  << memory_budget_ << " bytes");
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,73 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Convert a binary trajectory log written by TrajectoryRecorder into one CSV file per trajectory
+*/
+
+// C++
+#include <iostream>
+
+// ROS
+#include <ros/ros.h>
+
+// this package
+#include <moveit_boilerplate/execution_interface.h>
+#include <moveit_boilerplate/trajectory_recorder.h>
+
+namespace
+{
+void saveToCSV(const std::string &output_path, std::size_t &count, const std::string &label,
+               const moveit_msgs::RobotTrajectory &trajectory_msg)
+{
+  if (moveit_boilerplate::ExecutionInterface::saveTrajectory(trajectory_msg, label + ".csv", output_path))
+    count++;
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2 || argc > 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " <trajectory_log.bin> [output_directory]" << std::endl;
+    return 1;
+  }
+  const std::string output_path = argc == 3 ? argv[2] : ".";
+
+  std::size_t count = 0;
+  const bool success = moveit_boilerplate::TrajectoryRecorder::readLog(
+      argv[1], boost::bind(&saveToCSV, boost::cref(output_path), boost::ref(count), _1, _2));
+
+  ROS_INFO_STREAM_NAMED("main", "Converted " << count << " trajectories to " << output_path);
+  return success ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Writes executed trajectories to a binary log from a background thread
+*/
+
+// C++
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+// ROS
+#include <ros/ros.h>
+#include <ros/serialization.h>
+
+// this package
+#include <moveit_boilerplate/trajectory_recorder.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+const char LOG_MAGIC[8] = { 'M', 'B', 'T', 'R', 'A', 'J', 'L', 'G' };
+const uint32_t LOG_VERSION = 1;
+}  // namespace
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string &directory, std::size_t max_queue_size,
+                                       std::size_t max_file_size, std::size_t max_files)
+  : directory_(directory), max_queue_size_(max_queue_size), max_file_size_(max_file_size), max_files_(max_files)
+{
+  // Files from different runs don't overwrite each other
+  char time_string[32];
+  const std::time_t now = std::time(NULL);
+  std::strftime(time_string, sizeof(time_string), "%Y%m%d_%H%M%S", std::localtime(&now));
+  file_prefix_ = directory_ + "/trajectory_log_" + time_string + "_";
+
+  recorder_thread_ = boost::thread(&TrajectoryRecorder::recorderThread, this);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+  {
+    boost::mutex::scoped_lock lock(queue_mutex_);
+    shutdown_ = true;
+  }
+  queue_condition_.notify_one();
+  recorder_thread_.join();
+}
+
+bool TrajectoryRecorder::record(const RobotTrajectoryMsgConstPtr &trajectory_msg, const std::string &label)
+{
+  {
+    boost::mutex::scoped_lock lock(queue_mutex_);
+    if (queue_.size() >= max_queue_size_)
+    {
+      dropped_count_++;
+      return false;
+    }
+    queue_.push_back(Entry());
+    queue_.back().trajectory_msg_ = trajectory_msg;
+    queue_.back().label_ = label;
+  }
+  queue_condition_.notify_one();
+  return true;
+}
+
+std::size_t TrajectoryRecorder::getDroppedCount()
+{
+  boost::mutex::scoped_lock lock(queue_mutex_);
+  return dropped_count_;
+}
+
+std::size_t TrajectoryRecorder::getRecordedCount()
+{
+  boost::mutex::scoped_lock lock(queue_mutex_);
+  return recorded_count_;
+}
+
+void TrajectoryRecorder::recorderThread()
+{
+  boost::mutex::scoped_lock lock(queue_mutex_);
+  while (true)
+  {
+    if (queue_.empty())
+    {
+      // Everything queued before shutdown still gets written
+      if (shutdown_)
+        break;
+      queue_condition_.wait(lock);
+      continue;
+    }
+
+    Entry entry = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+
+    write(entry);
+    entry.trajectory_msg_.reset();  // release before taking the lock again
+
+    lock.lock();
+    recorded_count_++;
+  }
+
+  if (file_.is_open())
+    file_.close();
+}
+
+void TrajectoryRecorder::write(const Entry &entry)
+{
+  if ((!file_.is_open() || file_size_ >= max_file_size_) && !openNextFile())
+    return;
+
+  // Serialize into a buffer that is reused between messages
+  const uint32_t label_length = entry.label_.size();
+  const uint32_t msg_length = ros::serialization::serializationLength(*entry.trajectory_msg_);
+  buffer_.resize(msg_length);
+  ros::serialization::OStream stream(buffer_.data(), msg_length);
+  ros::serialization::serialize(stream, *entry.trajectory_msg_);
+
+  file_.write(reinterpret_cast<const char *>(&label_length), sizeof(label_length));
+  file_.write(entry.label_.data(), label_length);
+  file_.write(reinterpret_cast<const char *>(&msg_length), sizeof(msg_length));
+  file_.write(reinterpret_cast<const char *>(buffer_.data()), msg_length);
+  file_.flush();  // keep the log usable if the process dies
+  file_size_ += 2 * sizeof(uint32_t) + label_length + msg_length;
+
+  if (!file_)
+    ROS_ERROR_STREAM_NAMED(name_, "Failed to write trajectory " << entry.label_ << " to " << file_paths_.back());
+  else
+    ROS_DEBUG_STREAM_NAMED(name_, "Recorded trajectory " << entry.label_);
+}
+
+bool TrajectoryRecorder::openNextFile()
+{
+  if (file_.is_open())
+    file_.close();
+
+  // Rotate out the oldest file
+  if (max_files_ > 0 && file_paths_.size() >= max_files_)
+  {
+    std::remove(file_paths_.front().c_str());
+    file_paths_.pop_front();
+  }
+
+  const std::string file_path = file_prefix_ + std::to_string(file_count_++) + ".bin";
+  file_.open(file_path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file_)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Unable to open trajectory log " << file_path);
+    return false;
+  }
+  file_paths_.push_back(file_path);
+
+  file_.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+  file_.write(reinterpret_cast<const char *>(&LOG_VERSION), sizeof(LOG_VERSION));
+  file_size_ = sizeof(LOG_MAGIC) + sizeof(LOG_VERSION);
+
+  ROS_INFO_STREAM_NAMED(name_, "Recording trajectories to " << file_path);
+  return true;
+}
+
+bool TrajectoryRecorder::readLog(const std::string &file_path, const ReadCallback &callback)
+{
+  const std::string name = "trajectory_recorder";  // this function is static and can't use member variable name_
+
+  std::ifstream file(file_path.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Unable to open trajectory log " << file_path);
+    return false;
+  }
+
+  // Check header
+  char magic[sizeof(LOG_MAGIC)];
+  uint32_t version = 0;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&version), sizeof(version));
+  if (!file || !std::equal(magic, magic + sizeof(magic), LOG_MAGIC))
+  {
+    ROS_ERROR_STREAM_NAMED(name, "File " << file_path << " is not a trajectory log");
+    return false;
+  }
+  if (version != LOG_VERSION)
+  {
+    ROS_ERROR_STREAM_NAMED(name, "Trajectory log " << file_path << " has version " << version << ", expected "
+                                                   << LOG_VERSION);
+    return false;
+  }
+
+  std::string label;
+  std::vector<uint8_t> buffer;
+  moveit_msgs::RobotTrajectory trajectory_msg;
+  while (true)
+  {
+    uint32_t label_length = 0;
+    file.read(reinterpret_cast<char *>(&label_length), sizeof(label_length));
+    if (file.eof() && file.gcount() == 0)
+      return true;  // clean end of file
+
+    label.resize(label_length);
+    uint32_t msg_length = 0;
+    if (file)
+      file.read(&label[0], label_length);
+    if (file)
+      file.read(reinterpret_cast<char *>(&msg_length), sizeof(msg_length));
+    if (file)
+    {
+      buffer.resize(msg_length);
+      file.read(reinterpret_cast<char *>(buffer.data()), msg_length);
+    }
+    if (!file)
+    {
+      ROS_ERROR_STREAM_NAMED(name, "Trajectory log " << file_path << " is truncated");
+      return false;
+    }
+
+    try
+    {
+      ros::serialization::IStream stream(buffer.data(), msg_length);
+      ros::serialization::deserialize(stream, trajectory_msg);
+    }
+    catch (const ros::serialization::StreamOverrunException &e)
+    {
+      ROS_ERROR_STREAM_NAMED(name, "Trajectory " << label << " in " << file_path << " is corrupt: " << e.what());
+      return false;
+    }
+
+    callback(label, trajectory_msg);
+  }
+}
+
+}  // namespace moveit_boilerplate
@@ -0,0 +1,294 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Whole-trajectory sanity checks run before a trajectory is sent to the controllers
+*/
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// this package
+#include <moveit_boilerplate/trajectory_validator.h>
+
+namespace moveit_boilerplate
+{
+namespace
+{
+/** \brief Index of the largest |x[i] - x[i-1]|, only called once a limit is known to be exceeded */
+std::size_t findLargestJump(const double *x, std::size_t size)
+{
+  std::size_t worst = 1;
+  for (std::size_t i = 2; i < size; ++i)
+    if (std::abs(x[i] - x[i - 1]) > std::abs(x[worst] - x[worst - 1]))
+      worst = i;
+  return worst;
+}
+
+/** \brief Index of the largest |x[i]| */
+std::size_t findLargest(const double *x, std::size_t size)
+{
+  std::size_t worst = 0;
+  for (std::size_t i = 1; i < size; ++i)
+    if (std::abs(x[i]) > std::abs(x[worst]))
+      worst = i;
+  return worst;
+}
+}  // namespace
+
+TrajectoryValidator::TrajectoryValidator(moveit::core::RobotModelConstPtr robot_model, double max_position_jump)
+  : robot_model_(robot_model), max_position_jump_(max_position_jump)
+{
+}
+
+bool TrajectoryValidator::validate(const trajectory_msgs::JointTrajectory &trajectory,
+                                   TrajectoryValidationReport &report)
+{
+  // Reset without releasing memory
+  report.violations_.clear();
+  report.num_errors_ = 0;
+  report.max_position_jump_ = 0;
+  report.max_velocity_ratio_ = 0;
+  report.max_acceleration_ratio_ = 0;
+  report.max_time_step_ = 0;
+
+  if (trajectory.points.empty())
+    return true;
+
+  loadLimits(trajectory.joint_names);
+  if (!transpose(trajectory, report))
+    return false;
+
+  const std::size_t n = num_points_;
+
+  // Timing
+  double min_time_step = std::numeric_limits<double>::infinity();
+  double max_time_step = 0;
+  for (std::size_t i = 1; i < n; ++i)
+  {
+    const double time_step = times_[i] - times_[i - 1];
+    min_time_step = std::min(min_time_step, time_step);
+    max_time_step = std::max(max_time_step, time_step);
+  }
+  report.max_time_step_ = max_time_step;
+
+  if (min_time_step <= 0)
+  {
+    for (std::size_t i = 1; i < n; ++i)
+      if (times_[i] <= times_[i - 1])
+      {
+        addViolation(TrajectoryViolation::TIME_NOT_INCREASING, true, i, 0, times_[i] - times_[i - 1], 0, report);
+        break;  // the first one is enough to find the bug
+      }
+  }
+  if (max_time_step > warn_time_step_)
+  {
+    const std::size_t i = findLargestJump(times_.data(), n);
+    const bool error = max_time_step > max_time_step_;
+    addViolation(TrajectoryViolation::TIME_STEP, error, i, 0, max_time_step, error ? max_time_step_ : warn_time_step_,
+                 report);
+  }
+
+  // Joints, one fused pass over each joint's contiguous arrays
+  for (std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    const double *q = &positions_[j * n];
+    const double *v = &velocities_[j * n];
+    const double *a = &accelerations_[j * n];
+
+    double max_jump = 0;
+    double max_velocity = std::abs(v[0]);
+    double max_acceleration = std::abs(a[0]);
+    for (std::size_t i = 1; i < n; ++i)
+    {
+      max_jump = std::max(max_jump, std::abs(q[i] - q[i - 1]));
+      max_velocity = std::max(max_velocity, std::abs(v[i]));
+      max_acceleration = std::max(max_acceleration, std::abs(a[i]));
+    }
+
+    report.max_position_jump_ = std::max(report.max_position_jump_, max_jump);
+    report.max_velocity_ratio_ = std::max(report.max_velocity_ratio_, max_velocity / max_velocities_[j]);
+    report.max_acceleration_ratio_ =
+        std::max(report.max_acceleration_ratio_, max_acceleration / max_accelerations_[j]);
+
+    // Locate the worst point only for the rare failures
+    if (max_jump > max_position_jump_)
+      addViolation(TrajectoryViolation::POSITION_JUMP, true, findLargestJump(q, n), j, max_jump, max_position_jump_,
+                   report);
+    if (max_velocity > max_velocities_[j] * limit_margin_)
+      addViolation(TrajectoryViolation::VELOCITY_LIMIT, true, findLargest(v, n), j, max_velocity, max_velocities_[j],
+                   report);
+    if (max_acceleration > max_accelerations_[j] * limit_margin_)
+      addViolation(TrajectoryViolation::ACCELERATION_LIMIT, true, findLargest(a, n), j, max_acceleration,
+                   max_accelerations_[j], report);
+  }
+
+  return report.valid();
+}
+
+const char *TrajectoryValidator::typeToString(TrajectoryViolation::Type type)
+{
+  switch (type)
+  {
+    case TrajectoryViolation::POSITION_JUMP:
+      return "position jump";
+    case TrajectoryViolation::VELOCITY_LIMIT:
+      return "velocity limit";
+    case TrajectoryViolation::ACCELERATION_LIMIT:
+      return "acceleration limit";
+    case TrajectoryViolation::TIME_NOT_INCREASING:
+      return "time not increasing";
+    case TrajectoryViolation::TIME_STEP:
+      return "time step";
+    case TrajectoryViolation::MALFORMED_POINT:
+      return "malformed point";
+  }
+  return "unknown";
+}
+
+void TrajectoryValidator::loadLimits(const std::vector<std::string> &joint_names)
+{
+  if (joint_names == joint_names_)
+    return;
+  joint_names_ = joint_names;
+
+  const double infinity = std::numeric_limits<double>::infinity();
+  max_velocities_.assign(joint_names_.size(), infinity);
+  max_accelerations_.assign(joint_names_.size(), infinity);
+  for (std::size_t j = 0; j < joint_names_.size(); ++j)
+  {
+    if (!robot_model_->hasJointModel(joint_names_[j]))
+    {
+      ROS_WARN_STREAM_NAMED(name_, "Joint " << joint_names_[j] << " is not in the robot model, not checking limits");
+      continue;
+    }
+
+    // A joint trajectory has one value per joint, which only maps to a variable for single variable joints
+    const moveit::core::JointModel *joint = robot_model_->getJointModel(joint_names_[j]);
+    if (joint->getVariableCount() != 1)
+    {
+      ROS_WARN_STREAM_NAMED(name_, "Joint " << joint_names_[j] << " has " << joint->getVariableCount()
+                                            << " variables, not checking limits");
+      continue;
+    }
+    const moveit::core::VariableBounds &bounds = joint->getVariableBounds()[0];
+    if (bounds.velocity_bounded_)
+      max_velocities_[j] = std::max(std::abs(bounds.min_velocity_), std::abs(bounds.max_velocity_));
+    if (bounds.acceleration_bounded_)
+      max_accelerations_[j] = std::max(std::abs(bounds.min_acceleration_), std::abs(bounds.max_acceleration_));
+  }
+}
+
+bool TrajectoryValidator::transpose(const trajectory_msgs::JointTrajectory &trajectory,
+                                    TrajectoryValidationReport &report)
+{
+  const std::size_t n = trajectory.points.size();
+  const std::size_t num_joints = joint_names_.size();
+  num_points_ = n;
+
+  // Check sizes first so the copies below can't go out of bounds
+  bool has_velocities = true;
+  bool has_accelerations = true;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const trajectory_msgs::JointTrajectoryPoint &point = trajectory.points[i];
+    if (point.positions.size() != num_joints)
+    {
+      addViolation(TrajectoryViolation::MALFORMED_POINT, true, i, 0, point.positions.size(), num_joints, report);
+      return false;
+    }
+    has_velocities &= point.velocities.size() == num_joints;
+    has_accelerations &= point.accelerations.size() == num_joints;
+  }
+
+  // Reuses memory from previous trajectories
+  times_.resize(n);
+  inv_time_steps_.resize(n);
+  positions_.resize(n * num_joints);
+  velocities_.resize(n * num_joints);
+  accelerations_.assign(n * num_joints, 0.0);
+
+  for (std::size_t i = 0; i < n; ++i)
+    times_[i] = trajectory.points[i].time_from_start.toSec();
+  inv_time_steps_[0] = 0;
+  for (std::size_t i = 1; i < n; ++i)
+    inv_time_steps_[i] = times_[i] > times_[i - 1] ? 1.0 / (times_[i] - times_[i - 1]) : 0.0;
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const trajectory_msgs::JointTrajectoryPoint &point = trajectory.points[i];
+    for (std::size_t j = 0; j < num_joints; ++j)
+      positions_[j * n + i] = point.positions[j];
+    if (has_velocities)
+      for (std::size_t j = 0; j < num_joints; ++j)
+        velocities_[j * n + i] = point.velocities[j];
+    if (has_accelerations)
+      for (std::size_t j = 0; j < num_joints; ++j)
+        accelerations_[j * n + i] = point.accelerations[j];
+  }
+
+  // Without commanded velocities check the ones implied by the positions
+  if (!has_velocities)
+  {
+    for (std::size_t j = 0; j < num_joints; ++j)
+    {
+      const double *q = &positions_[j * n];
+      double *v = &velocities_[j * n];
+      v[0] = 0;
+      for (std::size_t i = 1; i < n; ++i)
+        v[i] = (q[i] - q[i - 1]) * inv_time_steps_[i];
+    }
+  }
+
+  return true;
+}
+
+void TrajectoryValidator::addViolation(TrajectoryViolation::Type type, bool error, std::size_t point,
+                                       std::size_t joint, double value, double limit,
+                                       TrajectoryValidationReport &report)
+{
+  TrajectoryViolation violation;
+  violation.type_ = type;
+  violation.error_ = error;
+  violation.point_ = point;
+  violation.joint_ = joint;
+  violation.value_ = value;
+  violation.limit_ = limit;
+  report.violations_.push_back(violation);
+  if (error)
+    report.num_errors_++;
+}
+
+}  // namespace moveit_boilerplate
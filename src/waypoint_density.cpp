@@ -0,0 +1,217 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Number of interpolated waypoints needed between two states, from joint lever arms and velocity limits
+*/
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// this package
+#include <moveit_boilerplate/waypoint_density.h>
+
+// Geometric shapes
+#include <geometric_shapes/shape_operations.h>
+
+namespace moveit_boilerplate
+{
+WaypointDensity::WaypointDensity(double max_cartesian_deviation, double max_segment_duration)
+  : max_cartesian_deviation_(max_cartesian_deviation), max_segment_duration_(max_segment_duration)
+{
+  if (max_cartesian_deviation_ <= 0)
+  {
+    ROS_ERROR_STREAM_NAMED(name_, "Max cartesian deviation must be positive, using 0.05");
+    max_cartesian_deviation_ = 0.05;
+  }
+}
+
+std::size_t WaypointDensity::segmentCount(const moveit::core::RobotState &state1,
+                                          const moveit::core::RobotState &state2, JointModelGroup *jmg)
+{
+  const GroupWeights &weights = getWeights(jmg);
+  const double *positions1 = state1.getVariablePositions();
+  const double *positions2 = state2.getVariablePositions();
+  std::vector<const moveit::core::AttachedBody *> attached_bodies;
+  state1.getAttachedBodies(attached_bodies);
+
+  double deviation = 0;
+  double duration = 0;
+  for (std::size_t i = 0; i < weights.joints_.size(); ++i)
+  {
+    const int index = weights.joints_[i]->getFirstVariableIndex();
+    const double distance = weights.joints_[i]->distance(positions1 + index, positions2 + index);
+    deviation += leverArm(weights, i, attached_bodies) * distance;
+    duration = std::max(duration, weights.inverse_velocities_[i] * distance);
+  }
+
+  std::size_t count = std::ceil(deviation / max_cartesian_deviation_);
+  if (max_segment_duration_ > 0)
+    count = std::max<std::size_t>(count, std::ceil(duration / max_segment_duration_));
+  return std::max<std::size_t>(1, count);
+}
+
+double WaypointDensity::cartesianDeviation(const moveit::core::RobotState &state1,
+                                           const moveit::core::RobotState &state2, JointModelGroup *jmg)
+{
+  const GroupWeights &weights = getWeights(jmg);
+  const double *positions1 = state1.getVariablePositions();
+  const double *positions2 = state2.getVariablePositions();
+  std::vector<const moveit::core::AttachedBody *> attached_bodies;
+  state1.getAttachedBodies(attached_bodies);
+
+  double deviation = 0;
+  for (std::size_t i = 0; i < weights.joints_.size(); ++i)
+  {
+    const int index = weights.joints_[i]->getFirstVariableIndex();
+    deviation += leverArm(weights, i, attached_bodies) *
+                 weights.joints_[i]->distance(positions1 + index, positions2 + index);
+  }
+  return deviation;
+}
+
+const std::vector<double> &WaypointDensity::getLeverArms(JointModelGroup *jmg)
+{
+  return getWeights(jmg).lever_arms_;
+}
+
+const WaypointDensity::GroupWeights &WaypointDensity::getWeights(JointModelGroup *jmg)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  std::map<JointModelGroup *, GroupWeights>::iterator it = groups_.find(jmg);
+  if (it != groups_.end())
+    return it->second;
+
+  GroupWeights &weights = groups_[jmg];
+  const std::vector<const moveit::core::JointModel *> &joints = jmg->getActiveJointModels();
+  for (std::size_t i = 0; i < joints.size(); ++i)
+  {
+    const moveit::core::JointModel *joint = joints[i];
+
+    const double lever_arm = leverArm(joint, reach(joint->getChildLinkModel()));
+
+    // The slowest variable of the joint limits how fast it can move
+    double inverse_velocity = 0;
+    const moveit::core::JointModel::Bounds &bounds = joint->getVariableBounds();
+    for (std::size_t j = 0; j < bounds.size(); ++j)
+    {
+      const double max_velocity = std::min(std::fabs(bounds[j].min_velocity_), std::fabs(bounds[j].max_velocity_));
+      if (bounds[j].velocity_bounded_ && max_velocity > std::numeric_limits<double>::epsilon())
+        inverse_velocity = std::max(inverse_velocity, 1.0 / max_velocity);
+    }
+
+    weights.joints_.push_back(joint);
+    weights.lever_arms_.push_back(lever_arm);
+    weights.inverse_velocities_.push_back(inverse_velocity);
+    ROS_DEBUG_STREAM_NAMED(name_, "Joint " << joint->getName() << " has lever arm " << lever_arm << " m");
+  }
+  return weights;
+}
+
+double WaypointDensity::leverArm(const GroupWeights &weights, std::size_t i,
+                                 const std::vector<const moveit::core::AttachedBody *> &attached_bodies)
+{
+  double lever_arm = weights.lever_arms_[i];
+  const moveit::core::JointModel *joint = weights.joints_[i];
+  for (std::size_t j = 0; j < attached_bodies.size(); ++j)
+  {
+    const double offset = offsetTo(joint->getChildLinkModel(), attached_bodies[j]->getAttachedLink());
+    if (offset >= 0)
+      lever_arm = std::max(lever_arm, leverArm(joint, offset + radius(*attached_bodies[j])));
+  }
+  return lever_arm;
+}
+
+double WaypointDensity::leverArm(const moveit::core::JointModel *joint, double reach)
+{
+  // A prismatic joint moves everything below it by exactly its own distance. Planar and floating joints mix
+  // meters and radians, so they are weighted at least as much as a prismatic joint
+  if (joint->getType() == moveit::core::JointModel::REVOLUTE)
+    return reach;
+  if (joint->getType() == moveit::core::JointModel::PRISMATIC)
+    return 1.0;
+  return std::max(1.0, reach);
+}
+
+double WaypointDensity::reach(const moveit::core::LinkModel *link)
+{
+  // Farthest corner of the geometry's bounding box, which need not be centered on the link origin
+  double result = link->getCenteredBoundingBoxOffset().norm() + 0.5 * link->getShapeExtentsAtOrigin().norm();
+
+  const std::vector<const moveit::core::JointModel *> &child_joints = link->getChildJointModels();
+  for (std::size_t i = 0; i < child_joints.size(); ++i)
+    result = std::max(result, jointOffset(child_joints[i]) + reach(child_joints[i]->getChildLinkModel()));
+  return result;
+}
+
+double WaypointDensity::jointOffset(const moveit::core::JointModel *joint)
+{
+  double offset = joint->getChildLinkModel()->getJointOriginTransform().translation().norm();
+
+  // Prismatic joints can extend the chain by their travel
+  if (joint->getType() == moveit::core::JointModel::PRISMATIC)
+  {
+    const moveit::core::VariableBounds &bounds = joint->getVariableBounds()[0];
+    offset += std::max(std::fabs(bounds.min_position_), std::fabs(bounds.max_position_));
+  }
+  return offset;
+}
+
+double WaypointDensity::offsetTo(const moveit::core::LinkModel *from, const moveit::core::LinkModel *to)
+{
+  double offset = 0;
+  for (const moveit::core::LinkModel *link = to; link; link = link->getParentLinkModel())
+  {
+    if (link == from)
+      return offset;
+    offset += jointOffset(link->getParentJointModel());
+  }
+  return -1;
+}
+
+double WaypointDensity::radius(const moveit::core::AttachedBody &attached_body)
+{
+  const std::vector<shapes::ShapeConstPtr> &shapes = attached_body.getShapes();
+  const EigenSTL::vector_Affine3d &transforms = attached_body.getFixedTransforms();
+  double result = 0;
+  for (std::size_t i = 0; i < shapes.size(); ++i)
+  {
+    const Eigen::Vector3d extents = shapes::computeShapeExtents(shapes[i].get());
+    result = std::max(result, transforms[i].translation().norm() + 0.5 * extents.norm());
+  }
+  return result;
+}
+
+}  // namespace moveit_boilerplate
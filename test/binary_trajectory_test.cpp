@@ -0,0 +1,174 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Round trip and header checks of BinaryTrajectoryFile
+*/
+
+// C++
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+// Testing
+#include <gtest/gtest.h>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+// this package
+#include <moveit_boilerplate/binary_trajectory.h>
+#include "test_robot_model.h"
+
+using namespace moveit_boilerplate;
+
+class BinaryTrajectoryTest : public testing::Test
+{
+protected:
+  void SetUp()
+  {
+    robot_model_ = loadTestRobotModel();
+    ASSERT_TRUE(robot_model_);
+    file_name_ = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  }
+
+  void TearDown()
+  {
+    boost::filesystem::remove(file_name_);
+  }
+
+  /** \brief Trajectory with distinct values for every variable and waypoint */
+  robot_trajectory::RobotTrajectory makeTrajectory(std::size_t num_waypoints, bool derivatives)
+  {
+    robot_trajectory::RobotTrajectory trajectory(robot_model_, "arm");
+    for (std::size_t i = 0; i < num_waypoints; ++i)
+    {
+      moveit::core::RobotStatePtr state(new moveit::core::RobotState(robot_model_));
+      state->setToDefaultValues();
+      for (std::size_t j = 0; j < state->getVariableCount(); ++j)
+      {
+        state->setVariablePosition(j, 0.01 * i + j);
+        if (derivatives)
+        {
+          state->setVariableVelocity(j, -0.1 * i);
+          state->setVariableAcceleration(j, 0.5 * j);
+        }
+      }
+      trajectory.addSuffixWayPoint(state, i > 0 ? 0.1 : 0.0);
+    }
+    return trajectory;
+  }
+
+  /** \brief Overwrite part of the written file */
+  void patch(std::size_t offset, const void *data, std::size_t size)
+  {
+    std::fstream file(file_name_.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(static_cast<const char *>(data), size);
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  std::string file_name_;
+};
+
+TEST_F(BinaryTrajectoryTest, RoundTrip)
+{
+  const robot_trajectory::RobotTrajectory trajectory = makeTrajectory(100, true);
+  ASSERT_TRUE(BinaryTrajectoryFile::write(file_name_, trajectory));
+
+  BinaryTrajectoryFile file;
+  ASSERT_TRUE(file.open(file_name_));
+  ASSERT_EQ(100u, file.getWaypointCount());
+  ASSERT_EQ(robot_model_->getVariableCount(), file.getVariableCount());
+  EXPECT_EQ(robot_model_->getVariableNames(), file.getVariableNames());
+  ASSERT_TRUE(file.getVelocities(0));
+  ASSERT_TRUE(file.getAccelerations(0));
+
+  for (std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+  {
+    const moveit::core::RobotState &state = trajectory.getWayPoint(i);
+    for (std::size_t j = 0; j < file.getVariableCount(); ++j)
+    {
+      EXPECT_EQ(state.getVariablePosition(j), file.getPositions(j)[i]);
+      EXPECT_EQ(state.getVariableVelocity(j), file.getVelocities(j)[i]);
+      EXPECT_EQ(state.getVariableAcceleration(j), file.getAccelerations(j)[i]);
+    }
+    EXPECT_NEAR(0.1 * i, file.getTimes()[i], 1e-9);
+  }
+}
+
+TEST_F(BinaryTrajectoryTest, PositionsOnly)
+{
+  ASSERT_TRUE(BinaryTrajectoryFile::write(file_name_, makeTrajectory(10, false)));
+
+  BinaryTrajectoryFile file;
+  ASSERT_TRUE(file.open(file_name_));
+  EXPECT_EQ(10u, file.getWaypointCount());
+  EXPECT_FALSE(file.getVelocities(0));
+  EXPECT_FALSE(file.getAccelerations(0));
+}
+
+TEST_F(BinaryTrajectoryTest, TruncatedFileRejected)
+{
+  ASSERT_TRUE(BinaryTrajectoryFile::write(file_name_, makeTrajectory(10, true)));
+  boost::filesystem::resize_file(file_name_, boost::filesystem::file_size(file_name_) - sizeof(double));
+
+  BinaryTrajectoryFile file;
+  EXPECT_FALSE(file.open(file_name_));
+  EXPECT_FALSE(file.isOpen());
+}
+
+TEST_F(BinaryTrajectoryTest, OverflowingWaypointCountRejected)
+{
+  // A count that wraps the data size around to the real one must not pass the size check
+  ASSERT_TRUE(BinaryTrajectoryFile::write(file_name_, makeTrajectory(10, true)));
+  const std::uint64_t num_waypoints = (std::uint64_t(1) << 63) + 10;
+  patch(offsetof(BinaryTrajectoryHeader, num_waypoints_), &num_waypoints, sizeof(num_waypoints));
+
+  BinaryTrajectoryFile file;
+  EXPECT_FALSE(file.open(file_name_));
+}
+
+TEST_F(BinaryTrajectoryTest, OtherFilesRejected)
+{
+  std::ofstream(file_name_.c_str()) << "joint1,joint2,joint3\n0,0,0\n";
+
+  BinaryTrajectoryFile file;
+  EXPECT_FALSE(file.open(file_name_));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,192 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Error bounds, block reads and corruption checks of CompressedTrajectoryFile
+*/
+
+// C++
+#include <cmath>
+#include <fstream>
+
+// Testing
+#include <gtest/gtest.h>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+// this package
+#include <moveit_boilerplate/compressed_trajectory.h>
+
+using namespace moveit_boilerplate;
+
+class CompressedTrajectoryTest : public testing::Test
+{
+protected:
+  static const std::size_t NUM_WAYPOINTS = 1000;
+  static const std::size_t NUM_VARIABLES = 3;
+
+  void SetUp()
+  {
+    file_name_ = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+
+    // Smooth motion of every variable, like a timed trajectory
+    data_.num_variables_ = NUM_VARIABLES;
+    for (std::size_t j = 0; j < NUM_VARIABLES; ++j)
+      data_.variable_names_.push_back("joint" + std::to_string(j + 1));
+    for (std::size_t i = 0; i < NUM_WAYPOINTS; ++i)
+    {
+      const double time = 0.004 * i;
+      data_.times_.push_back(time);
+      for (std::size_t j = 0; j < NUM_VARIABLES; ++j)
+      {
+        const double frequency = 0.3 + 0.1 * j;
+        data_.positions_.push_back(std::sin(frequency * time));
+        data_.velocities_.push_back(frequency * std::cos(frequency * time));
+        data_.accelerations_.push_back(-frequency * frequency * std::sin(frequency * time));
+      }
+    }
+  }
+
+  void TearDown()
+  {
+    boost::filesystem::remove(file_name_);
+  }
+
+  /** \brief Largest difference between two arrays of the same size */
+  static double maxError(const std::vector<double> &expected, const std::vector<double> &actual)
+  {
+    EXPECT_EQ(expected.size(), actual.size());
+    double error = 0;
+    for (std::size_t i = 0; i < expected.size() && i < actual.size(); ++i)
+      error = std::max(error, std::fabs(expected[i] - actual[i]));
+    return error;
+  }
+
+  std::string file_name_;
+  TrajectoryData data_;
+};
+
+const std::size_t CompressedTrajectoryTest::NUM_WAYPOINTS;
+const std::size_t CompressedTrajectoryTest::NUM_VARIABLES;
+
+TEST_F(CompressedTrajectoryTest, RoundTripWithinErrorBounds)
+{
+  // Only rounding to the step should add error, allow for the floating point error of that
+  const CompressionOptions options;
+  const double slack = 1 + 1e-6;
+  ASSERT_TRUE(CompressedTrajectoryFile::write(file_name_, data_, options));
+
+  CompressedTrajectoryFile file;
+  ASSERT_TRUE(file.open(file_name_));
+  EXPECT_EQ(NUM_WAYPOINTS, file.getWaypointCount());
+  EXPECT_EQ(NUM_VARIABLES, file.getVariableCount());
+  EXPECT_EQ(data_.variable_names_, file.getVariableNames());
+
+  TrajectoryData result;
+  ASSERT_TRUE(file.read(result));
+  ASSERT_EQ(NUM_WAYPOINTS, result.getWaypointCount());
+  EXPECT_LE(maxError(data_.positions_, result.positions_), options.position_error_ * slack);
+  EXPECT_LE(maxError(data_.velocities_, result.velocities_), options.velocity_error_ * slack);
+  EXPECT_LE(maxError(data_.accelerations_, result.accelerations_), options.acceleration_error_ * slack);
+  EXPECT_LE(maxError(data_.times_, result.times_), options.time_error_ * slack);
+}
+
+TEST_F(CompressedTrajectoryTest, ReadByBlock)
+{
+  CompressionOptions options;
+  options.block_size_ = 300;
+  ASSERT_TRUE(CompressedTrajectoryFile::write(file_name_, data_, options));
+
+  CompressedTrajectoryFile file;
+  ASSERT_TRUE(file.open(file_name_));
+  ASSERT_EQ(4u, file.getBlockCount());
+
+  // The last block holds the remainder
+  TrajectoryData block;
+  ASSERT_TRUE(file.readBlock(3, block));
+  ASSERT_EQ(100u, block.getWaypointCount());
+  EXPECT_NEAR(data_.positions_[900 * NUM_VARIABLES], block.positions_[0], options.position_error_ * (1 + 1e-6));
+
+  // Blocks past the end are an error rather than undefined behavior
+  EXPECT_FALSE(file.readBlock(4, block));
+  EXPECT_FALSE(file.readBlock(static_cast<std::size_t>(-1), block));
+}
+
+TEST_F(CompressedTrajectoryTest, PositionsOnlyWithoutNames)
+{
+  TrajectoryData positions;
+  positions.num_variables_ = NUM_VARIABLES;
+  positions.positions_ = data_.positions_;
+  ASSERT_TRUE(CompressedTrajectoryFile::write(file_name_, positions));
+
+  CompressedTrajectoryFile file;
+  ASSERT_TRUE(file.open(file_name_));
+  EXPECT_TRUE(file.getVariableNames().empty());
+
+  TrajectoryData result;
+  ASSERT_TRUE(file.read(result));
+  EXPECT_TRUE(result.velocities_.empty());
+  EXPECT_TRUE(result.accelerations_.empty());
+  EXPECT_TRUE(result.times_.empty());
+  EXPECT_EQ(NUM_WAYPOINTS, result.getWaypointCount());
+}
+
+TEST_F(CompressedTrajectoryTest, CorruptBlockRejected)
+{
+  ASSERT_TRUE(CompressedTrajectoryFile::write(file_name_, data_));
+  {
+    std::fstream file(file_name_.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-20, std::ios::end);
+    file.write("garbagegarbage", 14);
+  }
+
+  CompressedTrajectoryFile file;
+  ASSERT_TRUE(file.open(file_name_));
+  TrajectoryData result;
+  EXPECT_FALSE(file.read(result));
+}
+
+TEST_F(CompressedTrajectoryTest, OtherFilesRejected)
+{
+  std::ofstream(file_name_.c_str()) << "joint1,joint2,joint3\n0,0,0\n";
+
+  CompressedTrajectoryFile file;
+  EXPECT_FALSE(file.open(file_name_));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
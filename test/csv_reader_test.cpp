@@ -0,0 +1,129 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Parsing of numeric CSV buffers by CSVReader
+*/
+
+// C++
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Testing
+#include <gtest/gtest.h>
+
+// this package
+#include <moveit_boilerplate/csv_reader.h>
+
+using namespace moveit_boilerplate;
+
+namespace
+{
+bool parse(CSVReader &reader, const std::string &text, std::size_t skip_lines = 0)
+{
+  return reader.parse(text.data(), text.size(), skip_lines);
+}
+}  // namespace
+
+TEST(CSVReaderTest, RowsAndColumns)
+{
+  CSVReader reader;
+  ASSERT_TRUE(parse(reader, "1,2,3\n4,5,6\n"));
+  ASSERT_EQ(2u, reader.getRowCount());
+  ASSERT_EQ(3u, reader.getColumnCount());
+  EXPECT_EQ(1.0, reader.getRow(0)[0]);
+  EXPECT_EQ(6.0, reader.getRow(1)[2]);
+}
+
+TEST(CSVReaderTest, HeaderEmptyLinesAndTrailingSeparator)
+{
+  CSVReader reader;
+  ASSERT_TRUE(parse(reader, "a,b\n\n1,2,\r\n\n3,4", 1));
+  ASSERT_EQ(2u, reader.getRowCount());
+  ASSERT_EQ(2u, reader.getColumnCount());
+  EXPECT_EQ(2.0, reader.getRow(0)[1]);
+  EXPECT_EQ(3.0, reader.getRow(1)[0]);
+}
+
+TEST(CSVReaderTest, RaggedRowsRejected)
+{
+  CSVReader reader;
+  EXPECT_FALSE(parse(reader, "1,2,3\n4,5\n"));
+}
+
+TEST(CSVReaderTest, NonNumbersRejected)
+{
+  CSVReader reader;
+  EXPECT_FALSE(parse(reader, "1,x,3\n"));
+}
+
+TEST(CSVReaderTest, OtherSeparator)
+{
+  CSVReader reader(';');
+  ASSERT_TRUE(parse(reader, "1.5; -2.5\n"));
+  ASSERT_EQ(2u, reader.getColumnCount());
+  EXPECT_EQ(-2.5, reader.getRow(0)[1]);
+}
+
+TEST(CSVReaderTest, SameAsAtof)
+{
+  // Both the fast path and the strtod fallback must give exactly what atof does
+  const char *numbers[] = { "0",       "-0.0",     "3.14159265358979", "1e-5",   "-2.5E+3", "123456789012345678901",
+                            "1e-320",  "0.1",      "+7",               ".5",     "5.",      "0.30000000000000004",
+                            "1.7976931348623157e308" };
+  for (std::size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i)
+  {
+    double value;
+    const char *end = numbers[i] + std::strlen(numbers[i]);
+    ASSERT_EQ(end, CSVReader::parseDouble(numbers[i], end, value)) << numbers[i];
+    EXPECT_EQ(std::atof(numbers[i]), value) << numbers[i];
+  }
+}
+
+TEST(CSVReaderTest, ParseReplacesValues)
+{
+  CSVReader reader;
+  ASSERT_TRUE(parse(reader, "1,2\n3,4\n5,6\n"));
+  ASSERT_TRUE(parse(reader, "7\n"));
+  EXPECT_EQ(1u, reader.getRowCount());
+  EXPECT_EQ(1u, reader.getColumnCount());
+  EXPECT_EQ(7.0, reader.getRow(0)[0]);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
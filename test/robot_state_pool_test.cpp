@@ -0,0 +1,121 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Reuse and size limit of RobotStatePool
+*/
+
+// Testing
+#include <gtest/gtest.h>
+
+// this package
+#include <moveit_boilerplate/robot_state_pool.h>
+#include "test_robot_model.h"
+
+using namespace moveit_boilerplate;
+
+class RobotStatePoolTest : public testing::Test
+{
+protected:
+  void SetUp()
+  {
+    robot_model_ = loadTestRobotModel();
+    ASSERT_TRUE(robot_model_);
+    prototype_.reset(new moveit::core::RobotState(robot_model_));
+    prototype_->setToDefaultValues();
+    prototype_->setVariablePosition("joint1", 0.5);
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  moveit::core::RobotStatePtr prototype_;
+};
+
+TEST_F(RobotStatePoolTest, AcquiredStatesAreCopies)
+{
+  RobotStatePool pool(robot_model_);
+  moveit::core::RobotStatePtr state = pool.acquire(*prototype_);
+  EXPECT_NE(prototype_.get(), state.get());
+  EXPECT_EQ(0.5, state->getVariablePosition("joint1"));
+
+  // Modifying the copy leaves the prototype alone
+  state->setVariablePosition("joint1", 1.0);
+  EXPECT_EQ(0.5, prototype_->getVariablePosition("joint1"));
+}
+
+TEST_F(RobotStatePoolTest, ReleasedStatesAreReused)
+{
+  RobotStatePool pool(robot_model_);
+  std::vector<moveit::core::RobotStatePtr> states;
+  pool.acquire(10, *prototype_, states);
+  ASSERT_EQ(10u, states.size());
+  EXPECT_EQ(10u, pool.size());
+  const moveit::core::RobotState *first = states.front().get();
+
+  // States in use are never handed out twice
+  moveit::core::RobotStatePtr extra = pool.acquire(*prototype_);
+  for (std::size_t i = 0; i < states.size(); ++i)
+    EXPECT_NE(states[i].get(), extra.get());
+  EXPECT_EQ(11u, pool.size());
+
+  // Once released they come back with the new prototype's values
+  states.clear();
+  prototype_->setVariablePosition("joint1", -0.5);
+  pool.acquire(10, *prototype_, states);
+  EXPECT_EQ(11u, pool.size());
+  bool reused_first = false;
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    reused_first |= states[i].get() == first;
+    EXPECT_EQ(-0.5, states[i]->getVariablePosition("joint1"));
+  }
+  EXPECT_TRUE(reused_first);
+}
+
+TEST_F(RobotStatePoolTest, StopsGrowingAtMaxSize)
+{
+  RobotStatePool pool(robot_model_, 4);
+  std::vector<moveit::core::RobotStatePtr> states;
+  pool.acquire(10, *prototype_, states);
+  EXPECT_EQ(10u, states.size());
+  EXPECT_EQ(4u, pool.size());
+
+  moveit::core::RobotStatePtr extra = pool.acquire(*prototype_);
+  EXPECT_TRUE(extra);
+  EXPECT_EQ(4u, pool.size());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Readers of a SeqLock never see a partially written buffer
+*/
+
+// C++
+#include <atomic>
+#include <vector>
+
+// Boost
+#include <boost/thread.hpp>
+
+// Testing
+#include <gtest/gtest.h>
+
+// this package
+#include <moveit_boilerplate/seqlock.h>
+
+using moveit_boilerplate::SeqLock;
+
+namespace
+{
+const std::size_t BUFFER_SIZE = 64;  // larger than a cache line so writes can tear
+const std::size_t NUM_WRITES = 100000;
+const std::size_t NUM_READERS = 3;
+
+/** \brief Buffer where write k sets every value to k, the same layout as CurrentStateSnapshot's buffer */
+struct Buffer
+{
+  Buffer() : values_(BUFFER_SIZE, 0.0)
+  {
+  }
+
+  SeqLock seqlock_;
+  std::vector<double> values_;
+};
+}  // namespace
+
+TEST(SeqLockTest, Versions)
+{
+  SeqLock seqlock;
+  EXPECT_EQ(0u, seqlock.getVersion());
+
+  std::size_t sequence = seqlock.readBegin();
+  EXPECT_FALSE(seqlock.readRetry(sequence));
+
+  seqlock.writeBegin();
+  seqlock.writeEnd();
+  EXPECT_EQ(1u, seqlock.getVersion());
+  EXPECT_TRUE(seqlock.readRetry(sequence));
+
+  sequence = seqlock.readBegin();
+  EXPECT_EQ(1u, SeqLock::toVersion(sequence));
+  EXPECT_FALSE(seqlock.readRetry(sequence));
+}
+
+TEST(SeqLockTest, NoTornReads)
+{
+  Buffer buffer;
+  std::atomic<bool> done(false);
+  std::atomic<std::size_t> num_torn(0);
+  std::atomic<std::size_t> num_reads(0);
+
+  boost::thread_group readers;
+  for (std::size_t r = 0; r < NUM_READERS; ++r)
+  {
+    readers.create_thread([&]()
+                          {
+                            std::vector<double> copy(BUFFER_SIZE);
+                            std::size_t last_version = 0;
+                            bool last_read = false;
+                            while (!last_read)
+                            {
+                              last_read = done.load();  // one more read after the writer finished
+                              std::size_t sequence;
+                              do
+                              {
+                                sequence = buffer.seqlock_.readBegin();
+                                std::copy(buffer.values_.begin(), buffer.values_.end(), copy.begin());
+                              } while (buffer.seqlock_.readRetry(sequence));
+
+                              // All values come from the write that produced this version, which never goes back
+                              const std::size_t version = SeqLock::toVersion(sequence);
+                              for (std::size_t i = 0; i < BUFFER_SIZE; ++i)
+                                if (copy[i] != static_cast<double>(version))
+                                {
+                                  num_torn++;
+                                  break;
+                                }
+                              if (version < last_version)
+                                num_torn++;
+                              last_version = version;
+                              num_reads++;
+                            }
+                          });
+  }
+
+  for (std::size_t k = 1; k <= NUM_WRITES; ++k)
+  {
+    buffer.seqlock_.writeBegin();
+    std::fill(buffer.values_.begin(), buffer.values_.end(), static_cast<double>(k));
+    buffer.seqlock_.writeEnd();
+  }
+  done = true;
+  readers.join_all();
+
+  EXPECT_EQ(NUM_WRITES, buffer.seqlock_.getVersion());
+  EXPECT_GE(num_reads.load(), NUM_READERS);
+  EXPECT_EQ(0u, num_torn.load());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
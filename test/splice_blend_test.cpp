@@ -0,0 +1,123 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Boundary conditions of the quintic splice blend
+*/
+
+// C++
+#include <cmath>
+
+// Testing
+#include <gtest/gtest.h>
+
+// this package
+#include <moveit_boilerplate/splice_blend.h>
+
+using moveit_boilerplate::SpliceBlendWeights;
+
+namespace
+{
+const double DURATION = 0.5;
+const double POSITION_OFFSET = 0.3;
+const double VELOCITY_OFFSET = -1.2;
+const double ACCELERATION_OFFSET = 4.0;
+
+double position(double time)
+{
+  return SpliceBlendWeights(time, DURATION).position(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET);
+}
+
+double velocity(double time)
+{
+  return SpliceBlendWeights(time, DURATION).velocity(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET);
+}
+
+double acceleration(double time)
+{
+  return SpliceBlendWeights(time, DURATION).acceleration(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET);
+}
+}  // namespace
+
+TEST(SpliceBlendTest, OffsetsApplyInFullAtTheSplice)
+{
+  EXPECT_NEAR(POSITION_OFFSET, position(0), 1e-12);
+  EXPECT_NEAR(VELOCITY_OFFSET, velocity(0), 1e-12);
+  EXPECT_NEAR(ACCELERATION_OFFSET, acceleration(0), 1e-12);
+
+  // Approaching from inside the blend
+  EXPECT_NEAR(POSITION_OFFSET, position(1e-9), 1e-8);
+  EXPECT_NEAR(VELOCITY_OFFSET, velocity(1e-9), 1e-7);
+  EXPECT_NEAR(ACCELERATION_OFFSET, acceleration(1e-9), 1e-6);
+}
+
+TEST(SpliceBlendTest, OffsetsVanishAtTheEnd)
+{
+  EXPECT_EQ(0, position(DURATION));
+  EXPECT_EQ(0, velocity(DURATION));
+  EXPECT_EQ(0, acceleration(DURATION));
+  EXPECT_EQ(0, position(2 * DURATION));
+
+  // Approaching from inside the blend, acceleration included
+  const double before_end = DURATION - 1e-9;
+  EXPECT_NEAR(0, position(before_end), 1e-12);
+  EXPECT_NEAR(0, velocity(before_end), 1e-10);
+  EXPECT_NEAR(0, acceleration(before_end), 1e-6);
+}
+
+TEST(SpliceBlendTest, DerivativesAreConsistent)
+{
+  const double step = 1e-6;
+  for (double time = 0.01; time < DURATION - 0.01; time += 0.01)
+  {
+    EXPECT_NEAR(velocity(time), (position(time + step) - position(time - step)) / (2 * step), 1e-6) << time;
+    EXPECT_NEAR(acceleration(time), (velocity(time + step) - velocity(time - step)) / (2 * step), 1e-5) << time;
+  }
+}
+
+TEST(SpliceBlendTest, ZeroDurationOnlyAffectsTheSplice)
+{
+  const SpliceBlendWeights at_splice(0, 0);
+  EXPECT_EQ(POSITION_OFFSET, at_splice.position(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET));
+  EXPECT_EQ(VELOCITY_OFFSET, at_splice.velocity(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET));
+
+  const SpliceBlendWeights after_splice(0.1, 0);
+  EXPECT_EQ(0, after_splice.position(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET));
+  EXPECT_EQ(0, after_splice.acceleration(POSITION_OFFSET, VELOCITY_OFFSET, ACCELERATION_OFFSET));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Small robot model built from strings, for tests that need robot states but no robot
+*/
+
+#ifndef MOVEIT_BOILERPLATE_TEST_ROBOT_MODEL_H
+#define MOVEIT_BOILERPLATE_TEST_ROBOT_MODEL_H
+
+// C++
+#include <sstream>
+#include <string>
+
+// MoveIt
+#include <moveit/robot_model/robot_model.h>
+
+// URDF and SRDF
+#include <srdfdom/model.h>
+#include <urdf/model.h>
+
+namespace moveit_boilerplate
+{
+/**
+ * \brief Load a chain of revolute joints "joint1" to "jointN" in a group named "arm", with only the last joint also in
+ *        a group named "tip"
+ * \param num_joints - number of joints, each limited to +-3.14 rad
+ * \return NULL if the model could not be parsed
+ */
+inline moveit::core::RobotModelPtr loadTestRobotModel(std::size_t num_joints = 3)
+{
+  std::stringstream urdf_xml;
+  urdf_xml << "<?xml version=\"1.0\"?><robot name=\"test_robot\"><link name=\"base_link\"/>";
+  for (std::size_t i = 1; i <= num_joints; ++i)
+  {
+    const std::string parent = i == 1 ? std::string("base_link") : "link" + std::to_string(i - 1);
+    urdf_xml << "<link name=\"link" << i << "\"><collision><geometry><box size=\"0.1 0.1 0.5\"/></geometry>"
+             << "<origin xyz=\"0 0 0.25\"/></collision></link>"
+             << "<joint name=\"joint" << i << "\" type=\"revolute\"><parent link=\"" << parent << "\"/>"
+             << "<child link=\"link" << i << "\"/><origin xyz=\"0 0 0.5\"/><axis xyz=\"0 1 0\"/>"
+             << "<limit lower=\"-3.14\" upper=\"3.14\" effort=\"10\" velocity=\"2\"/></joint>";
+  }
+  urdf_xml << "</robot>";
+
+  std::stringstream srdf_xml;
+  srdf_xml << "<?xml version=\"1.0\"?><robot name=\"test_robot\"><group name=\"arm\"><chain base_link=\"base_link\" "
+           << "tip_link=\"link" << num_joints << "\"/></group><group name=\"tip\"><joint name=\"joint" << num_joints
+           << "\"/></group>";
+  for (std::size_t i = 1; i < num_joints; ++i)
+    srdf_xml << "<disable_collisions link1=\"link" << i << "\" link2=\"link" << i + 1 << "\" reason=\"Adjacent\"/>";
+  srdf_xml << "</robot>";
+
+  boost::shared_ptr<urdf::Model> urdf_model(new urdf::Model());
+  boost::shared_ptr<srdf::Model> srdf_model(new srdf::Model());
+  if (!urdf_model->initString(urdf_xml.str()) || !srdf_model->initString(*urdf_model, srdf_xml.str()))
+    return moveit::core::RobotModelPtr();
+  return moveit::core::RobotModelPtr(new moveit::core::RobotModel(urdf_model, srdf_model));
+}
+
+}  // namespace moveit_boilerplate
+
+#endif  // MOVEIT_BOILERPLATE_TEST_ROBOT_MODEL_H
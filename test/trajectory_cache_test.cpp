@@ -0,0 +1,127 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Hits, misses and invalidation of TrajectoryCache
+*/
+
+// Testing
+#include <gtest/gtest.h>
+
+// this package
+#include <moveit_boilerplate/trajectory_cache.h>
+#include "test_robot_model.h"
+
+using namespace moveit_boilerplate;
+
+class TrajectoryCacheTest : public testing::Test
+{
+protected:
+  void SetUp()
+  {
+    robot_model_ = loadTestRobotModel();
+    ASSERT_TRUE(robot_model_);
+    jmg_ = robot_model_->getJointModelGroup("tip");
+    ASSERT_TRUE(jmg_);
+    start_.reset(new moveit::core::RobotState(robot_model_));
+    start_->setToDefaultValues();
+    trajectory_.reset(new robot_trajectory::RobotTrajectory(robot_model_, jmg_));
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  JointModelGroup *jmg_;
+  moveit::core::RobotStatePtr start_;
+  robot_trajectory::RobotTrajectoryPtr trajectory_;
+};
+
+TEST_F(TrajectoryCacheTest, SameStartHits)
+{
+  TrajectoryCache cache;
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "home", 1.0, 0));
+  cache.insert(*start_, jmg_, "home", 1.0, 0, trajectory_);
+  EXPECT_EQ(trajectory_, cache.lookup(*start_, jmg_, "home", 1.0, 0));
+  EXPECT_EQ(1u, cache.getHitCount());
+  EXPECT_EQ(1u, cache.getMissCount());
+
+  // Other targets and speeds are different entries
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "ready", 1.0, 0));
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "home", 0.5, 0));
+}
+
+TEST_F(TrajectoryCacheTest, MovedGroupMisses)
+{
+  TrajectoryCache cache;
+  cache.insert(*start_, jmg_, "home", 1.0, 0, trajectory_);
+  start_->setVariablePosition("joint3", 0.5);
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "home", 1.0, 0));
+}
+
+TEST_F(TrajectoryCacheTest, MovedOtherJointMisses)
+{
+  // joint1 is not in the group, but moving it can put the rest of the robot in the trajectory's way
+  TrajectoryCache cache;
+  cache.insert(*start_, jmg_, "home", 1.0, 0, trajectory_);
+  start_->setVariablePosition("joint1", 0.5);
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "home", 1.0, 0));
+
+  // Moving back makes the entry usable again
+  start_->setVariablePosition("joint1", 0.0);
+  EXPECT_EQ(trajectory_, cache.lookup(*start_, jmg_, "home", 1.0, 0));
+}
+
+TEST_F(TrajectoryCacheTest, SceneChangeClears)
+{
+  TrajectoryCache cache;
+  cache.insert(*start_, jmg_, "home", 1.0, 0, trajectory_);
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "home", 1.0, 1));
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST_F(TrajectoryCacheTest, LeastRecentlyUsedIsEvicted)
+{
+  TrajectoryCache cache(2);
+  cache.insert(*start_, jmg_, "a", 1.0, 0, trajectory_);
+  cache.insert(*start_, jmg_, "b", 1.0, 0, trajectory_);
+  EXPECT_TRUE(cache.lookup(*start_, jmg_, "a", 1.0, 0));
+  cache.insert(*start_, jmg_, "c", 1.0, 0, trajectory_);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.lookup(*start_, jmg_, "a", 1.0, 0));
+  EXPECT_FALSE(cache.lookup(*start_, jmg_, "b", 1.0, 0));
+  EXPECT_TRUE(cache.lookup(*start_, jmg_, "c", 1.0, 0));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2017, PickNik LLC
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik LLC nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc:   Rejection of bad trajectories by TrajectoryValidator
+*/
+
+// Testing
+#include <gtest/gtest.h>
+
+// this package
+#include <moveit_boilerplate/trajectory_validator.h>
+#include "test_robot_model.h"
+
+using namespace moveit_boilerplate;
+
+namespace
+{
+const double MAX_POSITION_JUMP = 0.5;
+
+/** \brief Trajectory of joint1..joint3 moving together by step rad every time_step seconds, without velocities */
+trajectory_msgs::JointTrajectory makeTrajectory(std::size_t num_points, double step, double time_step)
+{
+  trajectory_msgs::JointTrajectory trajectory;
+  trajectory.joint_names = { "joint1", "joint2", "joint3" };
+  trajectory.points.resize(num_points);
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    trajectory.points[i].positions.assign(3, i * step);
+    trajectory.points[i].time_from_start = ros::Duration(i * time_step);
+  }
+  return trajectory;
+}
+
+/** \brief Number of violations of a type */
+std::size_t count(const TrajectoryValidationReport &report, TrajectoryViolation::Type type)
+{
+  std::size_t result = 0;
+  for (std::size_t i = 0; i < report.violations_.size(); ++i)
+    result += report.violations_[i].type_ == type;
+  return result;
+}
+}  // namespace
+
+class TrajectoryValidatorTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = loadTestRobotModel();
+    ASSERT_TRUE(bool(robot_model_));
+    validator_.reset(new TrajectoryValidator(robot_model_, MAX_POSITION_JUMP));
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  TrajectoryValidatorPtr validator_;
+  TrajectoryValidationReport report_;
+};
+
+TEST_F(TrajectoryValidatorTest, ValidTrajectory)
+{
+  // 1 rad/s is within the 2 rad/s limit of the test robot
+  EXPECT_TRUE(validator_->validate(makeTrajectory(20, 0.1, 0.1), report_));
+  EXPECT_TRUE(report_.violations_.empty());
+  EXPECT_NEAR(0.5, report_.max_velocity_ratio_, 1e-9);
+
+  // Empty trajectories have nothing to reject
+  EXPECT_TRUE(validator_->validate(trajectory_msgs::JointTrajectory(), report_));
+}
+
+TEST_F(TrajectoryValidatorTest, PositionJump)
+{
+  trajectory_msgs::JointTrajectory trajectory = makeTrajectory(10, 0.1, 1.0);
+  trajectory.points[6].positions[1] += 1.0;
+  EXPECT_FALSE(validator_->validate(trajectory, report_));
+  ASSERT_EQ(1u, count(report_, TrajectoryViolation::POSITION_JUMP));
+  EXPECT_EQ(1u, report_.violations_[0].joint_);
+  EXPECT_EQ(6u, report_.violations_[0].point_);
+}
+
+TEST_F(TrajectoryValidatorTest, ImpliedVelocityLimit)
+{
+  // 0.3 rad in 0.1 s is 3 rad/s
+  EXPECT_FALSE(validator_->validate(makeTrajectory(5, 0.3, 0.1), report_));
+  EXPECT_EQ(3u, count(report_, TrajectoryViolation::VELOCITY_LIMIT));
+  EXPECT_NEAR(1.5, report_.max_velocity_ratio_, 1e-9);
+}
+
+TEST_F(TrajectoryValidatorTest, CommandedVelocityLimit)
+{
+  trajectory_msgs::JointTrajectory trajectory = makeTrajectory(5, 0.1, 0.1);
+  for (std::size_t i = 0; i < trajectory.points.size(); ++i)
+    trajectory.points[i].velocities.assign(3, 1.0);
+  trajectory.points[3].velocities[2] = -2.5;
+  EXPECT_FALSE(validator_->validate(trajectory, report_));
+  ASSERT_EQ(1u, report_.violations_.size());
+  EXPECT_EQ(TrajectoryViolation::VELOCITY_LIMIT, report_.violations_[0].type_);
+  EXPECT_EQ(2u, report_.violations_[0].joint_);
+  EXPECT_EQ(3u, report_.violations_[0].point_);
+}
+
+TEST_F(TrajectoryValidatorTest, TimeNotIncreasing)
+{
+  trajectory_msgs::JointTrajectory trajectory = makeTrajectory(5, 0.0, 0.1);
+  trajectory.points[3].time_from_start = trajectory.points[2].time_from_start;
+  EXPECT_FALSE(validator_->validate(trajectory, report_));
+  ASSERT_EQ(1u, count(report_, TrajectoryViolation::TIME_NOT_INCREASING));
+  EXPECT_EQ(3u, report_.violations_[0].point_);
+}
+
+TEST_F(TrajectoryValidatorTest, TimeStep)
+{
+  validator_->setTimeStepLimits(1.0, 2.0);
+
+  // Above the warning limit is still valid
+  EXPECT_TRUE(validator_->validate(makeTrajectory(3, 0.0, 1.5), report_));
+  ASSERT_EQ(1u, count(report_, TrajectoryViolation::TIME_STEP));
+  EXPECT_FALSE(report_.violations_[0].error_);
+
+  EXPECT_FALSE(validator_->validate(makeTrajectory(3, 0.0, 2.5), report_));
+  ASSERT_EQ(1u, count(report_, TrajectoryViolation::TIME_STEP));
+  EXPECT_TRUE(report_.violations_[0].error_);
+}
+
+TEST_F(TrajectoryValidatorTest, MalformedPoint)
+{
+  trajectory_msgs::JointTrajectory trajectory = makeTrajectory(5, 0.1, 0.1);
+  trajectory.points[4].positions.pop_back();
+  EXPECT_FALSE(validator_->validate(trajectory, report_));
+  ASSERT_EQ(1u, report_.violations_.size());
+  EXPECT_EQ(TrajectoryViolation::MALFORMED_POINT, report_.violations_[0].type_);
+  EXPECT_EQ(4u, report_.violations_[0].point_);
+
+  // The report is cleared for the next trajectory
+  EXPECT_TRUE(validator_->validate(makeTrajectory(5, 0.1, 0.1), report_));
+  EXPECT_TRUE(report_.violations_.empty());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}